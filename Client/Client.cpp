@@ -90,6 +90,84 @@ void ClientTCP::disConnect() {
     }
 }
 
+bool ClientTCP::sendAll(const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(_socketfd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "发送数据失败: " << strerror(errno) << std::endl;
+            return false;
+        }
+        sent += n;
+    }
+    return true;
+}
+
+bool ClientTCP::sendLogs(const std::vector<std::string>& lines) {
+    if (lines.empty()) {
+        return true;
+    }
+    std::string frame = lines.size() == 1 ? IngestProtocol::encodeLog(lines.front())
+                                          : IngestProtocol::encodeBatch(lines);
+    if (!sendAll(frame)) {
+        return false;
+    }
+    _sent += lines.size();
+    // 顺便取走已到达的确认, 避免堆积在服务器的发送缓冲区
+    return readAcks(false);
+}
+
+bool ClientTCP::readAcks(bool wait) {
+    char buffer[1024];
+    for (;;) {
+        ssize_t n = recv(_socketfd, buffer, sizeof(buffer), wait ? 0 : MSG_DONTWAIT);
+        if (n == 0) {
+            std::cerr << "服务器已关闭连接" << std::endl;
+            return false;
+        }
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (!wait && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return true;
+            }
+            std::cerr << "接收服务器响应失败. 错误码: " << errno << std::endl;
+            return false;
+        }
+
+        _decoder.feed(buffer, static_cast<size_t>(n));
+        IngestProtocol::Frame frame;
+        bool gotAck = false;
+        while (_decoder.next(frame)) {
+            uint64_t count;
+            if (IngestProtocol::decodeAck(frame, count)) {
+                _acked = count;
+                gotAck = true;
+            }
+        }
+        if (_decoder.error()) {
+            std::cerr << "服务器响应格式错误" << std::endl;
+            return false;
+        }
+        if (wait && gotAck) {
+            return true;
+        }
+    }
+}
+
+bool ClientTCP::waitForAcks() {
+    while (_acked < _sent) {
+        if (!readAcks(true)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void ClientTCP::createSocket()
 {
     _socketfd = socket(AF_INET, SOCK_STREAM, 0);
@@ -205,80 +283,14 @@ void ClientTCP::run() {
 
                     std::string message = "[" + logLevel + "]{" + message_content + "}";
                     std::cout << "发送消息: " << message << std::endl;
-                    write(_socketfd, message.c_str(), message.size());
-                    
-                    // 接收服务器响应
-                    char buffer[1024] = {0};
-                    ssize_t n = recv(_socketfd, buffer, sizeof(buffer) - 1, 0);
-                    if (n < 0) {
-                        std::cerr << "接收服务器响应失败. 错误码: " << errno << std::endl;
-                        exit(1);
-                    } else if (n == 0) {
-                        std::cerr << "服务器已关闭连接" << std::endl;
+                    if (!sendLogs({message}) || !waitForAcks()) {
                         exit(1);
                     }
-                    buffer[n] = '\0';
-                    
-                    // 解析并显示JSON响应
-                    std::cout << "服务器响应: " << std::endl;
-    
+
                     std::string path = std::filesystem::current_path().string() + "/Log/Client.txt";
                     LogMessage::setDefaultLogPath(path);
-                    LogMessage::logMessage(INFO, "接收服务器响应: %s", buffer);
-                    
-                    // 简单解析JSON (不使用外部库)
-                    // std::string response(buffer);
-                    // auto extractValue = [&response](const std::string& key) -> std::string {
-                    //     size_t keyPos = response.find("\"" + key + "\":");
-                    //     if (keyPos == std::string::npos) return "未找到";
-                        
-                    //     size_t valueStart = response.find("\"", keyPos + key.length() + 2);
-                    //     if (valueStart == std::string::npos) {
-                    //         // 可能是数字值
-                    //         valueStart = response.find_first_not_of(" \t\n:", keyPos + key.length() + 1);
-                    //         size_t valueEnd = response.find_first_of(",\n}", valueStart);
-                    //         if (valueEnd == std::string::npos) return "解析错误";
-                    //         return response.substr(valueStart, valueEnd - valueStart);
-                    //     } else {
-                    //         size_t valueEnd = response.find("\"", valueStart + 1);
-                    //         if (valueEnd == std::string::npos) return "解析错误";
-                    //         return response.substr(valueStart + 1, valueEnd - valueStart - 1);
-                    //     }
-                    // };
-    
-                    std::string response(buffer);
-                    auto extractValueResponse = [&response](const std::string& key) -> std::string {
-                        size_t keyPos = response.find("\"" + key + "\":");
-                        if (keyPos == std::string::npos) return "未找到";
-                
-                        size_t valueStart = response.find_first_not_of(" \t\n:", keyPos + key.length() + 2);
-                        if (valueStart == std::string::npos) return "解析错误";
-                
-                        // 处理字符串
-                        if (response[valueStart] == '"') {
-                            size_t valueEnd = response.find("\"", valueStart + 1);
-                            if (valueEnd == std::string::npos) return "解析错误";
-                            return response.substr(valueStart + 1, valueEnd - valueStart - 1);
-                        }
-                
-                        // 处理数值、布尔值、null
-                        size_t valueEnd = response.find_first_of(",\n}", valueStart);
-                        if (valueEnd == std::string::npos) return "解析错误";
-                
-                        std::string result = response.substr(valueStart, valueEnd - valueStart);
-                        if (result == "null") return "空值";
-                        if (result == "true") return "真";
-                        if (result == "false") return "假";
-                
-                        return result;
-                    };
-                
-                    
-                    // 提取并打印关键信息
-                    std::cout << "  状态: \033[1;32m" << extractValueResponse("status") << "\033[0m" << std::endl;
-                    std::cout << "  时间戳: " << extractValueResponse("timestamp") << std::endl;
-                    std::cout << "  消息大小: " << extractValueResponse("message_size") << " 字节" << std::endl;
-                    std::cout << "  服务器ID: " << extractValueResponse("server_id") << std::endl;
+                    LogMessage::logMessage(INFO, "服务器已确认 %llu 条日志", static_cast<unsigned long long>(_acked));
+                    std::cout << "服务器确认: 累计 " << _acked << " 条" << std::endl;
                     std::cout << "-----------------------------" << std::endl;
                 }
                 
@@ -302,9 +314,8 @@ void ClientTCP::run() {
         }
 
         // HTML文件解析
-        // 考虑使用正则表达式进行解析
-        std::regex pattern(R"(class='([^']+)'>\[(\w+)\]\s+(.*?)\s+at\s+(\d{4}-\d{2}-\d{2} \d{2}:\d{2}:\d{2}))");
-        std::smatch match;
+        // 用 LogLineParser 单遍解析, 字段直接指向 line, 不为每行构造正则匹配结果
+        LogLineParser::LogLine parsed;
         std::string line;
         // 跳过文件开头的HTML标签
         // 读取到第一个<div>标签
@@ -318,72 +329,33 @@ void ClientTCP::run() {
                 break;
             }
         }
+        // 日志按 BATCH_SIZE 条打包发送, 不逐条等待响应, 最后等待全部确认
+        std::vector<std::string> batch;
         while (std::getline(file, line)) {
-            if (std::regex_search(line, match, pattern)) {
-                std::string log_class = match[1];
-                std::string level = match[2];
-                std::string message = match[3];
-                std::string timestamp = match[4];
+            if (LogLineParser::parseHtmlLine(line, parsed)) {
+                std::string log_class(parsed.logClass);
+                std::string level(parsed.level);
+                std::string message(parsed.message);
+                std::string timestamp(parsed.timestamp);
                 LogMessage::logMessage(INFO, "解析到日志等级: %s, 消息: %s, 时间戳: %s", level.c_str(), message.c_str(), timestamp.c_str());
                 std::cout << "解析到日志等级: " << log_class << ", 消息: " << message << ", 时间戳: " << timestamp << std::endl;
             
                 // 发送解析后的内容
                 std::string new_content = "<" + log_class + ">" + "[" + level + "] " + "{" + message + "}" + " at " + timestamp;
-                write(_socketfd, new_content.c_str(), new_content.size());
-                
-                // 接收服务器响应
-                char buffer[1024] = {0};
-                ssize_t n = recv(_socketfd, buffer, sizeof(buffer) - 1, 0);
-                if (n < 0) {
-                    std::cerr << "接收服务器响应失败. 错误码: " << errno << std::endl;
-                    exit(1);
-                } else if (n == 0) {
-                    std::cerr << "服务器已关闭连接" << std::endl;
-                    exit(1);
-                }
-                buffer[n] = '\0';
-                
-                // 解析并显示JSON响应
-                std::cout << "服务器响应: " << std::endl;
-                std::string response(buffer);
-                auto extractValue = [&response](const std::string& key) -> std::string {
-                    size_t keyPos = response.find("\"" + key + "\":");
-                    if (keyPos == std::string::npos) return "未找到";
-
-                    size_t valueStart = response.find_first_not_of(" \t\n:", keyPos + key.length() + 2);
-                    if (valueStart == std::string::npos) return "解析错误";
-
-                    // 处理字符串
-                    if (response[valueStart] == '"') {
-                        size_t valueEnd = response.find("\"", valueStart + 1);
-                        if (valueEnd == std::string::npos) return "解析错误";
-                        return response.substr(valueStart + 1, valueEnd - valueStart - 1);
+                batch.push_back(new_content);
+                if (batch.size() >= BATCH_SIZE) {
+                    if (!sendLogs(batch)) {
+                        exit(1);
                     }
-
-                    // 处理数值、布尔值、null
-                    size_t valueEnd = response.find_first_of(",\n}", valueStart);
-                    if (valueEnd == std::string::npos) return "解析错误";
-
-                    std::string result = response.substr(valueStart, valueEnd - valueStart);
-                    if (result == "null") return "空值";
-                    if (result == "true") return "真";
-                    if (result == "false") return "假";
-
-                    return result;
-                };
-
-                // 提取并打印关键信息
-                std::cout << "  状态: \033[1;32m" << extractValue("status") << "\033[0m" << std::endl;
-                std::cout << "  时间戳: " << extractValue("timestamp") << std::endl;
-                std::cout << "  消息大小: " << extractValue("message_size") << " 字节" << std::endl;
-                std::cout << "  服务器ID: " << extractValue("server_id") << std::endl;
-                std::cout << "-----------------------------" << std::endl;
-
-                LogMessage::logMessage(INFO, "接收服务器响应: %s", buffer);
-                
+                    batch.clear();
+                }
             }
-            std::this_thread::sleep_for(std::chrono::seconds(1));
         }
+        if (!sendLogs(batch) || !waitForAcks()) {
+            exit(1);
+        }
+        std::cout << "服务器确认: 累计 " << _acked << " 条" << std::endl;
+        LogMessage::logMessage(INFO, "服务器已确认 %llu 条日志", static_cast<unsigned long long>(_acked));
         file.close(); // 关闭文件
     }
 }
\ No newline at end of file
@@ -15,7 +15,10 @@
 #include <filesystem>
 #include <regex>
 #include <chrono>
+#include <vector>
 #include "../Logger.hpp"
+#include "../Util/IngestProtocol.hpp"
+#include "../Util/LogLineParser.hpp"
 #include "../Util/ConfigManager.hpp"
 #include "../Util/SharedConfigManager.hpp"
 #include "../LogMessage/LogMessage.hpp"
@@ -29,7 +32,18 @@ private:
     std::string _address;
     std::thread _reader;
 
+    // 分帧协议: 日志连续发送, 服务器的累计确认异步读取
+    IngestProtocol::FrameDecoder _decoder;
+    uint64_t _sent = 0;     // 已发送的日志条数
+    uint64_t _acked = 0;    // 服务器已确认的条数
+
+    bool sendAll(const std::string& data);
+    // 读取确认帧; wait 为 true 时阻塞到至少收到一个, 否则只读已到达的; 连接断开返回 false
+    bool readAcks(bool wait);
+
 public:
+    static const size_t BATCH_SIZE = 256;   // HTML 日志每帧打包的条数
+
     ClientTCP(const std::string& address, int port, int socketfd = -1);
     ~ClientTCP();
     
@@ -46,6 +60,13 @@ public:
     std::string receiveData();  // 接收并返回数据
     void disConnect();  // 断开连接
 
+    // 一条日志发 LOG 帧, 多条发 BATCH 帧, 不等待确认
+    bool sendLogs(const std::vector<std::string>& lines);
+    // 阻塞到已发送的日志全部被确认
+    bool waitForAcks();
+    uint64_t sentCount() const { return _sent; }
+    uint64_t ackedCount() const { return _acked; }
+
     void run();
 };
 
@@ -0,0 +1,228 @@
+#ifndef __DEFERREDLOG_HPP__
+#define __DEFERREDLOG_HPP__
+
+#include <string>
+#include <string_view>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+#include "FormatSpec.hpp"
+
+// 延迟格式化: 生产者只把参数按二进制编码拷贝进记录, 由写线程负责渲染
+// 记录中保存格式串描述符的指针, 因此格式串必须来自 LOG_FMT (静态存储期)
+
+namespace DeferredLog {
+
+    // 参数类型标记
+    enum class ArgType : uint8_t {
+        INT64,
+        UINT64,
+        DOUBLE,
+        CHAR,
+        STRING
+    };
+
+    // 队列中的一条延迟日志记录
+    struct Record {
+        static const size_t INLINE_ARGS_SIZE = 192;
+
+        const FormatSpec*   spec = nullptr;     // 为空时 args 中只有一条已格式化好的消息
+        int64_t             timestamp = 0;      // 生产者入队时间 (system_clock, 纳秒)
+        int32_t             level = 0;
+        uint8_t             isHtml = 0;
+        uint8_t             argCount = 0;
+        uint32_t            size = 0;           // 编码后参数的总字节数
+        char                args[INLINE_ARGS_SIZE];
+        std::string         overflow;           // 参数超过内联容量时才使用, 通常为空不分配
+
+        Record() = default;
+        Record(const Record& other) { *this = other; }
+        Record(Record&& other) noexcept { *this = std::move(other); }
+
+        // 只拷贝实际使用的内联字节, 避免每次入队/出队都搬运整个缓冲区
+        Record& operator=(const Record& other) {
+            copyHeader(other);
+            overflow = other.overflow;
+            if(overflow.empty()){
+                std::memcpy(args, other.args, size);
+            }
+            return *this;
+        }
+
+        Record& operator=(Record&& other) noexcept {
+            copyHeader(other);
+            overflow = std::move(other.overflow);
+            other.overflow.clear();
+            if(overflow.empty()){
+                std::memcpy(args, other.args, size);
+            }
+            return *this;
+        }
+
+        const char* data() const {
+            return overflow.empty() ? args : overflow.data();
+        }
+
+    private:
+        void copyHeader(const Record& other) {
+            spec = other.spec;
+            timestamp = other.timestamp;
+            level = other.level;
+            isHtml = other.isHtml;
+            argCount = other.argCount;
+            size = other.size;
+        }
+    };
+
+    // 各类型编码器: encodedSize 计算所需字节数, encode 写入并返回写入后的位置
+    template <typename T>
+    struct Encoder {
+        static_assert(std::is_arithmetic_v<T>, "DeferredLog: unsupported argument type");
+
+        static constexpr ArgType type() {
+            if constexpr (std::is_same_v<T, char> || std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char>) return ArgType::CHAR;
+            else if constexpr (std::is_floating_point_v<T>) return ArgType::DOUBLE;
+            else if constexpr (std::is_signed_v<T>) return ArgType::INT64;
+            else return ArgType::UINT64;
+        }
+
+        static size_t encodedSize(const T&) {
+            return 1 + sizeof(uint64_t);
+        }
+
+        static char* encode(char* dst, const T& value) {
+            *dst++ = static_cast<char>(type());
+            if constexpr (type() == ArgType::CHAR) {
+                int64_t v = static_cast<char>(value);
+                std::memcpy(dst, &v, sizeof(v));
+            }
+            else if constexpr (std::is_floating_point_v<T>) {
+                double v = static_cast<double>(value);
+                std::memcpy(dst, &v, sizeof(v));
+            }
+            else if constexpr (std::is_signed_v<T>) {
+                int64_t v = static_cast<int64_t>(value);
+                std::memcpy(dst, &v, sizeof(v));
+            }
+            else {
+                uint64_t v = static_cast<uint64_t>(value);
+                std::memcpy(dst, &v, sizeof(v));
+            }
+            return dst + sizeof(uint64_t);
+        }
+    };
+
+    struct StringEncoder {
+        static size_t encodedSize(std::string_view value) {
+            return 1 + sizeof(uint32_t) + value.size();
+        }
+
+        static char* encode(char* dst, std::string_view value) {
+            *dst++ = static_cast<char>(ArgType::STRING);
+            uint32_t length = static_cast<uint32_t>(value.size());
+            std::memcpy(dst, &length, sizeof(length));
+            dst += sizeof(length);
+            std::memcpy(dst, value.data(), value.size());
+            return dst + value.size();
+        }
+    };
+
+    template <> struct Encoder<std::string_view> : StringEncoder {};
+    template <> struct Encoder<std::string> : StringEncoder {};
+    template <> struct Encoder<const char*> : StringEncoder {};
+    template <> struct Encoder<char*> : StringEncoder {};
+    template <size_t N> struct Encoder<char[N]> : StringEncoder {};
+
+    template <typename T>
+    using EncoderFor = Encoder<std::remove_cv_t<std::remove_reference_t<T>>>;
+
+    // 把参数编码进记录, 能放进内联缓冲区时不产生任何堆分配
+    template <typename ...Args>
+    void encodeArgs(Record& record, const Args& ...args) {
+        size_t total = (size_t(0) + ... + EncoderFor<Args>::encodedSize(args));
+        char* dst = record.args;
+        record.overflow.clear();
+        if (total > Record::INLINE_ARGS_SIZE) {
+            record.overflow.resize(total);
+            dst = &record.overflow[0];
+        }
+        ((dst = EncoderFor<Args>::encode(dst, args)), ...);
+        record.size = static_cast<uint32_t>(total);
+        record.argCount = static_cast<uint8_t>(sizeof...(Args));
+    }
+
+    // 写线程侧: 解码出的参数视图, 字符串直接指向记录内的字节
+    struct DecodedArg {
+        ArgType             type;
+        int64_t             i64 = 0;
+        uint64_t            u64 = 0;
+        double              f64 = 0.0;
+        std::string_view    str;
+    };
+
+    inline const char* decodeArg(const char* src, DecodedArg& arg) {
+        arg.type = static_cast<ArgType>(*src++);
+        switch (arg.type) {
+            case ArgType::INT64:  std::memcpy(&arg.i64, src, sizeof(int64_t)); return src + sizeof(int64_t);
+            case ArgType::UINT64: std::memcpy(&arg.u64, src, sizeof(uint64_t)); return src + sizeof(uint64_t);
+            case ArgType::DOUBLE: std::memcpy(&arg.f64, src, sizeof(double)); return src + sizeof(double);
+            case ArgType::CHAR:   std::memcpy(&arg.i64, src, sizeof(int64_t)); return src + sizeof(int64_t);
+            case ArgType::STRING: {
+                uint32_t length = 0;
+                std::memcpy(&length, src, sizeof(length));
+                src += sizeof(length);
+                arg.str = std::string_view(src, length);
+                return src + length;
+            }
+        }
+        return src;
+    }
+
+    inline void appendDecoded(std::string& out, const DecodedArg& arg) {
+        switch (arg.type) {
+            case ArgType::INT64:  FormatDetail::appendArg(out, arg.i64); break;
+            case ArgType::UINT64: FormatDetail::appendArg(out, arg.u64); break;
+            case ArgType::DOUBLE: FormatDetail::appendArg(out, arg.f64); break;
+            case ArgType::CHAR:   out.push_back(static_cast<char>(arg.i64)); break;
+            case ArgType::STRING: FormatDetail::appendArg(out, arg.str); break;
+        }
+    }
+
+    // 按记录中的格式串描述符渲染消息正文, 规则与 FormatDetail::formatTo 相同
+    inline void renderMessage(std::string& out, const Record& record) {
+        const char* src = record.data();
+        DecodedArg arg;
+
+        if (record.spec == nullptr) {
+            // 运行期格式串已在生产者侧格式化好
+            for (uint8_t i = 0; i < record.argCount; ++i) {
+                src = decodeArg(src, arg);
+                appendDecoded(out, arg);
+            }
+            return;
+        }
+
+        const FormatSpec& spec = *record.spec;
+        size_t index = 0;
+        for (; index < record.argCount; ++index) {
+            if (index <= spec.placeholderCount()) {
+                std::string_view seg = spec.segment(index);
+                out.append(seg.data(), seg.size());
+            }
+            src = decodeArg(src, arg);
+            appendDecoded(out, arg);
+        }
+        for (; index < spec.placeholderCount(); ++index) {
+            std::string_view seg = spec.segment(index);
+            out.append(seg.data(), seg.size());
+            out.append("{}", 2);
+        }
+        if (index == spec.placeholderCount()) {
+            std::string_view seg = spec.segment(index);
+            out.append(seg.data(), seg.size());
+        }
+    }
+
+} // namespace DeferredLog
+
+#endif // __DEFERREDLOG_HPP__
@@ -0,0 +1,119 @@
+#ifndef __DB_EXECUTOR_HPP__
+#define __DB_EXECUTOR_HPP__
+
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cstdint>
+#include "../ThreadPool.hpp"
+
+// 把阻塞操作(数据库查询、读取日志文件)移出 epoll 事件循环
+// 任务在线程池中执行, 完成后把回调放入完成队列并写 eventfd; 事件循环把 eventFd() 加入 epoll,
+// 可读时调用 runCompletions, 回调因此总是在事件循环线程中执行, 可以直接访问连接状态并发送响应
+// 多个事件循环共用一个线程池时, 每个事件循环使用自己的完成队列(queue 下标), 回调回到提交它的循环
+class DBExecutor {
+private:
+    struct CompletionQueue {
+        std::mutex                          mutex;
+        std::vector<std::function<void()>>  completions;    // 已完成、等待事件循环执行的回调
+        int                                 eventfd = -1;
+    };
+
+    std::vector<std::unique_ptr<CompletionQueue>> _queues;
+    std::atomic<size_t>                 _inFlight{0};   // 已提交但回调尚未执行的任务数
+    std::unique_ptr<ThreadPool>         _pool;
+
+    void complete(size_t queue, std::function<void()> onDone) {
+        CompletionQueue& target = *_queues[queue];
+        {
+            std::lock_guard<std::mutex> lock(target.mutex);
+            target.completions.push_back(std::move(onDone));
+        }
+        uint64_t one = 1;
+        ssize_t n = write(target.eventfd, &one, sizeof(one));
+        (void)n;    // 计数器只会在溢出时写失败, 此时事件循环本来就可读
+    }
+
+public:
+    explicit DBExecutor(int threads = 4, size_t queues = 1)
+        : _pool(new ThreadPool(threads)) {
+        for (size_t i = 0; i < std::max<size_t>(1, queues); ++i) {
+            std::unique_ptr<CompletionQueue> queue(new CompletionQueue());
+            queue->eventfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (queue->eventfd < 0) {
+                std::cerr << "DBExecutor: eventfd failed" << std::endl;
+            }
+            _queues.push_back(std::move(queue));
+        }
+    }
+
+    ~DBExecutor() {
+        _pool.reset();  // 等待已提交的任务执行完
+        for (auto& queue : _queues) {
+            if (queue->eventfd >= 0) {
+                close(queue->eventfd);
+            }
+        }
+    }
+
+    DBExecutor(const DBExecutor&) = delete;
+    DBExecutor& operator=(const DBExecutor&) = delete;
+
+    size_t queueCount() const { return _queues.size(); }
+    int eventFd(size_t queue = 0) const { return _queues[queue]->eventfd; }
+    size_t inFlight() const { return _inFlight.load(); }
+
+    // 在线程池中执行 job, 结果交给 queue 对应事件循环线程中的 onDone(result)
+    // job 抛出异常时记录错误, onDone 收到默认构造的结果
+    template<typename Job, typename Done>
+    bool submit(Job job, Done onDone, size_t queue = 0) {
+        using Result = decltype(job());
+        ++_inFlight;
+        bool queued = _pool->submitTask([this, queue, job = std::move(job), onDone = std::move(onDone)]() mutable {
+            auto result = std::make_shared<Result>();
+            try {
+                *result = job();
+            } catch (const std::exception& e) {
+                std::cerr << "DBExecutor: task failed: " << e.what() << std::endl;
+            }
+            complete(queue, [result, onDone = std::move(onDone)]() mutable { onDone(*result); });
+        });
+        if (!queued) {
+            --_inFlight;
+        }
+        return queued;
+    }
+
+    // 不经过线程池, 直接让 queue 对应的事件循环执行 fn; 可在任意线程调用
+    void post(size_t queue, std::function<void()> fn) {
+        ++_inFlight;
+        complete(queue, std::move(fn));
+    }
+
+    // eventfd 可读时由事件循环调用, 执行所有已完成任务的回调, 返回执行的个数
+    size_t runCompletions(size_t queue = 0) {
+        CompletionQueue& source = *_queues[queue];
+        uint64_t count;
+        while (read(source.eventfd, &count, sizeof(count)) > 0) {
+        }
+
+        std::vector<std::function<void()>> ready;
+        {
+            std::lock_guard<std::mutex> lock(source.mutex);
+            ready.swap(source.completions);
+        }
+        for (auto& onDone : ready) {
+            onDone();
+            --_inFlight;
+        }
+        return ready.size();
+    }
+};
+
+#endif // __DB_EXECUTOR_HPP__
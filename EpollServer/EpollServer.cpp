@@ -7,6 +7,8 @@ namespace Server{
     EpollServerSpace::EpollServer* g_server = nullptr; // 全局服务器实例
 }
 
+thread_local EpollServer::Reactor* EpollServer::_currentReactor = nullptr;
+
 void EpollServerSpace::signalHandler(int signum)
 {
     std::cout << "\033[1;31m[错误]\033[0m 捕获到信号 " << signum << ", 服务器正在关闭..." << std::endl;
@@ -26,20 +28,17 @@ EpollServer::EpollServer( uint64_t port
     , _defaultUserName(defaultUserName)
     , _defaultPassword(defaultPassword)
     , _defaultDBName(defaultDBName)
-    , _listenfd(defaultValue)
-    , _epollfd(defaultValue)
     , _log_file(path)
-    , _events(nullptr)
     , _defaultIPAddress(defaultIPAddress)
     , _defaultPort(defaultPort)
     , _defaultMaxConn(defaultMaxConn)
     , _staticFilesDir(staticFilesDir)
     , _wsPath("/ws")  // 默认WebSocket路径
+    , _reactorCount(0)
 {
     if (port == 0)
         _port = defaultPort;
 
-    _events = new struct epoll_event[defaultEpollSize];
     if(!SqlConnPool::getInstance()->init(_defaultIPAddress.c_str(), _defaultUserName.c_str(), _defaultPassword.c_str(), _defaultDBName.c_str(), _defaultPort, _defaultMaxConn)){
         std::cerr << "\033[1;31m[错误]\033[0m 数据库连接池初始化失败" << std::endl;
         exit(1);
@@ -67,112 +66,218 @@ int EpollServer::LeveltoInt(const std::string& level) {
 
 EpollServer::~EpollServer()
 {
-    if (_events != nullptr)
-        delete[] _events;
+    // 在信号处理中被析构时事件循环可能仍在运行, 先让其他循环线程退出
+    ServerStop();
+    for (auto& reactor : _reactors) {
+        if (reactor->thread.joinable()) {
+            reactor->thread.join();
+        }
+    }
+
+    // 再等待线程池中的任务结束; 先在锁内取出, 线程池中的任务广播时不会与此处互相等待
+    std::unique_ptr<DBExecutor> executor;
+    {
+        std::lock_guard<std::mutex> lock(_reactorsMutex);
+        executor.swap(_dbExecutor);
+    }
+    executor.reset();
+    closeReactors();
+}
+
+void EpollServer::setReactorThreads(size_t threads) {
+    _reactorCount = threads;
+}
 
-    if (_listenfd != defaultValue)
-        close(_listenfd);
+EpollServer::Reactor& EpollServer::currentReactor() {
+    return _currentReactor ? *_currentReactor : *_reactors.front();
+}
 
-    if (_epollfd != defaultValue)
-        close(_epollfd);
+// 每个事件循环一个监听套接字, 都设置 SO_REUSEPORT 后绑定同一端口; 返回是否支持 SO_REUSEPORT
+bool EpollServer::openListener(Reactor& reactor) {
+    reactor.listenfd = Sock::Socket();
+    bool reusePort = Sock::SetReusePort(reactor.listenfd);
+    Sock::Bind(reactor.listenfd, _port);
+    Sock::Listen(reactor.listenfd);
+    // 新连接可能已被其他进程中的监听套接字取走, accept 不能阻塞
+    Sock::SetNonBlock(reactor.listenfd);
+    return reusePort;
 }
 
 void EpollServer::ServerInit(){
-    _listenfd = Sock::Socket();
-    Sock::Bind(_listenfd, _port);
-    Sock::Listen(_listenfd);
+    size_t count = _reactorCount;
+    if (count == 0) {
+        count = std::max(1u, std::thread::hardware_concurrency());
+    }
 
-    _epollfd = epoll_create(1);
-    if(_epollfd < 0){
-        std::cerr << "\033[1;31m[错误]\033[0m epoll_create 失败: " << strerror(errno) << std::endl;
-        exit(1);
+    for (size_t i = 0; i < count; ++i) {
+        std::unique_ptr<Reactor> reactor(new Reactor());
+        reactor->index = i;
+        bool reusePort = openListener(*reactor);
+        _reactors.push_back(std::move(reactor));
+        if (!reusePort) {
+            std::cerr << "\033[1;31m[错误]\033[0m 不支持 SO_REUSEPORT, 只启动一个事件循环" << std::endl;
+            break;
+        }
     }
 
-    struct epoll_event ev;
-    ev.data.fd = _listenfd;
-    ev.events = EPOLLIN;
-    if(epoll_ctl(_epollfd, EPOLL_CTL_ADD, _listenfd, &ev) < 0){
-        std::cerr << "\033[1;31m[错误]\033[0m epoll_ctl 添加监听套接字失败: " << strerror(errno) << std::endl;
-        exit(1);
+    // 每个执行线程同时最多占用一条连接, 线程数与连接池上限一致; 每个事件循环一个完成队列
+    _dbExecutor.reset(new DBExecutor(std::max(1, _defaultMaxConn), _reactors.size()));
+
+    for (auto& reactor : _reactors) {
+        reactor->epollfd = epoll_create1(EPOLL_CLOEXEC);
+        if(reactor->epollfd < 0){
+            std::cerr << "\033[1;31m[错误]\033[0m epoll_create 失败: " << strerror(errno) << std::endl;
+            exit(1);
+        }
+        reactor->events = new struct epoll_event[defaultEpollSize];
+
+        struct epoll_event ev;
+        ev.data.fd = reactor->listenfd;
+        ev.events = EPOLLIN;
+        if(epoll_ctl(reactor->epollfd, EPOLL_CTL_ADD, reactor->listenfd, &ev) < 0){
+            std::cerr << "\033[1;31m[错误]\033[0m epoll_ctl 添加监听套接字失败: " << strerror(errno) << std::endl;
+            exit(1);
+        }
+
+        // 线程池任务完成、其他线程广播时通过 eventfd 唤醒事件循环
+        int eventFd = _dbExecutor->eventFd(reactor->index);
+        ev.data.fd = eventFd;
+        ev.events = EPOLLIN;
+        if(epoll_ctl(reactor->epollfd, EPOLL_CTL_ADD, eventFd, &ev) < 0){
+            std::cerr << "\033[1;31m[错误]\033[0m epoll_ctl 添加 eventfd 失败: " << strerror(errno) << std::endl;
+            exit(1);
+        }
     }
     
-    std::cout << "\033[1;32m[启动]\033[0m Epoll服务器已初始化, 监听端口: " << _port << std::endl;
+    std::cout << "\033[1;32m[启动]\033[0m Epoll服务器已初始化, 监听端口: " << _port
+              << ", 事件循环线程: " << _reactors.size() << std::endl;
 }
 
 void EpollServer::ServerStart(){
     std::cout << "\033[1;34m[运行]\033[0m 服务器开始运行, 等待连接..." << std::endl;
-    for(;;){
-        int ReadyNum = epoll_wait(_epollfd, _events, defaultEpollSize, timeout);
+    _running = true;
+    for (size_t i = 1; i < _reactors.size(); ++i) {
+        Reactor* reactor = _reactors[i].get();
+        reactor->thread = std::thread([this, reactor]() { runReactor(*reactor); });
+    }
+    if (!_reactors.empty()) {
+        runReactor(*_reactors.front());
+    }
+
+    for (auto& reactor : _reactors) {
+        if (reactor->thread.joinable()) {
+            reactor->thread.join();
+        }
+    }
+    closeReactors();
+}
+
+void EpollServer::runReactor(Reactor& reactor){
+    _currentReactor = &reactor;
+    while (_running) {
+        int ReadyNum = epoll_wait(reactor.epollfd, reactor.events, defaultEpollSize, timeout);
         switch(ReadyNum){
             case -1:
-                std::cerr << "\033[1;31m[错误]\033[0m epoll_wait 失败: " << strerror(errno) << std::endl;
+                if (errno != EINTR) {
+                    std::cerr << "\033[1;31m[错误]\033[0m epoll_wait 失败: " << strerror(errno) << std::endl;
+                }
                 break;
             case 0:
                 // timeout, 正常情况, 什么都不做
                 break;
             default:
-                HandleEvents(ReadyNum);
+                HandleEvents(reactor, ReadyNum);
         }
     }
+    _currentReactor = nullptr;
 }
 
+// 只通知各事件循环退出, 套接字由 ServerStart 在所有循环结束后关闭
 void EpollServer::ServerStop(){
-    if (_listenfd != defaultValue) {
-        close(_listenfd);
-        _listenfd = defaultValue;
+    if (!_running.exchange(false)) {
+        return;
     }
-
-    if (_epollfd != defaultValue) {
-        close(_epollfd);
-        _epollfd = defaultValue;
+    // 取得锁时已开始的广播都已结束, 之后的广播看到 _running 为 false 直接返回
+    std::lock_guard<std::mutex> lock(_reactorsMutex);
+    if (_dbExecutor) {
+        for (auto& reactor : _reactors) {
+            _dbExecutor->post(reactor->index, []() {});
+        }
     }
+}
 
-    if (_events != nullptr) {
-        delete[] _events;
-        _events = nullptr;
+void EpollServer::closeReactors(){
+    std::lock_guard<std::mutex> lock(_reactorsMutex);
+    if (_reactors.empty()) {
+        return;
     }
-
-    // 关闭所有 WebSocket 连接
-    for (int sockfd : _wsConnections) {
-        close(sockfd);
+    for (auto& reactor : _reactors) {
+        // 关闭所有客户端连接(包括 WebSocket 连接)
+        for (const auto& conn : reactor->connIds) {
+            close(conn.first);
+            SessionManager::getInstance()->removeSession(conn.first);
+        }
+        if (reactor->listenfd != defaultValue)
+            close(reactor->listenfd);
+        if (reactor->epollfd != defaultValue)
+            close(reactor->epollfd);
+        delete[] reactor->events;
     }
-    _wsConnections.clear();
+    _reactors.clear();
 
     std::cout << "\033[1;33m[停止]\033[0m 服务器已停止" << std::endl;
 }
 
-void EpollServer::HandleEvents(int ReadyNum) {
-    for(int i = 0; i < ReadyNum; ++i) {
-        int sockfd = _events[i].data.fd;
-        if(sockfd == _listenfd && (_events[i].events & EPOLLIN)) {
-            // 新客户端连接
-            std::string ip;
-            uint16_t port;
-            int connfd = Sock::Accept(_listenfd, ip, port);
-            if(connfd < 0) {
-                _log_file << "[ERROR] Accept connection failed: " << strerror(errno) << std::endl;
+// 监听套接字是非阻塞的, 一次取完已完成握手的连接
+void EpollServer::acceptConnections(Reactor& reactor) {
+    for (;;) {
+        struct sockaddr_in addr;
+        socklen_t len = sizeof(addr);
+        int connfd = accept4(reactor.listenfd, (struct sockaddr*)&addr, &len, SOCK_CLOEXEC);
+        if(connfd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
                 continue;
             }
-            
-            // 创建新的客户端会话记录
-            ClientSessionInfo sessionInfo = {ip, port, _defaultDBName, _defaultUserName, time(nullptr), 0, 0};
-            SessionManager::getInstance()->addSession(connfd, sessionInfo);
-            
-            // 输出连接信息
-            _log_file << "[INFO] Client " << ip << ":" << port 
-                      << " connected, socket: " << connfd << std::endl;
-
-            struct epoll_event ev;
-            ev.data.fd = connfd;
-            ev.events = EPOLLIN;
-            if(epoll_ctl(_epollfd, EPOLL_CTL_ADD, connfd, &ev) < 0) {
-                _log_file << "[ERROR] Failed to add client to epoll: " << strerror(errno) << std::endl;
-                close(connfd);
-                SessionManager::getInstance()->removeSession(connfd);
-                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                writeLog("[ERROR] Accept connection failed: ", strerror(errno));
             }
+            return;
+        }
+        std::string ip = inet_ntoa(addr.sin_addr);
+        uint16_t port = ntohs(addr.sin_port);
+        
+        // 创建新的客户端会话记录
+        ClientSessionInfo sessionInfo = {ip, port, _defaultDBName, _defaultUserName, time(nullptr), 0, 0};
+        SessionManager::getInstance()->addSession(connfd, sessionInfo);
+        reactor.connIds[connfd] = ++_nextConnId;
+        
+        // 输出连接信息
+        writeLog("[INFO] Client ", ip, ":", port, " connected, socket: ", connfd);
+
+        struct epoll_event ev;
+        ev.data.fd = connfd;
+        ev.events = EPOLLIN;
+        if(epoll_ctl(reactor.epollfd, EPOLL_CTL_ADD, connfd, &ev) < 0) {
+            writeLog("[ERROR] Failed to add client to epoll: ", strerror(errno));
+            close(connfd);
+            reactor.connIds.erase(connfd);
+            SessionManager::getInstance()->removeSession(connfd);
         }
-        else if(_events[i].events & EPOLLIN) {
+    }
+}
+
+void EpollServer::HandleEvents(Reactor& reactor, int ReadyNum) {
+    for(int i = 0; i < ReadyNum; ++i) {
+        int sockfd = reactor.events[i].data.fd;
+        if(sockfd == _dbExecutor->eventFd(reactor.index)) {
+            // 线程池中的查询已完成或有广播消息, 在本线程发送
+            _dbExecutor->runCompletions(reactor.index);
+        }
+        else if(sockfd == reactor.listenfd && (reactor.events[i].events & EPOLLIN)) {
+            // 新客户端连接
+            acceptConnections(reactor);
+        }
+        else if(reactor.events[i].events & EPOLLIN) {
             // 处理已连接客户端的数据
             char buffer[4096] = {0};
             ssize_t n = recv(sockfd, buffer, sizeof(buffer) - 1, 0);
@@ -180,15 +285,12 @@ void EpollServer::HandleEvents(int ReadyNum) {
             if (n <= 0) {
                 // 客户端断开连接或错误
                 if (n < 0) {
-                    _log_file << "[ERROR] Recv error: " << strerror(errno) << std::endl;
+                    writeLog("[ERROR] Recv error: ", strerror(errno));
                 }
                 
                 // 关闭连接并清理
-                close(sockfd);
-                epoll_ctl(_epollfd, EPOLL_CTL_DEL, sockfd, NULL);
-                _wsConnections.erase(sockfd);
-                SessionManager::getInstance()->removeSession(sockfd);
-                _log_file << "[INFO] Client disconnected, socket: " << sockfd << std::endl;
+                closeConnection(sockfd);
+                writeLog("[INFO] Client disconnected, socket: ", sockfd);
                 continue;
             }
 
@@ -218,11 +320,11 @@ void EpollServer::HandleEvents(int ReadyNum) {
                         request.path == _wsPath) {
                         // WebSocket握手
                         if (handleWebSocketHandshake(sockfd, request, session)) {
-                            _log_file << "[INFO] WebSocket handshake successful for client: " 
-                                     << session.ip << ":" << session.port << std::endl;
+                            writeLog("[INFO] WebSocket handshake successful for client: ",
+                                     session.ip, ":", session.port);
                         } else {
-                            _log_file << "[ERROR] WebSocket handshake failed for client: " 
-                                     << session.ip << ":" << session.port << std::endl;
+                            writeLog("[ERROR] WebSocket handshake failed for client: ",
+                                     session.ip, ":", session.port);
                         }
                     } else {
                         // 处理普通HTTP请求
@@ -242,7 +344,7 @@ void EpollServer::HandleEvents(int ReadyNum) {
                 }
             } else {
                 // 检查是否是WebSocket帧
-                if (_wsConnections.find(sockfd) != _wsConnections.end()) {
+                if (reactor.wsConnections.find(sockfd) != reactor.wsConnections.end()) {
                     // 转换为vector以便处理
                     std::vector<char> frameData(buffer, buffer + n);
                     handleWebSocketFrame(sockfd, frameData, session);
@@ -250,7 +352,7 @@ void EpollServer::HandleEvents(int ReadyNum) {
                     // 普通TCP数据处理
                     // TODO
                     // 这里是Client发送的日志数据, 交给Server::socketIO处理
-                    _log_file << "[INFO] Processing TCP log data from client" << std::endl;
+                    writeLog("[INFO] Processing TCP log data from client");
                     
                     // 设置全局服务器引用以便WebSocket广播
                     Server::g_server = this;
@@ -464,8 +566,8 @@ bool EpollServer::handleWebSocketHandshake(int sockfd, const HttpRequest& reques
     session.wsConnection.state = WebSocketState::OPEN;
     session.wsConnection.handshakeKey = it->second;
     
-    // 添加到 WebSocket 连接列表
-    _wsConnections.insert(sockfd);
+    // 添加到本事件循环的 WebSocket 连接列表
+    currentReactor().wsConnections.insert(sockfd);
     
     return true;
 }
@@ -605,10 +707,9 @@ void EpollServer::handleWebSocketFrame(int sockfd, const std::vector<char>& fram
                 
                 // 更新会话状态
                 session.wsConnection.state = WebSocketState::CLOSED;
-                _wsConnections.erase(sockfd);
                 
                 // 关闭连接
-                close(sockfd);
+                closeConnection(sockfd);
             }
             break;
             
@@ -618,12 +719,52 @@ void EpollServer::handleWebSocketFrame(int sockfd, const std::vector<char>& fram
     }
 }
 
-// 广播 WebSocket 消息到所有连接
+// 广播 WebSocket 消息到所有连接, 可以从任意线程调用; 服务器未运行时丢弃
 void EpollServer::broadcastWebSocketMessage(const std::string& message) {
-    auto frame = createWebSocketFrame(message, WebSocketOpcode::TEXT);
-    for (int sockfd : _wsConnections) {
-        send(sockfd, frame.data(), frame.size(), 0);
+    // 每个事件循环只在自己的线程中访问自己的连接列表, 其他循环的连接通过完成队列转交
+    auto frame = std::make_shared<std::vector<char>>(createWebSocketFrame(message, WebSocketOpcode::TEXT));
+    std::lock_guard<std::mutex> lock(_reactorsMutex);
+    if (!_running || !_dbExecutor) {
+        return;
     }
+    for (auto& reactor : _reactors) {
+        Reactor* target = reactor.get();
+        auto sendToAll = [target, frame]() {
+            for (int sockfd : target->wsConnections) {
+                send(sockfd, frame->data(), frame->size(), MSG_NOSIGNAL);
+            }
+        };
+        if (target == _currentReactor) {
+            sendToAll();
+        } else {
+            _dbExecutor->post(target->index, sendToAll);
+        }
+    }
+}
+
+void EpollServer::deferWebSocketReply(int sockfd, std::function<std::string()> job) {
+    Reactor& reactor = currentReactor();
+    uint64_t connId = reactor.connIds[sockfd];
+    _dbExecutor->submit(std::move(job), [this, &reactor, sockfd, connId](std::string& reply) {
+        if (!reply.empty() && connectionAlive(sockfd, connId) && reactor.wsConnections.count(sockfd)) {
+            sendWebSocketMessage(sockfd, reply);
+        }
+    }, reactor.index);
+}
+
+bool EpollServer::connectionAlive(int sockfd, uint64_t connId) {
+    const auto& connIds = currentReactor().connIds;
+    auto it = connIds.find(sockfd);
+    return it != connIds.end() && it->second == connId;
+}
+
+void EpollServer::closeConnection(int sockfd) {
+    Reactor& reactor = currentReactor();
+    epoll_ctl(reactor.epollfd, EPOLL_CTL_DEL, sockfd, NULL);
+    close(sockfd);
+    reactor.wsConnections.erase(sockfd);
+    reactor.connIds.erase(sockfd);
+    SessionManager::getInstance()->removeSession(sockfd);
 }
 
 // 处理 HTTP 请求
@@ -635,6 +776,38 @@ void EpollServer::handleHttpRequest(int sockfd, const HttpRequest& request, Clie
     switch(request.method) {
         case HttpMethod::GET:
         {
+            // 会阻塞的 API 交给线程池, 结果回到事件循环后再发送
+            auto asyncHandler = _asyncGetHandlers.find(request.path);
+            if (asyncHandler != _asyncGetHandlers.end()) {
+                size_t queue = currentReactor().index;
+                uint64_t connId = currentReactor().connIds[sockfd];
+                RequestHandler handler = asyncHandler->second;
+                _dbExecutor->submit(
+                    [handler, request, session]() mutable {
+                        try {
+                            return handler(request, session);
+                        } catch (const std::exception& e) {
+                            HttpResponse error;
+                            error.statusCode = 500;
+                            error.statusText = "Internal Server Error";
+                            error.body = e.what();
+                            error.headers["Content-Type"] = "text/plain";
+                            error.headers["Content-Length"] = std::to_string(error.body.size());
+                            return error;
+                        }
+                    },
+                    [this, sockfd, connId, path = request.path, ip = session.ip, port = session.port](HttpResponse& response) {
+                        if (!connectionAlive(sockfd, connId)) {
+                            return; // 客户端已断开
+                        }
+                        std::string responseStr = serializeHttpResponse(response);
+                        send(sockfd, responseStr.c_str(), responseStr.size(), 0);
+                        writeLog("[INFO] ", ip, ":", port, " GET ", path, " ", response.statusCode);
+                    },
+                    queue);
+                return;
+            }
+
             // 首先检查是否是 API 请求
             auto handler = _getHandlers.find(request.path);
             if (handler != _getHandlers.end()) {
@@ -673,10 +846,10 @@ void EpollServer::handleHttpRequest(int sockfd, const HttpRequest& request, Clie
     send(sockfd, responseStr.c_str(), responseStr.size(), 0);
     
     // 记录请求
-    _log_file << "[INFO] " << session.ip << ":" << session.port 
-              << " " << (request.method == HttpMethod::GET ? "GET" : "POST") 
-              << " " << request.path
-              << " " << response.statusCode << std::endl;
+    writeLog("[INFO] ", session.ip, ":", session.port,
+             " ", (request.method == HttpMethod::GET ? "GET" : "POST"),
+             " ", request.path,
+             " ", response.statusCode);
 }
 
 // 添加 GET 请求处理器
@@ -684,6 +857,11 @@ void EpollServer::addGetHandler(const std::string& path, RequestHandler handler)
     _getHandlers[path] = handler;
 }
 
+// 添加在线程池中执行的 GET 请求处理器
+void EpollServer::addAsyncGetHandler(const std::string& path, RequestHandler handler) {
+    _asyncGetHandlers[path] = handler;
+}
+
 // 添加 POST 请求处理器
 void EpollServer::addPostHandler(const std::string& path, RequestHandler handler) {
     _postHandlers[path] = handler;
@@ -18,6 +18,9 @@
 #include <functional>
 #include <unordered_map>
 #include <sstream>
+#include <thread>
+#include <mutex>
+#include <atomic>
 #include <openssl/sha.h>  // 需要 OpenSSL 库
 #include <openssl/evp.h>
 #include <openssl/bio.h>
@@ -25,6 +28,7 @@
 #include "../Util/Sock.hpp"
 #include "../MySQL/SqlConnPool.hpp"
 #include "../Util/SessionManager.hpp"
+#include "DBExecutor.hpp"
 
 namespace EpollServerSpace {
 
@@ -126,14 +130,24 @@ namespace EpollServerSpace {
     
     class EpollServer {
     private:
+        // 一个事件循环线程: 自己的 epoll 实例和 SO_REUSEPORT 监听套接字, 由内核把新连接分散到各个循环
+        // 连接从建立到关闭只由接受它的循环处理, 下面的连接状态只在该线程中访问
+        struct Reactor {
+            size_t                          index = 0;          // 同时是 DBExecutor 完成队列的下标
+            int                             listenfd = defaultValue;
+            int                             epollfd = defaultValue;
+            struct epoll_event*             events = nullptr;
+            std::set<int>                   wsConnections;      // 本循环的 WebSocket 连接
+            std::unordered_map<int, uint64_t> connIds;          // fd -> 连接编号, 防止 fd 被复用后把响应发给新连接
+            std::thread                     thread;
+        };
+
         uint64_t                        _port;
         std::string                     _defaultUserName;
         std::string                     _defaultPassword;
         std::string                     _defaultDBName;
-        int                             _listenfd;
-        int                             _epollfd;
         std::ofstream                   _log_file;
-        struct epoll_event*             _events;
+        std::mutex                      _logMutex;            // 多个事件循环共用日志文件
         std::string                     _defaultIPAddress;
         int                             _defaultPort;
         int                             _defaultMaxConn;
@@ -144,7 +158,37 @@ namespace EpollServerSpace {
         std::map<std::string, RequestHandler> _postHandlers;  // POST 请求处理器
         std::string                     _wsPath;              // WebSocket 路径
         WebSocketHandler                _wsHandler;           // WebSocket 消息处理器
-        std::set<int>                   _wsConnections;       // WebSocket 连接列表
+
+        // 阻塞操作在 DBExecutor 线程池中执行, 结果回到提交它的事件循环后再发送
+        std::map<std::string, RequestHandler> _asyncGetHandlers; // 在线程池中执行的 GET 处理器
+        std::unique_ptr<DBExecutor>     _dbExecutor;
+        std::atomic<uint64_t>           _nextConnId{0};
+
+        std::vector<std::unique_ptr<Reactor>> _reactors;
+        size_t                          _reactorCount;         // ServerInit 时创建的事件循环个数
+        std::atomic<bool>               _running{false};
+        // 其他线程广播时遍历 _reactors 并使用 _dbExecutor; 停止、关闭事件循环和销毁线程池时持有,
+        // 停止之后不再接受广播
+        std::mutex                      _reactorsMutex;
+        static thread_local Reactor*    _currentReactor;       // 当前线程运行的事件循环, 非事件循环线程为空
+
+        // 处理器中访问连接状态时使用; 非事件循环线程(例如 ServerStart 之前)退回第一个循环
+        Reactor& currentReactor();
+        bool openListener(Reactor& reactor);
+        void runReactor(Reactor& reactor);
+        void HandleEvents(Reactor& reactor, int ReadyNum);
+        void acceptConnections(Reactor& reactor);
+        void closeReactors();
+
+        template<typename... Args>
+        void writeLog(const Args&... args) {
+            std::lock_guard<std::mutex> lock(_logMutex);
+            (_log_file << ... << args) << std::endl;
+        }
+
+        // 延迟响应送达时确认连接仍是提交时的那一个
+        bool connectionAlive(int sockfd, uint64_t connId);
+        void closeConnection(int sockfd);
 
     public:
         // HTTP 相关方法
@@ -174,21 +218,34 @@ namespace EpollServerSpace {
         
         ~EpollServer();
         
+        // 事件循环线程数, 需在 ServerInit 之前设置; 0 表示按 CPU 核数
+        void setReactorThreads(size_t threads);
+        size_t reactorCount() const { return _reactors.size(); }
+
         void ServerInit();
+        // 在当前线程和另外 N-1 个线程中运行事件循环, 阻塞到 ServerStop
         void ServerStart();
+        // 可在任意线程调用
         void ServerStop();
-        void HandleEvents(int ReadyNum);
         int LeveltoInt(const std::string& level);
         
         // 路由设置方法
         void addGetHandler(const std::string& path, RequestHandler handler);
         void addPostHandler(const std::string& path, RequestHandler handler);
+        // 处理器在线程池中执行(可以阻塞查询数据库), 响应在事件循环线程中发送
+        // 处理器拿到的是请求和会话的副本, 需自行保证线程安全
+        void addAsyncGetHandler(const std::string& path, RequestHandler handler);
         void setWebSocketHandler(const std::string& path, WebSocketHandler handler);
         void setStaticFilesDir(const std::string& dir);
         
         // WebSocket相关公共方法
+        // 在连接所属的事件循环线程中调用(WebSocket 处理器、延迟回复的回调)
         void sendWebSocketMessage(int sockfd, const std::string& message);
+        // 可在任意线程调用: 帧只编码一次, 交给每个事件循环发给各自的连接
         void broadcastWebSocketMessage(const std::string& message);
+        // 在线程池中执行 job, 返回的文本作为 WebSocket 消息发回 sockfd;
+        // 返回空串表示不回复, 连接在此期间关闭时丢弃结果
+        void deferWebSocketReply(int sockfd, std::function<std::string()> job);
         std::vector<char> createWebSocketFrame(const std::string& message, WebSocketOpcode opcode = WebSocketOpcode::TEXT);
     };
 }
@@ -0,0 +1,171 @@
+#ifndef __FORMATSPEC_HPP__
+#define __FORMATSPEC_HPP__
+
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <sstream>
+#include <type_traits>
+#include <cstddef>
+
+// 编译期解析的格式串描述符
+// 构造时把 "xxx {} yyy {}" 拆分为字面量片段和占位符槽位,
+// 运行时只需按顺序拼接片段和参数, 不再调用 find/substr
+class FormatSpec {
+public:
+    static constexpr size_t MAX_PLACEHOLDERS = 16;
+
+private:
+    const char* m_format = nullptr;
+    size_t      m_length = 0;
+    size_t      m_placeholderCount = 0;
+    // 第 i 个片段位于第 i 个占位符之前, 最后一个片段位于最后一个占位符之后
+    size_t      m_segBegin[MAX_PLACEHOLDERS + 1] = {};
+    size_t      m_segLength[MAX_PLACEHOLDERS + 1] = {};
+
+public:
+    template <size_t N>
+    explicit constexpr FormatSpec(const char (&format)[N])
+        : m_format(format)
+        , m_length(N - 1)
+    {
+        size_t begin = 0;
+        size_t i = 0;
+        while(i < m_length){
+            if(i + 1 < m_length && format[i] == '{' && format[i + 1] == '}'){
+                if(m_placeholderCount >= MAX_PLACEHOLDERS){
+                    // 在编译期求值时会直接报错
+                    throw "FormatSpec: too many placeholders";
+                }
+                m_segBegin[m_placeholderCount] = begin;
+                m_segLength[m_placeholderCount] = i - begin;
+                ++m_placeholderCount;
+                i += 2;
+                begin = i;
+            }
+            else{
+                ++i;
+            }
+        }
+        m_segBegin[m_placeholderCount] = begin;
+        m_segLength[m_placeholderCount] = m_length - begin;
+    }
+
+    constexpr size_t placeholderCount() const { return m_placeholderCount; }
+    constexpr std::string_view format() const { return std::string_view(m_format, m_length); }
+    constexpr std::string_view segment(size_t index) const {
+        return std::string_view(m_format + m_segBegin[index], m_segLength[index]);
+    }
+};
+
+// 在静态存储区生成格式串描述符, 解析在编译期完成
+// 用法: logger.log_in_text(INFO, LOG_FMT("User {} login from {}"), user, ip);
+#define LOG_FMT(str) \
+    ([]() -> const FormatSpec& { static constexpr FormatSpec spec(str); return spec; }())
+
+namespace FormatDetail {
+
+    // 各类型参数直接追加到输出缓冲区, 不产生临时 std::string
+    inline void appendArg(std::string& out, std::string_view value) {
+        out.append(value.data(), value.size());
+    }
+
+    inline void appendArg(std::string& out, const std::string& value) {
+        out.append(value);
+    }
+
+    inline void appendArg(std::string& out, const char* value) {
+        if(value){
+            out.append(value);
+        }
+    }
+
+    inline void appendArg(std::string& out, char value) {
+        out.push_back(value);
+    }
+
+    inline void appendArg(std::string& out, bool value) {
+        // 与 std::ostream 默认输出保持一致
+        out.push_back(value ? '1' : '0');
+    }
+
+    template <typename T>
+    void appendArg(std::string& out, const T& value) {
+        if constexpr (std::is_integral_v<T>) {
+            char buf[24];
+            auto result = std::to_chars(buf, buf + sizeof(buf), value);
+            out.append(buf, result.ptr - buf);
+        }
+        else if constexpr (std::is_floating_point_v<T>) {
+            // general + 6 位精度, 与 std::ostream 默认输出一致
+            char buf[32];
+            auto result = std::to_chars(buf, buf + sizeof(buf), value, std::chars_format::general, 6);
+            out.append(buf, result.ptr - buf);
+        }
+        else if constexpr (std::is_enum_v<T>) {
+            appendArg(out, static_cast<std::underlying_type_t<T>>(value));
+        }
+        else {
+            // 其他自定义类型回退到 operator<<
+            std::ostringstream os;
+            os << value;
+            out.append(os.str());
+        }
+    }
+
+    // 按编译期拆分好的片段拼接参数
+    // 参数多于占位符时追加在末尾, 少于占位符时剩余的 "{}" 原样输出
+    template <typename ...Args>
+    void formatTo(std::string& out, const FormatSpec& spec, const Args& ...args) {
+        size_t index = 0;
+        auto appendSegment = [&out, &spec](size_t i) {
+            std::string_view seg = spec.segment(i);
+            out.append(seg.data(), seg.size());
+        };
+        auto appendOne = [&](const auto& arg) {
+            if(index <= spec.placeholderCount()){
+                // index == placeholderCount 时写入的是尾部片段, 其后为多余参数
+                appendSegment(index);
+            }
+            appendArg(out, arg);
+            ++index;
+        };
+        (appendOne(args), ...);
+        (void)appendOne;    // 无参数时避免未使用告警
+
+        for(; index < spec.placeholderCount(); ++index){
+            appendSegment(index);
+            out.append("{}", 2);
+        }
+        if(index == spec.placeholderCount()){
+            appendSegment(index);
+        }
+    }
+
+    // 运行期格式串版本, 用于格式串本身是动态拼接出来的场景
+    template <typename ...Args>
+    void formatTo(std::string& out, std::string_view format, const Args& ...args) {
+        size_t last = 0;
+        auto appendOne = [&out, &format, &last](const auto& arg) {
+            size_t pos = (last == std::string_view::npos) ? std::string_view::npos : format.find("{}", last);
+            if(pos != std::string_view::npos){
+                out.append(format.data() + last, pos - last);
+                last = pos + 2;
+            }
+            else if(last != std::string_view::npos){
+                out.append(format.data() + last, format.size() - last);
+                last = std::string_view::npos;
+            }
+            appendArg(out, arg);
+        };
+        (appendOne(args), ...);
+        (void)appendOne;    // 无参数时避免未使用告警
+
+        if(last != std::string_view::npos){
+            out.append(format.data() + last, format.size() - last);
+        }
+    }
+
+} // namespace FormatDetail
+
+#endif // __FORMATSPEC_HPP__
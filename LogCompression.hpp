@@ -0,0 +1,226 @@
+#ifndef __LOGCOMPRESSION_HPP__
+#define __LOGCOMPRESSION_HPP__
+
+#include <zlib.h>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <cstdint>
+#include <cstdio>
+#include <algorithm>
+#include <filesystem>
+
+// 轮转后历史日志的压缩与读取
+// 压缩文件由多个独立的 gzip 成员(帧)拼接而成, 每帧对应 FRAME_SIZE 字节原文,
+// 整体仍是合法的 .gz 文件, 可直接用 gzip/zcat 解压;
+// 同名 .idx 旁路文件记录每帧的原文偏移和压缩偏移, 读取任意区间时只需解压覆盖该区间的帧
+namespace LogCompression {
+
+    namespace fs = std::filesystem;
+
+    static const size_t FRAME_SIZE = 1024 * 1024;   // 每帧原文 1MB
+    static const char* const EXTENSION = ".gz";
+    static const char* const INDEX_EXTENSION = ".idx";
+
+    struct FrameIndexEntry {
+        uint64_t    rawOffset;          // 帧起始处在原文中的偏移
+        uint64_t    compressedOffset;   // 帧起始处在压缩文件中的偏移
+    };
+
+    inline fs::path indexPathFor(const fs::path& compressed) {
+        return fs::path(compressed.string() + INDEX_EXTENSION);
+    }
+
+    inline bool isCompressed(const fs::path& path) {
+        return path.extension() == EXTENSION;
+    }
+
+    // 把一帧原文压缩为一个完整的 gzip 成员并追加到 out
+    inline bool compressFrame(const char* data, size_t size, std::string& out, int level) {
+        z_stream zs{};
+        // windowBits 15 + 16 表示输出 gzip 头尾
+        if (deflateInit2(&zs, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            return false;
+        }
+        size_t begin = out.size();
+        out.resize(begin + deflateBound(&zs, static_cast<uLong>(size)));
+        zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        zs.avail_in = static_cast<uInt>(size);
+        zs.next_out = reinterpret_cast<Bytef*>(&out[begin]);
+        zs.avail_out = static_cast<uInt>(out.size() - begin);
+        int ret = deflate(&zs, Z_FINISH);
+        out.resize(begin + zs.total_out);
+        deflateEnd(&zs);
+        return ret == Z_STREAM_END;
+    }
+
+    // 压缩 src 为 dst(.gz) 并生成帧索引; 成功后由调用方决定是否删除 src
+    // 先写临时文件再改名, 中途失败不会留下不完整的压缩文件
+    inline bool compressFile(const fs::path& src, const fs::path& dst, int level = Z_DEFAULT_COMPRESSION) {
+        std::ifstream in(src, std::ios::binary);
+        if (!in.is_open()) {
+            return false;
+        }
+        fs::path tmp = fs::path(dst.string() + ".tmp");
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            return false;
+        }
+
+        std::vector<FrameIndexEntry> index;
+        std::vector<char> raw(FRAME_SIZE);
+        std::string frame;
+        uint64_t rawOffset = 0;
+        uint64_t compressedOffset = 0;
+        while (in) {
+            in.read(raw.data(), static_cast<std::streamsize>(raw.size()));
+            size_t n = static_cast<size_t>(in.gcount());
+            if (n == 0) {
+                break;
+            }
+            frame.clear();
+            if (!compressFrame(raw.data(), n, frame, level)) {
+                out.close();
+                fs::remove(tmp);
+                return false;
+            }
+            index.push_back({rawOffset, compressedOffset});
+            out.write(frame.data(), static_cast<std::streamsize>(frame.size()));
+            rawOffset += n;
+            compressedOffset += frame.size();
+        }
+        out.close();
+        if (!out) {
+            fs::remove(tmp);
+            return false;
+        }
+
+        // 索引: 第一行为原文总长度, 之后每行 "原文偏移 压缩偏移"
+        std::ofstream idx(indexPathFor(dst), std::ios::trunc);
+        idx << rawOffset << "\n";
+        for (const auto& entry : index) {
+            idx << entry.rawOffset << " " << entry.compressedOffset << "\n";
+        }
+        idx.close();
+
+        std::error_code ec;
+        fs::rename(tmp, dst, ec);
+        return !ec;
+    }
+
+    inline bool readIndex(const fs::path& compressed, std::vector<FrameIndexEntry>& index, uint64_t& rawSize) {
+        std::ifstream idx(indexPathFor(compressed));
+        if (!idx.is_open() || !(idx >> rawSize)) {
+            return false;
+        }
+        index.clear();
+        FrameIndexEntry entry{};
+        while (idx >> entry.rawOffset >> entry.compressedOffset) {
+            index.push_back(entry);
+        }
+        return true;
+    }
+
+    // 从 compressedOffset 开始流式解压, 每解出一块就交给 sink(const char*, size_t);
+    // sink 返回 false 时提前结束. 支持多个 gzip 成员首尾相接
+    template <typename Sink>
+    bool decompressStream(const fs::path& compressed, Sink sink, uint64_t compressedOffset = 0) {
+        std::ifstream in(compressed, std::ios::binary);
+        if (!in.is_open()) {
+            return false;
+        }
+        in.seekg(static_cast<std::streamoff>(compressedOffset));
+
+        z_stream zs{};
+        if (inflateInit2(&zs, 15 + 32) != Z_OK) {   // 15 + 32: 自动识别 gzip/zlib 头
+            return false;
+        }
+        std::vector<char> input(64 * 1024);
+        std::vector<char> output(256 * 1024);
+        bool ok = true;
+        bool stop = false;
+        while (ok && !stop) {
+            in.read(input.data(), static_cast<std::streamsize>(input.size()));
+            size_t n = static_cast<size_t>(in.gcount());
+            if (n == 0) {
+                break;
+            }
+            zs.next_in = reinterpret_cast<Bytef*>(input.data());
+            zs.avail_in = static_cast<uInt>(n);
+            while (zs.avail_in > 0 && !stop) {
+                zs.next_out = reinterpret_cast<Bytef*>(output.data());
+                zs.avail_out = static_cast<uInt>(output.size());
+                int ret = inflate(&zs, Z_NO_FLUSH);
+                if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+                    ok = false;
+                    break;
+                }
+                size_t produced = output.size() - zs.avail_out;
+                if (produced > 0 && !sink(output.data(), produced)) {
+                    stop = true;
+                }
+                if (ret == Z_STREAM_END) {
+                    // 一个成员结束, 继续解下一个成员
+                    inflateReset(&zs);
+                }
+                else if (ret == Z_BUF_ERROR) {
+                    break;
+                }
+            }
+        }
+        inflateEnd(&zs);
+        return ok;
+    }
+
+    // 读取整个日志文件内容, 压缩文件自动解压
+    inline bool readAll(const fs::path& path, std::string& out) {
+        if (!isCompressed(path)) {
+            std::ifstream in(path, std::ios::binary);
+            if (!in.is_open()) {
+                return false;
+            }
+            std::ostringstream content;
+            content << in.rdbuf();
+            out = content.str();
+            return true;
+        }
+        out.clear();
+        return decompressStream(path, [&out](const char* data, size_t size) {
+            out.append(data, size);
+            return true;
+        });
+    }
+
+    // 读取原文 [offset, offset + length) 区间, 借助帧索引跳过之前的帧
+    inline bool readRange(const fs::path& compressed, uint64_t offset, size_t length, std::string& out) {
+        std::vector<FrameIndexEntry> index;
+        uint64_t rawSize = 0;
+        out.clear();
+        if (!readIndex(compressed, index, rawSize)) {
+            return false;
+        }
+        if (offset >= rawSize || length == 0 || index.empty()) {
+            return true;
+        }
+
+        size_t frame = 0;
+        while (frame + 1 < index.size() && index[frame + 1].rawOffset <= offset) {
+            ++frame;
+        }
+        uint64_t position = index[frame].rawOffset;
+        return decompressStream(compressed, [&](const char* data, size_t size) {
+            uint64_t end = position + size;
+            if (end > offset) {
+                size_t skip = position < offset ? static_cast<size_t>(offset - position) : 0;
+                size_t take = std::min(size - skip, length - out.size());
+                out.append(data + skip, take);
+            }
+            position = end;
+            return out.size() < length;
+        }, index[frame].compressedOffset);
+    }
+
+} // namespace LogCompression
+
+#endif // __LOGCOMPRESSION_HPP__
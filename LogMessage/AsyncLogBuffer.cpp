@@ -1,12 +1,30 @@
 #include "AsyncLogBuffer.hpp"
 #include <fcntl.h>
 #include <unistd.h>
+#include <climits>
+#include <sys/uio.h>
 #include <iostream>
+#include <cstring>
+#include <cerrno>
 
-AsyncLogBuffer::AsyncLogBuffer(const std::string& logPath) : logFilePath_(logPath) {
-    currentBuffer.reserve(BUFFER_SIZE);
-    nextBuffer.reserve(BUFFER_SIZE);
-    
+constexpr std::chrono::milliseconds AsyncLogBuffer::FLUSH_INTERVAL;
+
+namespace {
+    std::atomic<uint64_t> nextInstanceId{1};
+
+    // 线程局部缓存: 当前线程最近使用的缓冲区实例及其暂存区
+    struct LocalStagingCache {
+        uint64_t owner = 0;
+        std::shared_ptr<void> staging;
+    };
+    thread_local LocalStagingCache localCache;
+}
+
+AsyncLogBuffer::AsyncLogBuffer(const std::string& logPath, const LogSyncOptions& syncOptions,
+                               const OverloadPolicy& overloadPolicy)
+    : overload_(overloadPolicy, MAX_ARENAS),
+      instanceId_(nextInstanceId.fetch_add(1)), logFilePath_(logPath), syncOptions_(syncOptions),
+      lastSync_(std::chrono::steady_clock::now()) {
     // 启动后台刷新线程
     flushThread_ = std::thread(&AsyncLogBuffer::flushThreadFunc, this);
 }
@@ -17,104 +35,310 @@ AsyncLogBuffer::~AsyncLogBuffer() {
         running_ = false;
         cv_.notify_one();
     }
-    
+
     if (flushThread_.joinable()) {
         flushThread_.join();
     }
 }
 
-void AsyncLogBuffer::append(const std::string& logLine) {
+AsyncLogBuffer::ThreadStaging& AsyncLogBuffer::localStaging() {
+    if (localCache.owner != instanceId_) {
+        // 线程第一次写入本实例, 注册一个新的暂存区
+        auto staging = std::make_shared<ThreadStaging>();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stagings_.push_back(staging);
+        }
+        localCache.owner = instanceId_;
+        localCache.staging = staging;
+    }
+    return *static_cast<ThreadStaging*>(localCache.staging.get());
+}
+
+// 优先从空闲链表取字节块; 达到上限时请求后台线程收走各线程的字节块,
+// canWait 为 true 时等待归还, 否则返回空指针由调用方丢弃日志
+AsyncLogBuffer::ArenaPtr AsyncLogBuffer::acquireArena(size_t minSize, bool canWait) {
+    if (minSize > ARENA_SIZE) {
+        // 超长日志单独分配, 写入后直接释放, 不进入空闲链表
+        return ArenaPtr(new Arena(minSize));
+    }
+
     std::unique_lock<std::mutex> lock(mutex_);
-    
-    if (currentBuffer.size() < BUFFER_SIZE) {
-        currentBuffer.push_back(logLine);
-    } else {
-        // 当前缓冲区已满, 交换到fullBuffers队列
-        fullBuffers.push_back(std::move(currentBuffer));
-        
-        // 如果nextBuffer可用, 则与currentBuffer交换
-        if (!nextBuffer.empty()) {
-            currentBuffer = std::move(nextBuffer);
+    while (freeArenas_.empty() && arenaCount_ >= overload_.capacity() && running_) {
+        flushRequested_ = true;
+        cv_.notify_one();
+        if (!canWait) {
+            return nullptr;
+        }
+        arenaCv_.wait_for(lock, FLUSH_INTERVAL);
+    }
+    if (!freeArenas_.empty()) {
+        ArenaPtr arena = std::move(freeArenas_.back());
+        freeArenas_.pop_back();
+        return arena;
+    }
+    ++arenaCount_;
+    return ArenaPtr(new Arena(ARENA_SIZE));
+}
+
+// 写入完成的字节块清空后放回空闲链表, 超长日志的字节块直接释放
+void AsyncLogBuffer::recycleArenas(std::vector<ArenaPtr>& arenas) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pendingArenas_.fetch_sub(arenas.size(), std::memory_order_relaxed);
+    for (auto& arena : arenas) {
+        if (arena->capacity == ARENA_SIZE) {
+            arena->used = 0;
+            arena->sync = false;
+            freeArenas_.push_back(std::move(arena));
+        }
+    }
+    arenas.clear();
+    arenaCv_.notify_all();
+}
+
+void AsyncLogBuffer::handOff(ArenaPtr arena) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    fullArenas_.push_back(std::move(arena));
+    pendingArenas_.fetch_add(1, std::memory_order_relaxed);
+    cv_.notify_one(); // 通知后台线程开始写入
+}
+
+void AsyncLogBuffer::append(const std::string& logLine, LOG_LEVEL level) {
+    // 以待写字节块数衡量积压, 各线程暂存中的字节块不算在内
+    if (!overload_.admit(level, pendingArenas_.load(std::memory_order_relaxed))) {
+        return;
+    }
+
+    ThreadStaging& staging = localStaging();
+    std::unique_lock<std::mutex> lock(staging.mutex);
+    auto now = std::chrono::steady_clock::now();
+
+    if (!staging.arena || staging.arena->available() < logLine.size()) {
+        // 放不下时先交出当前字节块, 再换一个新的; 等待新块时不持有暂存区锁,
+        // 以免后台线程收集暂存区时被阻塞
+        ArenaPtr full = std::move(staging.arena);
+        lock.unlock();
+        if (full) {
+            handOff(std::move(full));
+        }
+        ArenaPtr fresh = acquireArena(logLine.size(), overload_.actionFor(level) == OverloadAction::BLOCK);
+        if (!fresh) {
+            overload_.recordDrop(level);
+            return;
+        }
+        lock.lock();
+        staging.arena = std::move(fresh);
+        staging.firstAppend = now;
+    }
+
+    Arena& arena = *staging.arena;
+    std::memcpy(arena.data.get() + arena.used, logLine.data(), logLine.size());
+    arena.used += logLine.size();
+
+    // ON_ERROR 策略下错误日志所在的字节块立即交出, 写入后刷盘
+    bool urgent = level == ERROR || level == FATAL;
+    bool syncNow = urgent && syncOptions_.policy == LogSyncPolicy::ON_ERROR;
+    if (syncNow) {
+        arena.sync = true;
+    }
+
+    // 停留过久的字节块整块交出, 下一条日志再换新块
+    if (syncNow || now - staging.firstAppend >= FLUSH_INTERVAL) {
+        ArenaPtr aged = std::move(staging.arena);
+        lock.unlock();
+        handOff(std::move(aged));
+    }
+}
+
+void AsyncLogBuffer::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    flushRequested_ = true;
+    cv_.notify_one();
+}
+
+void AsyncLogBuffer::reopen() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    reopenRequested_ = true;
+    cv_.notify_one();
+}
+
+void AsyncLogBuffer::requestReopen() {
+    reopenRequested_.store(true, std::memory_order_relaxed);
+}
+
+// 从各线程暂存区收走字节块; force 为 false 时只收走超过刷新间隔的字节块
+// 调用方需持有 mutex_
+void AsyncLogBuffer::collectStagings(std::vector<ArenaPtr>& out, bool force) {
+    auto now = std::chrono::steady_clock::now();
+    for (auto it = stagings_.begin(); it != stagings_.end();) {
+        ThreadStaging& staging = **it;
+        bool empty = false;
+        {
+            std::lock_guard<std::mutex> lock(staging.mutex);
+            if (staging.arena && (force || now - staging.firstAppend >= FLUSH_INTERVAL)) {
+                out.push_back(std::move(staging.arena));
+                pendingArenas_.fetch_add(1, std::memory_order_relaxed);
+            }
+            empty = !staging.arena;
+        }
+
+        // 线程已退出(只剩这里持有引用)且没有残留数据时注销暂存区
+        if (empty && it->use_count() == 1) {
+            it = stagings_.erase(it);
         } else {
-            // 创建新缓冲区
-            currentBuffer.clear();
-            currentBuffer.reserve(BUFFER_SIZE);
+            ++it;
+        }
+    }
+}
+
+// 打开(或重新打开)日志文件, 失败时保留 fd_ = -1, 下一批写入时重试
+bool AsyncLogBuffer::openFile() {
+    if (fd_ >= 0) {
+        syncIfNeeded(true);
+        close(fd_);
+    }
+    fd_ = open(logFilePath_.c_str(), O_CREAT | O_WRONLY | O_APPEND | O_CLOEXEC, 0666);
+    if (fd_ < 0) {
+        std::cerr << "AsyncLogBuffer: failed to open " << logFilePath_ << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 所有字节块组成 iovec 数组, 每次 writev 最多 IOV_MAX 段, 处理部分写入和 EINTR
+void AsyncLogBuffer::writeArenas(const std::vector<ArenaPtr>& arenas) {
+    if (reopenRequested_.exchange(false) || fd_ < 0) {
+        openFile();
+    }
+    if (fd_ < 0) {
+        return;
+    }
+
+    std::vector<struct iovec> iov;
+    iov.reserve(arenas.size());
+    bool syncRequested = false;
+    for (const auto& arena : arenas) {
+        if (arena->used > 0) {
+            iov.push_back({arena->data.get(), arena->used});
         }
-        
-        currentBuffer.push_back(logLine);
-        cv_.notify_one(); // 通知后台线程开始写入
+        syncRequested = syncRequested || arena->sync;
+    }
+
+    size_t index = 0;
+    while (index < iov.size()) {
+        int count = static_cast<int>(std::min<size_t>(iov.size() - index, IOV_MAX));
+        ssize_t n = writev(fd_, &iov[index], count);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "AsyncLogBuffer: writev failed: " << strerror(errno) << std::endl;
+            break;
+        }
+        bytesSinceSync_ += static_cast<size_t>(n);
+
+        // 跳过已完整写出的段, 部分写出的段调整起始位置后继续
+        size_t written = static_cast<size_t>(n);
+        while (index < iov.size() && written >= iov[index].iov_len) {
+            written -= iov[index].iov_len;
+            ++index;
+        }
+        if (index < iov.size() && written > 0) {
+            iov[index].iov_base = static_cast<char*>(iov[index].iov_base) + written;
+            iov[index].iov_len -= written;
+        }
+    }
+
+    syncIfNeeded(syncRequested);
+}
+
+// 有日志因过载被丢弃时, 按间隔在日志文件中写入一行汇总
+void AsyncLogBuffer::writeOverloadSummary() {
+    std::string summary;
+    if (fd_ < 0 || !overload_.takeSummary("AsyncLogBuffer", summary)) {
+        return;
     }
+    summary.push_back('\n');
+    ssize_t n = write(fd_, summary.data(), summary.size());
+    if (n > 0) {
+        bytesSinceSync_ += static_cast<size_t>(n);
+    }
+}
+
+// 按策略决定是否 fdatasync; force 为 true 时只要有未刷盘数据就刷盘
+void AsyncLogBuffer::syncIfNeeded(bool force) {
+    if (fd_ < 0 || bytesSinceSync_ == 0) {
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    bool needSync = force;
+    switch (syncOptions_.policy) {
+        case LogSyncPolicy::NEVER:
+            needSync = false;
+            break;
+        case LogSyncPolicy::EVERY_N_BYTES:
+            needSync = needSync || bytesSinceSync_ >= syncOptions_.everyBytes;
+            break;
+        case LogSyncPolicy::INTERVAL:
+            needSync = needSync || now - lastSync_ >= syncOptions_.interval;
+            break;
+        case LogSyncPolicy::ON_ERROR:
+            break;
+    }
+    if (!needSync) {
+        return;
+    }
+
+    fdatasync(fd_);
+    bytesSinceSync_ = 0;
+    lastSync_ = now;
 }
 
 void AsyncLogBuffer::flushThreadFunc() {
-    std::vector<std::vector<std::string>> buffersToWrite;
-    
+    std::vector<ArenaPtr> arenasToWrite;
+
     while (running_) {
         {
             std::unique_lock<std::mutex> lock(mutex_);
-            
-            // 等待直到有数据可写或程序退出
-            cv_.wait_for(lock, std::chrono::seconds(3), [this] {
-                return !fullBuffers.empty() || !running_;
+
+            // 等待直到有字节块交接、收到刷新或重开请求、到达刷新间隔或程序退出
+            cv_.wait_for(lock, FLUSH_INTERVAL, [this] {
+                return !fullArenas_.empty() || flushRequested_ || reopenRequested_ || !running_;
             });
-            
-            // 收集所有待写入的缓冲区
-            if (!fullBuffers.empty()) {
-                buffersToWrite.swap(fullBuffers);
-                
-                // 如果当前缓冲区也已经有内容, 将其加入待写队列
-                if (!currentBuffer.empty()) {
-                    buffersToWrite.push_back(std::move(currentBuffer));
-                    
-                    // 恢复缓冲区
-                    if (!nextBuffer.empty()) {
-                        currentBuffer = std::move(nextBuffer);
-                    } else {
-                        currentBuffer.clear();
-                        currentBuffer.reserve(BUFFER_SIZE);
-                    }
-                }
-                
-                // 确保nextBuffer可用
-                if (nextBuffer.empty()) {
-                    nextBuffer.reserve(BUFFER_SIZE);
-                }
-            }
+
+            arenasToWrite.swap(fullArenas_);
+            // 空闲线程的字节块不会因写满而交出, 由后台线程按时间收走
+            collectStagings(arenasToWrite, flushRequested_);
+            flushRequested_ = false;
         }
-        
-        // 批量写入文件
-        if (!buffersToWrite.empty()) {
-            int fd = open(logFilePath_.c_str(), O_CREAT | O_WRONLY | O_APPEND, 0666);
-            if (fd >= 0) {
-                for (const auto& buffer : buffersToWrite) {
-                    for (const auto& line : buffer) {
-                        write(fd, line.c_str(), line.size());
-                    }
-                }
-                close(fd);
+
+        // 批量写入文件并归还字节块
+        if (!arenasToWrite.empty()) {
+            writeArenas(arenasToWrite);
+            recycleArenas(arenasToWrite);
+            writeOverloadSummary();
+        } else {
+            if (reopenRequested_.exchange(false)) {
+                openFile();
             }
-            
-            buffersToWrite.clear();
+            // 空闲时也要照顾 INTERVAL 策略下尚未刷盘的数据
+            syncIfNeeded(false);
         }
     }
-    
+
     // 程序退出前确保所有日志都写入
-    int fd = open(logFilePath_.c_str(), O_CREAT | O_WRONLY | O_APPEND, 0666);
-    if (fd >= 0) {
-        std::unique_lock<std::mutex> lock(mutex_);
-        
-        // 写入剩余的所有缓冲区
-        for (const auto& buffer : fullBuffers) {
-            for (const auto& line : buffer) {
-                write(fd, line.c_str(), line.size());
-            }
-        }
-        
-        // 写入当前缓冲区
-        for (const auto& line : currentBuffer) {
-            write(fd, line.c_str(), line.size());
-        }
-        
-        close(fd);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        arenasToWrite.swap(fullArenas_);
+        collectStagings(arenasToWrite, true);
     }
-}
\ No newline at end of file
+    writeArenas(arenasToWrite);
+    recycleArenas(arenasToWrite);
+
+    if (fd_ >= 0) {
+        syncIfNeeded(syncOptions_.policy != LogSyncPolicy::NEVER);
+        close(fd_);
+        fd_ = -1;
+    }
+}
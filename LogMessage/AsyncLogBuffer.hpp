@@ -3,32 +3,110 @@
 
 #include <string>
 #include <vector>
+#include <memory>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "LogLevel.hpp"
+#include "OverloadPolicy.hpp"
 
+// 刷盘(fdatasync)策略
+enum class LogSyncPolicy {
+    NEVER,          // 只写入页缓存, 由内核决定何时落盘
+    EVERY_N_BYTES,  // 累计写入 everyBytes 字节后刷盘一次
+    INTERVAL,       // 距上次刷盘超过 interval 且有新数据时刷盘
+    ON_ERROR        // ERROR/FATAL 日志立即交出并在写入后刷盘
+};
+
+struct LogSyncOptions {
+    LogSyncPolicy               policy = LogSyncPolicy::NEVER;
+    size_t                      everyBytes = 4 * 1024 * 1024;
+    std::chrono::milliseconds   interval{1000};
+};
+
+// 异步日志缓冲区
+// 每个生产者线程先把日志拷贝进自己持有的定长字节块(arena), 块写满或超过刷新间隔后
+// 才持有全局锁把整块交给后台线程, 生产者大约每 ARENA_SIZE 字节才接触一次共享状态
+// 字节块写入文件后回收到空闲链表复用, 总数不超过过载策略的容量(默认 MAX_ARENAS), 内存占用有明确上限;
+// 占用超过高水位后按等级削减 DEBUG/INFO, 字节块用尽时 BLOCK 等级阻塞等待后台线程归还
+// 后台线程常驻持有日志文件描述符, 每批字节块用 writev 一次写出 (每次最多 IOV_MAX 段),
+// 只有调用 reopen/requestReopen (如配合 logrotate 的 SIGHUP) 时才重新打开文件
+// 注意: 输出顺序只保证同一线程内有序, 不同线程的日志按字节块交接的先后交错写入
 class AsyncLogBuffer {
 private:
-    static const size_t BUFFER_SIZE = 1024 * 1024; // 1MB缓冲区
-    
-    std::vector<std::string> currentBuffer;  // 前台缓冲区
-    std::vector<std::string> nextBuffer;     // 后台缓冲区
-    std::vector<std::vector<std::string>> fullBuffers; // 已满的缓冲区队列
-    
+    static const size_t ARENA_SIZE = 1024 * 1024;                   // 单个字节块 1MB
+    static const size_t MAX_ARENAS = 32;                            // 默认最多同时存在的字节块数
+    static constexpr std::chrono::milliseconds FLUSH_INTERVAL{1000}; // 字节块最长停留时间
+
+    // 连续的日志字节块, 一个块对应一次 write 调用
+    struct Arena {
+        std::unique_ptr<char[]> data;
+        size_t                  capacity = 0;
+        size_t                  used = 0;
+        bool                    sync = false;   // 写入后需要刷盘 (ON_ERROR 策略)
+
+        explicit Arena(size_t size) : data(new char[size]), capacity(size) {}
+        size_t available() const { return capacity - used; }
+    };
+    using ArenaPtr = std::unique_ptr<Arena>;
+
+    // 单个生产者线程的暂存区, 只有该线程与后台线程会访问, 锁基本无竞争
+    struct ThreadStaging {
+        std::mutex                              mutex;
+        ArenaPtr                                arena;          // 为空表示当前没有未交出的数据
+        std::chrono::steady_clock::time_point   firstAppend;    // 当前字节块第一条日志的时间
+    };
+
+    std::vector<std::shared_ptr<ThreadStaging>> stagings_;      // 已注册的线程暂存区
+    std::vector<ArenaPtr> fullArenas_;                          // 已交接待写入的字节块
+    std::vector<ArenaPtr> freeArenas_;                          // 已写入可复用的字节块
+    size_t arenaCount_ = 0;                                     // 已分配的定长字节块数
+    std::atomic<size_t> pendingArenas_{0};                      // 已交出但尚未写完的字节块数, 反映下游积压
+    OverloadController overload_;                               // 容量单位为字节块个数
+
     std::mutex mutex_;
     std::condition_variable cv_;
+    std::condition_variable arenaCv_;   // 有字节块归还时通知等待的生产者
     std::thread flushThread_;
     std::atomic<bool> running_{true};
-    
+    bool flushRequested_ = false;
+
+    const uint64_t instanceId_;     // 区分线程局部缓存属于哪个缓冲区实例
     std::string logFilePath_;
-    
+    const LogSyncOptions syncOptions_;
+    std::atomic<bool> reopenRequested_{false};
+
+    // 以下成员只由后台线程访问
+    int fd_ = -1;
+    size_t bytesSinceSync_ = 0;
+    std::chrono::steady_clock::time_point lastSync_;
+
+    ThreadStaging& localStaging();
+    ArenaPtr acquireArena(size_t minSize, bool canWait);
+    void recycleArenas(std::vector<ArenaPtr>& arenas);
+    void handOff(ArenaPtr arena);
+    void collectStagings(std::vector<ArenaPtr>& out, bool force);
+    bool openFile();
+    void writeArenas(const std::vector<ArenaPtr>& arenas);
+    void syncIfNeeded(bool force);
+    void writeOverloadSummary();
+
 public:
-    AsyncLogBuffer(const std::string& logPath);
+    AsyncLogBuffer(const std::string& logPath, const LogSyncOptions& syncOptions = LogSyncOptions(),
+                   const OverloadPolicy& overloadPolicy = OverloadPolicy());
     ~AsyncLogBuffer();
-    
-    void append(const std::string& logLine);
+
+    // level 用于过载削减; ERROR/FATAL 在 ON_ERROR 刷盘策略下会尽快落盘
+    void append(const std::string& logLine, LOG_LEVEL level = INFO);
+    uint64_t droppedCount() const { return overload_.totalDropped(); }
+    void flush();   // 交出所有线程未写满的字节块并唤醒后台线程立即写入
+    void reopen();  // 请求后台线程在下一批写入前重新打开日志文件
+    // 只设置原子标志, 可在信号处理函数中调用; 后台线程最迟在一个刷新间隔后处理
+    void requestReopen();
     void flushThreadFunc();
 };
 
-#endif // __ASYNC_LOG_BUFFER_HPP__
\ No newline at end of file
+#endif // __ASYNC_LOG_BUFFER_HPP__
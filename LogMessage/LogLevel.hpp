@@ -0,0 +1,29 @@
+#ifndef __LOG_LEVEL_HPP__
+#define __LOG_LEVEL_HPP__
+
+#include <string>
+
+#define NORMAL 0
+#define INFO 1
+#define WARNING 2
+#define ERROR 3
+#define FATAL 4
+#define DEBUG 5
+
+#define LOG_LEVEL int
+
+// 日志等级个数, 用于按等级索引的数组
+#define LOG_LEVEL_COUNT 6
+
+// 等级名称 (如 "INFO") 转为等级编号, 无法识别时按 INFO 处理
+inline LOG_LEVEL levelFromName(const std::string& name)
+{
+    if (name == "NORMAL") return NORMAL;
+    if (name == "WARNING") return WARNING;
+    if (name == "ERROR") return ERROR;
+    if (name == "FATAL") return FATAL;
+    if (name == "DEBUG") return DEBUG;
+    return INFO;
+}
+
+#endif // __LOG_LEVEL_HPP__
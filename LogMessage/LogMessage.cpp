@@ -30,10 +30,12 @@ std::string to_log(LOG_LEVEL level)
 std::string LogMessage::default_log_path = "";
 std::unique_ptr<AsyncLogBuffer> LogMessage::logBuffer = nullptr;
 std::once_flag LogMessage::initFlag;
+LogSyncOptions LogMessage::syncOptions;
+OverloadPolicy LogMessage::overloadPolicy;
 
 void LogMessage::initializeBuffer() {
     if (!default_log_path.empty()) {
-        logBuffer = std::make_unique<AsyncLogBuffer>(default_log_path);
+        logBuffer = std::make_unique<AsyncLogBuffer>(default_log_path, syncOptions, overloadPolicy);
     }
 }
 
@@ -62,7 +64,7 @@ void LogMessage::logMessage(LOG_LEVEL level, const char *message, ...)
     std::string logLine = std::string(buffer) + std::string(content) + "\n";
     
     // 添加到异步缓冲区
-    logBuffer->append(logLine);
+    logBuffer->append(logLine, level);
 
     va_end(args);
 }
@@ -73,13 +75,27 @@ void LogMessage::setDefaultLogPath(const std::string &path)
     
     // 如果更改了路径，重新初始化缓冲区
     if (logBuffer) {
-        logBuffer = std::make_unique<AsyncLogBuffer>(path);
+        logBuffer = std::make_unique<AsyncLogBuffer>(path, syncOptions, overloadPolicy);
     }
 }
 
 void LogMessage::flush() {
-    // 创建临时空日志，触发缓冲区刷新（仅用于立即需要写入的情况）
+    // 交出各线程暂存的分块并唤醒后台线程立即写入
     if (logBuffer) {
-        logBuffer->append("");
+        logBuffer->flush();
     }
-}
\ No newline at end of file
+}
+
+void LogMessage::setSyncOptions(const LogSyncOptions &options) {
+    syncOptions = options;
+}
+
+void LogMessage::setOverloadPolicy(const OverloadPolicy &policy) {
+    overloadPolicy = policy;
+}
+
+void LogMessage::reopen() {
+    if (logBuffer) {
+        logBuffer->reopen();
+    }
+}
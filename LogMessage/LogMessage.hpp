@@ -13,23 +13,17 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <thread>
+#include "LogLevel.hpp"
 #include "AsyncLogBuffer.hpp"
 
-#define NORMAL 0
-#define INFO 1
-#define WARNING 2
-#define ERROR 3
-#define FATAL 4
-#define DEBUG 5
-
-#define LOG_LEVEL int
-
 std::string to_log(LOG_LEVEL level);
 
 class LogMessage {
 private:
     static std::string default_log_path;
     static std::unique_ptr<AsyncLogBuffer> logBuffer;
+    static LogSyncOptions syncOptions;
+    static OverloadPolicy overloadPolicy;
     static std::once_flag initFlag;
     
     static void initializeBuffer();
@@ -38,6 +32,9 @@ public:
     static void logMessage(LOG_LEVEL level, const char *message, ...);
     static void setDefaultLogPath(const std::string &path);
     static void flush(); // 手动刷新日志
+    static void setSyncOptions(const LogSyncOptions &options); // 需在首次写日志前设置
+    static void setOverloadPolicy(const OverloadPolicy &policy); // 需在首次写日志前设置
+    static void reopen(); // 日志文件被外部轮转后重新打开
 };
 
 #endif // __LOG_MESSAGE_HPP__
\ No newline at end of file
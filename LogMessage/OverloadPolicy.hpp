@@ -0,0 +1,142 @@
+#ifndef __OVERLOAD_POLICY_HPP__
+#define __OVERLOAD_POLICY_HPP__
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <cstdint>
+#include "LogLevel.hpp"
+
+// 队列过载时对某一等级日志的处理方式
+enum class OverloadAction {
+    BLOCK,      // 等待下游腾出空间, 不丢日志
+    DROP,       // 超过高水位后直接丢弃
+    SAMPLE      // 超过高水位后每 sampleRate 条只保留 1 条
+};
+
+// 单个阶段(Logger 队列、AsyncLogBuffer 字节块、AsyncDBWriter 任务队列)的过载策略
+// 低于高水位时所有等级都正常接收; 超过高水位后 DROP/SAMPLE 等级先被削减,
+// BLOCK 等级一直接收, 直到容量用尽才阻塞, 因此 DEBUG/INFO 会先于 WARNING 以上被丢弃
+struct OverloadPolicy {
+    size_t          capacity = 0;                   // 阶段容量, 单位由各阶段决定, 0 表示使用阶段默认值
+    double          highWatermark = 0.8;            // 占用达到 capacity * highWatermark 时开始削减
+    uint32_t        sampleRate = 10;                // SAMPLE 时每多少条保留 1 条
+    std::chrono::seconds summaryInterval{10};       // 丢弃汇总行的最短输出间隔
+    OverloadAction  actions[LOG_LEVEL_COUNT] = {
+        OverloadAction::SAMPLE,     // NORMAL
+        OverloadAction::SAMPLE,     // INFO
+        OverloadAction::BLOCK,      // WARNING
+        OverloadAction::BLOCK,      // ERROR
+        OverloadAction::BLOCK,      // FATAL
+        OverloadAction::DROP        // DEBUG
+    };
+};
+
+// 按策略判定每条日志是否接收, 并统计各等级被丢弃的条数
+class OverloadController {
+private:
+    OverloadPolicy                  m_policy;
+    size_t                          m_highWatermark;
+    std::atomic<uint64_t>           m_sampleCounter{0};
+    std::atomic<uint64_t>           m_dropped[LOG_LEVEL_COUNT] = {};        // 累计丢弃
+    std::atomic<uint64_t>           m_pendingDropped[LOG_LEVEL_COUNT] = {}; // 上次汇总后丢弃
+    std::mutex                      m_summaryMutex;
+    std::chrono::steady_clock::time_point m_lastSummary;
+
+    static size_t levelIndex(LOG_LEVEL level) {
+        return (level >= 0 && level < LOG_LEVEL_COUNT) ? static_cast<size_t>(level) : static_cast<size_t>(INFO);
+    }
+
+public:
+    OverloadController(const OverloadPolicy& policy, size_t defaultCapacity)
+        : m_policy(policy)
+        , m_lastSummary(std::chrono::steady_clock::now())
+    {
+        if (m_policy.capacity == 0) {
+            m_policy.capacity = defaultCapacity;
+        }
+        if (m_policy.sampleRate == 0) {
+            m_policy.sampleRate = 1;
+        }
+        m_highWatermark = static_cast<size_t>(m_policy.capacity * m_policy.highWatermark);
+    }
+
+    size_t capacity() const {
+        return m_policy.capacity;
+    }
+
+    OverloadAction actionFor(LOG_LEVEL level) const {
+        return m_policy.actions[levelIndex(level)];
+    }
+
+    // depth 为阶段当前占用; 返回 false 表示该条日志应被丢弃(已计数)
+    // 返回 true 时, 若阶段已满, 调用方按 BLOCK 语义等待
+    bool admit(LOG_LEVEL level, size_t depth) {
+        OverloadAction action = actionFor(level);
+        if (action == OverloadAction::BLOCK || depth < m_highWatermark) {
+            return true;
+        }
+        if (action == OverloadAction::SAMPLE && depth < m_policy.capacity &&
+            m_sampleCounter.fetch_add(1, std::memory_order_relaxed) % m_policy.sampleRate == 0) {
+            return true;
+        }
+        recordDrop(level);
+        return false;
+    }
+
+    void recordDrop(LOG_LEVEL level) {
+        size_t index = levelIndex(level);
+        m_dropped[index].fetch_add(1, std::memory_order_relaxed);
+        m_pendingDropped[index].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t dropped(LOG_LEVEL level) const {
+        return m_dropped[levelIndex(level)].load(std::memory_order_relaxed);
+    }
+
+    uint64_t totalDropped() const {
+        uint64_t total = 0;
+        for (const auto& count : m_dropped) {
+            total += count.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    // 距上次汇总超过 summaryInterval 且期间有丢弃时生成一行汇总, 例如:
+    // [OVERLOAD] Logger: dropped 120 lines in last 10s (INFO=100 DEBUG=20), total 560
+    bool takeSummary(const char* stage, std::string& line) {
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(m_summaryMutex);
+        if (now - m_lastSummary < m_policy.summaryInterval) {
+            return false;
+        }
+
+        static const char* const names[LOG_LEVEL_COUNT] = {"NORMAL", "INFO", "WARNING", "ERROR", "FATAL", "DEBUG"};
+        uint64_t interval = 0;
+        std::string detail;
+        for (size_t i = 0; i < LOG_LEVEL_COUNT; ++i) {
+            uint64_t count = m_pendingDropped[i].exchange(0, std::memory_order_relaxed);
+            if (count > 0) {
+                interval += count;
+                if (!detail.empty()) {
+                    detail.push_back(' ');
+                }
+                detail.append(names[i]).append("=").append(std::to_string(count));
+            }
+        }
+        if (interval == 0) {
+            m_lastSummary = now;
+            return false;
+        }
+
+        auto seconds = std::chrono::duration_cast<std::chrono::seconds>(now - m_lastSummary).count();
+        m_lastSummary = now;
+        line = "[OVERLOAD] " + std::string(stage) + ": dropped " + std::to_string(interval) +
+               " lines in last " + std::to_string(seconds) + "s (" + detail + "), total " +
+               std::to_string(totalDropped());
+        return true;
+    }
+};
+
+#endif // __OVERLOAD_POLICY_HPP__
@@ -11,6 +11,8 @@
 #include <chrono>
 #include <atomic>
 #include <vector>
+#include <memory>
+#include <cstdint>
 #include <exception>
 #include <condition_variable>
 
@@ -22,45 +24,221 @@ std::string to_string(T value) {
     return os.str();
 }
 
-class LogQueue{
-private:
-    std::queue<std::string> m_queue;
-    std::mutex m_mutex;
-    std::condition_variable m_cv;
-    bool m_bStop = false;
+// дС, ڸ/Ƶ޸ĵԭӱ, α
+static const size_t CACHE_LINE_SIZE = 64;
+
+// ʱĴ
+enum class QueueFullPolicy {
+    BLOCK,          // ֱпλ
+    DROP_NEWEST,    // ǰҪд־
+    DROP_OLDEST     // ͷɵ־, Ϊ־ڳλ
+};
 
+// нζ (/)
+// ÿλ(sequence)ʵ, ֻ֮һ CAS,
+// ٳȫֻ, Ҳÿ־ϵ notify_one
+// Ӷͬʹ CAS,  DROP_OLDEST ߿԰ȫ߶ͷ
+// Ԫ T ĬϹƶ, ı־ʹ LogQueue ( BasicLogQueue<std::string>)
+template <typename T>
+class BasicLogQueue{
 public:
-    void push(const std::string& msg){
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_queue.push(msg);
-        m_cv.notify_one();
+    static const size_t DEFAULT_CAPACITY = 1 << 16;
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Cell {
+        std::atomic<size_t> sequence;
+        T                   data;
+    };
+
+    std::unique_ptr<Cell[]>                             m_buffer;
+    size_t                                              m_mask;
+    QueueFullPolicy                                     m_policy;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t>        m_enqueuePos{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t>        m_dequeuePos{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t>        m_dropped{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<bool>          m_consumerWaiting{false};
+    std::atomic<bool>                                   m_bStop{false};
+
+    // Ҫʱʹ, ߿·ᴥ
+    std::mutex                                          m_mutex;
+    std::condition_variable                             m_cv;
+
+    static size_t roundUpPowerOfTwo(size_t n){
+        size_t capacity = 2;
+        while(capacity < n){
+            capacity <<= 1;
+        }
+        return capacity;
     }
 
-    bool pop(std::string& outmsg){
-        std::unique_lock<std::mutex> lock(m_mutex);
-        m_cv.wait(lock, [this](){
-            return !m_queue.empty() || m_bStop;
-        });
+    template <typename U>
+    bool try_push(U&& msg){
+        Cell* cell = nullptr;
+        size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        for(;;){
+            cell = &m_buffer[pos & m_mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if(diff == 0){
+                if(m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+                    break;
+                }
+            }
+            else if(diff < 0){
+                return false;   // 
+            }
+            else{
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->data = std::forward<U>(msg);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
 
-        if(m_bStop && m_queue.empty()){
-            return false;
+    // Ѿʱż
+    void wakeConsumer(){
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(m_consumerWaiting.load(std::memory_order_relaxed)){
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_cv.notify_one();
         }
+    }
 
-        // while(!m_queue.empty() && m_bStop){
-        //     std::cout << m_queue.front() << std::endl;
-        //     m_queue.pop();
-        // }
+    template <typename U>
+    bool push_impl(U&& msg){
+        int spins = 0;
+        while(!try_push(std::forward<U>(msg))){
+            if(m_policy == QueueFullPolicy::DROP_NEWEST){
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            if(m_policy == QueueFullPolicy::DROP_OLDEST){
+                T discard;
+                if(try_pop(discard)){
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                }
+                continue;
+            }
 
-        outmsg = m_queue.front();
-        m_queue.pop();
+            // BLOCK: óCPU, ʱٶ, ȴڳλ
+            if(m_bStop.load(std::memory_order_relaxed)){
+                return false;
+            }
+            if(++spins < 64){
+                std::this_thread::yield();
+            }
+            else{
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+        wakeConsumer();
         return true;
     }
 
+public:
+    explicit BasicLogQueue(size_t capacity = DEFAULT_CAPACITY, QueueFullPolicy policy = QueueFullPolicy::BLOCK)
+        : m_buffer(new Cell[roundUpPowerOfTwo(capacity)])
+        , m_mask(roundUpPowerOfTwo(capacity) - 1)
+        , m_policy(policy)
+    {
+        for(size_t i = 0; i <= m_mask; ++i){
+            m_buffer[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BasicLogQueue(const BasicLogQueue&) = delete;
+    BasicLogQueue& operator=(const BasicLogQueue&) = delete;
+
+    //  false ʾ־(ֹͣ)
+    bool push(const T& msg){
+        return push_impl(msg);
+    }
+
+    bool push(T&& msg){
+        return push_impl(std::move(msg));
+    }
+
+    // , Ϊʱ false
+    bool try_pop(T& outmsg){
+        Cell* cell = nullptr;
+        size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        for(;;){
+            cell = &m_buffer[pos & m_mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if(diff == 0){
+                if(m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+                    break;
+                }
+            }
+            else if(diff < 0){
+                return false;   // Ϊ
+            }
+            else{
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        outmsg = std::move(cell->data);
+        cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    // , ֹͣΪʱ false
+    bool pop(T& outmsg){
+        for(;;){
+            if(try_pop(outmsg)){
+                return true;
+            }
+            if(m_bStop.load(std::memory_order_acquire)){
+                // ֹͣټһ, ȷ© stop ֮ǰӵ־
+                return try_pop(outmsg);
+            }
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_consumerWaiting.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if(try_pop(outmsg)){
+                m_consumerWaiting.store(false, std::memory_order_relaxed);
+                return true;
+            }
+            if(!m_bStop.load(std::memory_order_acquire)){
+                // ʱֻǶ, ߻
+                m_cv.wait_for(lock, std::chrono::milliseconds(100));
+            }
+            m_consumerWaiting.store(false, std::memory_order_relaxed);
+        }
+    }
+
     void stop(){
+        m_bStop.store(true, std::memory_order_release);
         std::lock_guard<std::mutex> lock(m_mutex);
-        m_bStop = true;
         m_cv.notify_all();
     }
+
+    size_t dropped() const {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+    size_t capacity() const {
+        return m_mask + 1;
+    }
+
+    // ǰеĴԪظ, дʱֻΪжϵĲο
+    size_t size() const {
+        size_t enqueue = m_enqueuePos.load(std::memory_order_relaxed);
+        size_t dequeue = m_dequeuePos.load(std::memory_order_relaxed);
+        return enqueue > dequeue ? enqueue - dequeue : 0;
+    }
+
+    QueueFullPolicy policy() const {
+        return m_policy;
+    }
 };
 
-#endif // __LOGQUEUE_HPP__
\ No newline at end of file
+using LogQueue = BasicLogQueue<std::string>;
+
+#endif // __LOGQUEUE_HPP__
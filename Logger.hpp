@@ -3,15 +3,40 @@
 
 #include "LogQueue.hpp"
 #include "ThreadPool.hpp"
+#include "FormatSpec.hpp"
+#include "DeferredLog.hpp"
+#include "LogCompression.hpp"
 #include "LogMessage/LogMessage.hpp"
+#include "LogMessage/OverloadPolicy.hpp"
 #include <filesystem>
 #include <fstream>
 #include <chrono>
+#include <atomic>
+#include <algorithm>
+#include <sys/resource.h>
+#include <sys/syscall.h>
 
 namespace fs = std::filesystem;
 
 const int THREADS_SIZE = 10;
+const size_t WRITER_BATCH_SIZE = 256;    // 专用写线程每批最多取出的日志条数
 using INFO_LEVEL = int;
+
+// 日志消费方式
+enum class LoggerMode {
+    THREAD_POOL,        // 每条日志向线程池提交一次 process 任务
+    DEDICATED_WRITER,   // 单个常驻写线程批量取出队列并写入文件
+    DEFERRED_WRITER     // 生产者只入队二进制参数, 由写线程完成格式化
+};
+// 自动轮转策略, 各项为 0 表示不启用
+// 轮转时当前文件改名为 <名称>_YYYYMMDD_HHMMSS<扩展名>, 原文件名换成预先打开好的新文件
+struct RotationPolicy {
+    std::uintmax_t          maxBytes = 0;       // 当前文件达到该大小后轮转
+    std::chrono::seconds    interval{0};        // 当前文件打开超过该时长后轮转
+    size_t                  maxFiles = 0;       // 最多保留的历史文件数, 多余的由后台任务删除
+    bool                    compress = false;   // 历史文件由后台低优先级线程压缩为 .gz
+};
+
 // enum LogLevel{
 //     INFO,
 //     DEBUG,
@@ -28,13 +53,36 @@ private:
     LogQueue                        m_queue;
     bool                            m_isHtml;
     fs::path                        m_logPath;
+    LoggerMode                      m_mode;
     std::unique_ptr<ThreadPool>     m_threads;
+    std::thread                     m_writer;
+    // DEFERRED_WRITER 模式下使用的二进制记录队列
+    std::unique_ptr<BasicLogQueue<DeferredLog::Record>> m_deferredQueue;
+    // 按等级的过载策略, 未设置时只按 QueueFullPolicy 处理
+    std::unique_ptr<OverloadController> m_overload;
+
+    // 自动轮转: 以下成员除字节计数外都在持有 m_mutex 的写线程上访问
+    RotationPolicy                  m_rotation;
+    std::atomic<std::uintmax_t>     m_bytesWritten{0};  // 当前文件大小的运行计数
+    std::chrono::system_clock::time_point m_fileOpenedAt;
+    std::unique_ptr<ThreadPool>     m_maintenance;      // 预打开新文件、清理历史文件的后台线程
+    // 预先打开的下一个文件, 由后台线程准备, 轮转时写线程直接切换
+    std::mutex                      m_nextMutex;
+    std::ofstream                   m_nextFile;
+    fs::path                        m_nextPath;
+    std::uintmax_t                  m_nextBytes = 0;
+    bool                            m_nextReady = false;
 
 
 public:
-    Logger(const std::string& filename, bool isHtml = false)
-        : m_isHtml(isHtml)
+    Logger(const std::string& filename, bool isHtml = false,
+           LoggerMode mode = LoggerMode::THREAD_POOL,
+           QueueFullPolicy policy = QueueFullPolicy::BLOCK,
+           size_t queueCapacity = LogQueue::DEFAULT_CAPACITY)
+        : m_queue(queueCapacity, policy)
+        , m_isHtml(isHtml)
         , m_logPath(filename)
+        , m_mode(mode)
         , m_threads(new ThreadPool(THREADS_SIZE))
     {
         // 确保日志文件所在目录存在
@@ -52,7 +100,7 @@ public:
         }
 
         if(isHtml && !fileExists){
-            _init_html_header();
+            _init_html_header(m_file);
         }
         
         // 记录日志系统启动信息
@@ -63,6 +111,18 @@ public:
         
         m_file << "[SYSTEM] Logger started at " << time_buffer 
                << " (File: " << fs::absolute(m_logPath).string() << ")" << std::endl;
+        // 之后只累加写入的字节数, 不再查询文件系统
+        m_bytesWritten = fs::file_size(m_logPath);
+        m_fileOpenedAt = now;
+
+        // 专用写线程模式: 只有这一个消费者与生产者竞争队列
+        if(m_mode == LoggerMode::DEDICATED_WRITER){
+            m_writer = std::thread(&Logger::writerLoop, this);
+        }
+        else if(m_mode == LoggerMode::DEFERRED_WRITER){
+            m_deferredQueue.reset(new BasicLogQueue<DeferredLog::Record>(queueCapacity, policy));
+            m_writer = std::thread(&Logger::deferredWriterLoop, this);
+        }
     }
 
     // void init_for_html() {
@@ -75,6 +135,17 @@ public:
 
     ~Logger(){
         m_queue.stop();
+        if(m_deferredQueue){
+            m_deferredQueue->stop();
+        }
+        // 线程池模式下先等工作线程写完队列中剩余的日志; 它们可能触发轮转, 会用到 m_maintenance 和 m_file
+        m_threads.reset();
+        if(m_writer.joinable()){
+            m_writer.join();
+        }
+        // 等待后台清理任务结束, 再丢弃未使用的预打开文件
+        m_maintenance.reset();
+        discardNextFile();
         if(m_file.is_open()){
             // 记录日志系统关闭信息
             auto now = std::chrono::system_clock::now();
@@ -83,7 +154,7 @@ public:
             std::strftime(time_buffer, sizeof(time_buffer), "%Y-%m-%d %H:%M:%S", std::localtime(&now_time));
             
             m_file << "[SYSTEM] Logger stopped at " << time_buffer 
-                   << " (File size: " << fs::file_size(m_logPath) << " bytes)" << std::endl;
+                   << " (File size: " << getLogFileSize() << " bytes)" << std::endl;
                    
             m_file.flush();
             m_file.close();
@@ -128,40 +199,129 @@ public:
             return false;
         }
         
-        // 更新文件路径
+        // 更新文件路径, 旧文件按策略交给后台压缩
+        fs::path oldPath = m_logPath;
         m_logPath = newPath;
+        if(m_rotation.compress && m_maintenance && oldPath != newPath){
+            m_maintenance->submitTask([oldPath](){
+                compressArchive(oldPath);
+            });
+        }
+        std::error_code ec;
+        std::uintmax_t size = fs::file_size(m_logPath, ec);
+        m_bytesWritten = ec ? 0 : size;
+        m_fileOpenedAt = std::chrono::system_clock::now();
+
+        // 预打开的文件属于旧路径, 丢弃后按新路径重新准备
+        discardNextFile();
+        if(rotationEnabled()){
+            schedulePreopen();
+        }
         return true;
     }
 
-    // 获取当前日志文件大小
+    // 设置自动轮转策略, 轮转检查在写入日志的线程上进行
+    void setRotationPolicy(const RotationPolicy& policy) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_rotation = policy;
+        if(rotationEnabled()){
+            if(!m_maintenance){
+                m_maintenance.reset(new ThreadPool(1));
+                // 后台线程只做预打开、压缩和清理, 降低其调度优先级, 避免与写线程争抢 CPU
+                m_maintenance->submitTask([](){
+                    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10);
+                });
+            }
+            schedulePreopen();
+        }
+    }
+
+    // 按等级设置过载策略 (容量单位为队列条数), 需在开始写日志前调用
+    void setOverloadPolicy(const OverloadPolicy& policy) {
+        m_overload.reset(new OverloadController(policy, m_queue.capacity()));
+    }
+
+    // 因队列已满或过载策略而被丢弃的日志条数
+    size_t getDroppedCount() const {
+        return m_queue.dropped() + (m_deferredQueue ? m_deferredQueue->dropped() : 0) +
+               (m_overload ? m_overload->totalDropped() : 0);
+    }
+
+    uint64_t getDroppedCount(INFO_LEVEL level) const {
+        return m_overload ? m_overload->dropped(level) : 0;
+    }
+
+    // 获取当前日志文件大小 (写入字节的运行计数, 不访问文件系统)
     std::uintmax_t getLogFileSize() const {
-        try {
-            return fs::file_size(m_logPath);
-        } catch (const fs::filesystem_error&) {
-            return 0;
+        return m_bytesWritten.load(std::memory_order_relaxed);
+    }
+
+    LoggerMode getMode() const {
+        return m_mode;
+    }
+
+    // 专用写线程模式下线程池不再处理日志, 可用于其他后台任务
+    ThreadPool* getThreadPool() {
+        return m_threads.get();
+    }
+
+    template <typename ...Args>
+    void log_in_text(INFO_LEVEL level, const std::string& format, const Args& ...args){
+        if(!admit(level)){
+            return;
+        }
+        if(m_mode == LoggerMode::DEFERRED_WRITER){
+            pushPreformatted(level, false, std::string_view(format), args...);
+            return;
         }
+        m_queue.push(process_text(level, std::string_view(format), args...));
+        notifyConsumer();
     }
 
+    // 编译期格式串版本, 格式串需通过 LOG_FMT("...") 生成
     template <typename ...Args>
-    void log_in_text(INFO_LEVEL level, const std::string& format, Args ...args){
+    void log_in_text(INFO_LEVEL level, const FormatSpec& format, const Args& ...args){
+        if(!admit(level)){
+            return;
+        }
+        if(m_mode == LoggerMode::DEFERRED_WRITER){
+            pushDeferred(level, false, &format, args...);
+            return;
+        }
         m_queue.push(process_text(level, format, args...));
-        m_threads->submitTask([this](){
-            process();
-        });
+        notifyConsumer();
     }
 
     template<typename ...Args>
-    void log_in_html(INFO_LEVEL level, const std::string& format, Args ...args){
+    void log_in_html(INFO_LEVEL level, const std::string& format, const Args& ...args){
+        if(!admit(level)){
+            return;
+        }
+        if(m_mode == LoggerMode::DEFERRED_WRITER){
+            pushPreformatted(level, true, std::string_view(format), args...);
+            return;
+        }
+        m_queue.push(process_html(level, std::string_view(format), args...));
+        notifyConsumer();
+    }
+
+    template<typename ...Args>
+    void log_in_html(INFO_LEVEL level, const FormatSpec& format, const Args& ...args){
+        if(!admit(level)){
+            return;
+        }
+        if(m_mode == LoggerMode::DEFERRED_WRITER){
+            pushDeferred(level, true, &format, args...);
+            return;
+        }
         m_queue.push(process_html(level, format, args...));
-        m_threads->submitTask([this](){
-            process();
-        });
+        notifyConsumer();
     }
 
 private:
-    void _init_html_header()
+    static void _init_html_header(std::ostream& out)
     {
-        m_file << R"(<!DOCTYPE html>
+        out << R"(<!DOCTYPE html>
 <html lang="zh">
 <head>
 <meta charset="UTF-8">
@@ -194,7 +354,7 @@ private:
     }
 
 private:
-    std::string getLevelClass(INFO_LEVEL level) const {
+    const char* getLevelClass(INFO_LEVEL level) const {
         switch (level) {
             case INFO: return "info";
             case DEBUG: return "debug";
@@ -205,7 +365,7 @@ private:
         }
     }
 
-    std::string getLevelString(INFO_LEVEL level) const {
+    const char* getLevelString(INFO_LEVEL level) const {
         switch (level) {
             case INFO: return "INFO";
             case DEBUG: return "DEBUG";
@@ -220,92 +380,337 @@ private:
         std::string msg;
         std::lock_guard<std::mutex> lock(m_mutex);
         while(m_queue.pop(msg)){
-            m_file << msg << std::endl;
+            msg.push_back('\n');
+            writeToFile(msg);
         }
     }
 
-    template <typename ...Args>
-    std::string process_text(INFO_LEVEL level, const std::string& format, Args ...args){
-        std::vector<std::string> args_str = {to_string(args)...};
-        std::ostringstream os;
-        os.clear();
-
-        // 构建一个JSON格式
-        // {
-        //    "level": "INFO",
-        //    "message": "This is a log message"
-        // }
-        os << "{";
-        os << "\"level\": \"" << getLevelString(level) << "\", ";
-        os << "\"message\": \"";
-
-        // 处理message内容
-        int args_index = 0, last_position = 0;
-        int placeholder_index = format.find("{}");
-        while(placeholder_index != std::string::npos){
-            if(args_index >= args_str.size()){
-                break;
+    void notifyConsumer(){
+        if(m_mode == LoggerMode::THREAD_POOL){
+            m_threads->submitTask([this](){
+                process();
+            });
+        }
+        // DEDICATED_WRITER 模式下由队列自身唤醒写线程
+    }
+
+    // 专用写线程: 阻塞等待第一条日志, 再非阻塞地取出一批, 一次写入并刷新
+    void writerLoop(){
+        std::string msg;
+        std::string batch;
+        while(m_queue.pop(msg)){
+            batch.clear();
+            batch.append(msg).push_back('\n');
+            size_t count = 1;
+            while(count < WRITER_BATCH_SIZE && m_queue.try_pop(msg)){
+                batch.append(msg).push_back('\n');
+                ++count;
             }
-            os << format.substr(last_position, placeholder_index - last_position);
-            os << args_str[args_index++];
-            last_position = placeholder_index + 2;
-            placeholder_index = format.find("{}", last_position);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            writeToFile(batch);
+        }
+    }
+
+    // 过载策略判定, 队列占用在两种队列中取实际使用的那一个
+    bool admit(INFO_LEVEL level){
+        if(!m_overload){
+            return true;
         }
+        size_t depth = m_deferredQueue ? m_deferredQueue->size() : m_queue.size();
+        return m_overload->admit(level, depth);
+    }
 
-        if(!format.empty() && args_index >= args_str.size()){
-            os << format.substr(last_position);
+    // 写入一批数据并检查是否需要轮转, 调用方需持有 m_mutex
+    void writeToFile(const std::string& data){
+        m_file.write(data.data(), data.size());
+        m_bytesWritten.fetch_add(data.size(), std::memory_order_relaxed);
+        std::string summary;
+        if(m_overload && m_overload->takeSummary("Logger", summary)){
+            summary.push_back('\n');
+            m_file.write(summary.data(), summary.size());
+            m_bytesWritten.fetch_add(summary.size(), std::memory_order_relaxed);
         }
-        while(args_index < args_str.size()){
-            os << args_str[args_index++];
+        m_file.flush();
+        if(rotationEnabled()){
+            maybeRotate();
         }
-        os << "\"";
-        os << "}";
-        
-        return os.str();
     }
 
-    template<typename ...Args>
-    std::string process_html(INFO_LEVEL level, const std::string& format, Args ...args){
-        std::vector<std::string> args_str = {to_string(args)...};
-        std::ostringstream os;
-        os.clear();
-
-        // 获取日志级别字符串和对应的CSS类名
-        std::string levelStr = getLevelString(level);
-        std::string levelClass = getLevelClass(level);
-        
-        // 获取当前时间
-        // auto now = std::chrono::system_clock::now();
-        // std::time_t now_time = std::chrono::system_clock::to_time_t(now);
-        // char time_buffer[100];
-        // std::strftime(time_buffer, sizeof(time_buffer), "%a %b %d %H:%M:%S %Y", std::localtime(&now_time));
-        
-        // 创建与样例log.html相同格式的HTML
-        os << "<div class='log " << levelClass << "'>[" << levelStr << "] ";
-
-        // 处理消息内容
-        int args_index = 0, last_position = 0;
-        int placeholder_index = format.find("{}");
-        while(placeholder_index != std::string::npos){
-            if(args_index >= args_str.size()){
-                break;
+    bool rotationEnabled() const {
+        return m_rotation.maxBytes > 0 || m_rotation.interval.count() > 0 || m_rotation.maxFiles > 0;
+    }
+
+    static fs::path nextFilePath(const fs::path& logPath) {
+        return fs::path(logPath.string() + ".next");
+    }
+
+    // 历史文件名: <名称>_YYYYMMDD_HHMMSS<扩展名>, 同一秒内多次轮转时追加序号
+    fs::path makeArchivePath() const {
+        auto now = std::chrono::system_clock::now();
+        std::time_t now_time = std::chrono::system_clock::to_time_t(now);
+        char time_buffer[100];
+        std::strftime(time_buffer, sizeof(time_buffer), "%Y%m%d_%H%M%S", std::localtime(&now_time));
+
+        std::string prefix = m_logPath.stem().string() + "_" + time_buffer;
+        fs::path archived = m_logPath.parent_path() / (prefix + m_logPath.extension().string());
+        auto taken = [](const fs::path& path) {
+            return fs::exists(path) || fs::exists(path.string() + LogCompression::EXTENSION);
+        };
+        for(int seq = 1; taken(archived); ++seq){
+            archived = m_logPath.parent_path() / (prefix + "_" + std::to_string(seq) + m_logPath.extension().string());
+        }
+        return archived;
+    }
+
+    // 打开下一个文件并写入 HTML 头部, 返回已写入的字节数
+    std::uintmax_t openNextFile(std::ofstream& file, const fs::path& nextPath) const {
+        file.open(nextPath, std::ios::out | std::ios::trunc);
+        if(!file.is_open()){
+            return 0;
+        }
+        if(m_isHtml){
+            _init_html_header(file);
+            file.flush();
+            return static_cast<std::uintmax_t>(file.tellp());
+        }
+        return 0;
+    }
+
+    // 后台线程: 提前打开下一个文件, 轮转时写线程不必等待 open
+    void preopenNextFile(const fs::path& nextPath){
+        std::lock_guard<std::mutex> lock(m_nextMutex);
+        if(m_nextReady){
+            return;
+        }
+        m_nextBytes = openNextFile(m_nextFile, nextPath);
+        m_nextPath = nextPath;
+        m_nextReady = m_nextFile.is_open();
+    }
+
+    // 调用方需持有 m_mutex, 路径在提交时拷贝, 后台线程不读取可变成员
+    void schedulePreopen(){
+        fs::path nextPath = nextFilePath(m_logPath);
+        m_maintenance->submitTask([this, nextPath](){
+            preopenNextFile(nextPath);
+        });
+    }
+
+    void discardNextFile(){
+        std::lock_guard<std::mutex> lock(m_nextMutex);
+        if(m_nextFile.is_open()){
+            m_nextFile.close();
+            std::error_code ec;
+            fs::remove(m_nextPath, ec);
+        }
+        m_nextReady = false;
+    }
+
+    void maybeRotate(){
+        bool bySize = m_rotation.maxBytes > 0 && getLogFileSize() >= m_rotation.maxBytes;
+        bool byTime = m_rotation.interval.count() > 0 &&
+                      std::chrono::system_clock::now() - m_fileOpenedAt >= m_rotation.interval;
+        if(bySize || byTime){
+            rotateInPlace();
+        }
+    }
+
+    // 写线程上的轮转: 只做两次 rename 和一次文件流交换, 删除历史文件交给后台线程
+    void rotateInPlace(){
+        fs::path nextPath = nextFilePath(m_logPath);
+        std::ofstream next;
+        std::uintmax_t nextBytes = 0;
+        fs::path archived;
+        std::error_code ec;
+        {
+            // 持锁直到 .next 改名完成: 否则后台线程可能在同步打开之后、改名之前再打开同一个 .next,
+            // 改名后它预打开的其实是当前日志文件, 下一次轮转会把当前文件移走
+            std::lock_guard<std::mutex> lock(m_nextMutex);
+            if(m_nextReady && m_nextPath == nextPath){
+                next.swap(m_nextFile);
+                nextBytes = m_nextBytes;
+                m_nextReady = false;
+            }
+            if(!next.is_open()){
+                // 后台线程还没准备好时退化为同步打开
+                nextBytes = openNextFile(next, nextPath);
+            }
+            if(!next.is_open()){
+                std::cerr << "Logger: failed to open next log file " << nextPath << std::endl;
+                m_fileOpenedAt = std::chrono::system_clock::now();   // 推迟下一次尝试
+                return;
+            }
+
+            archived = makeArchivePath();
+            fs::rename(m_logPath, archived, ec);
+            if(!ec){
+                fs::rename(nextPath, m_logPath, ec);
             }
-            os << format.substr(last_position, placeholder_index - last_position);
-            os << args_str[args_index++];
-            last_position = placeholder_index + 2;
-            placeholder_index = format.find("{}", last_position);
         }
+        if(ec){
+            std::cerr << "Logger: rotation failed: " << ec.message() << std::endl;
+            m_fileOpenedAt = std::chrono::system_clock::now();
+            return;
+        }
+
+        m_file.swap(next);
+        next.close();
+        m_bytesWritten = nextBytes;
+        m_fileOpenedAt = std::chrono::system_clock::now();
+
+        size_t maxFiles = m_rotation.maxFiles;
+        bool compress = m_rotation.compress;
+        fs::path logPath = m_logPath;
+        m_maintenance->submitTask([this, logPath, nextPath, archived, maxFiles, compress](){
+            preopenNextFile(nextPath);
+            if(compress){
+                compressArchive(archived);
+            }
+            pruneArchives(logPath, maxFiles);
+        });
+    }
 
-        if(!format.empty() && args_index >= args_str.size()){
-            os << format.substr(last_position);
+    // 后台线程: 压缩历史文件, 成功后删除原文件
+    static void compressArchive(const fs::path& archived){
+        fs::path compressed = fs::path(archived.string() + LogCompression::EXTENSION);
+        if(LogCompression::compressFile(archived, compressed)){
+            std::error_code ec;
+            fs::remove(archived, ec);
         }
-        while(args_index < args_str.size()){
-            os << args_str[args_index++];
+        else{
+            std::cerr << "Logger: failed to compress " << archived << std::endl;
         }
+    }
 
-        os << "</div>";
+    // 后台线程: 按修改时间排序(相同时按文件名), 删除超出保留数量的最旧历史文件
+    static void pruneArchives(const fs::path& logPath, size_t maxFiles){
+        if(maxFiles == 0){
+            return;
+        }
+        std::string prefix = logPath.stem().string() + "_";
+        std::string extension = logPath.extension().string();
+        fs::path dir = logPath.parent_path().empty() ? fs::path(".") : logPath.parent_path();
+
+        std::vector<std::pair<fs::file_time_type, fs::path>> archives;
+        std::error_code ec;
+        for(const auto& entry : fs::directory_iterator(dir, ec)){
+            std::string name = entry.path().filename().string();
+            // 压缩后的历史文件为 <名称>_时间戳<扩展名>.gz
+            std::string plain = name;
+            if(LogCompression::isCompressed(entry.path())){
+                plain = entry.path().stem().string();
+            }
+            if(plain.size() > prefix.size() + extension.size() &&
+               plain.compare(0, prefix.size(), prefix) == 0 &&
+               plain.compare(plain.size() - extension.size(), extension.size(), extension) == 0){
+                archives.emplace_back(entry.last_write_time(ec), entry.path());
+            }
+        }
+        if(archives.size() <= maxFiles){
+            return;
+        }
+        std::sort(archives.begin(), archives.end());
+        for(size_t i = 0; i + maxFiles < archives.size(); ++i){
+            fs::remove(archives[i].second, ec);
+            if(LogCompression::isCompressed(archives[i].second)){
+                fs::remove(LogCompression::indexPathFor(archives[i].second), ec);
+            }
+        }
+    }
+
+    // 延迟格式化: 只记录级别、格式串描述符、时间戳和参数的二进制拷贝
+    template <typename ...Args>
+    void pushDeferred(INFO_LEVEL level, bool isHtml, const FormatSpec* spec, const Args& ...args){
+        DeferredLog::Record record;
+        record.spec = spec;
+        record.level = level;
+        record.isHtml = isHtml ? 1 : 0;
+        record.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        DeferredLog::encodeArgs(record, args...);
+        m_deferredQueue->push(std::move(record));
+    }
+
+    // 运行期格式串的描述符没有静态存储期, 只能在生产者侧格式化消息正文,
+    // 外层的 JSON/HTML 包装仍由写线程完成
+    template <typename ...Args>
+    void pushPreformatted(INFO_LEVEL level, bool isHtml, std::string_view format, const Args& ...args){
+        std::string& buffer = formatBuffer();
+        FormatDetail::formatTo(buffer, format, args...);
+        pushDeferred(level, isHtml, nullptr, std::string_view(buffer));
+    }
+
+    // 在写线程上把一条延迟记录渲染为与 process_text/process_html 相同的输出
+    void renderRecord(std::string& out, const DeferredLog::Record& record) const {
+        if(record.isHtml){
+            appendHtmlPrefix(out, record.level);
+            DeferredLog::renderMessage(out, record);
+            out.append("</div>");
+        }
+        else{
+            appendTextPrefix(out, record.level);
+            DeferredLog::renderMessage(out, record);
+            out.append("\"}");
+        }
+        out.push_back('\n');
+    }
+
+    void deferredWriterLoop(){
+        DeferredLog::Record record;
+        std::string batch;
+        while(m_deferredQueue->pop(record)){
+            batch.clear();
+            renderRecord(batch, record);
+            size_t count = 1;
+            while(count < WRITER_BATCH_SIZE && m_deferredQueue->try_pop(record)){
+                renderRecord(batch, record);
+                ++count;
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            writeToFile(batch);
+        }
+    }
+
+    // 每个生产者线程复用同一块格式化缓冲区, 避免每条日志都重新分配
+    static std::string& formatBuffer(){
+        thread_local std::string buffer;
+        buffer.clear();
+        return buffer;
+    }
+
+    // 构建一个JSON格式
+    // {
+    //    "level": "INFO",
+    //    "message": "This is a log message"
+    // }
+    // Format 为 FormatSpec (编译期拆分) 或 std::string_view (运行期格式串)
+    void appendTextPrefix(std::string& buffer, INFO_LEVEL level) const {
+        buffer.append("{\"level\": \"").append(getLevelString(level)).append("\", \"message\": \"");
+    }
+
+    template <typename Format, typename ...Args>
+    std::string process_text(INFO_LEVEL level, const Format& format, const Args& ...args){
+        std::string& buffer = formatBuffer();
+        appendTextPrefix(buffer, level);
+        FormatDetail::formatTo(buffer, format, args...);
+        buffer.append("\"}");
+        return buffer;
+    }
+
+    // 创建与样例log.html相同格式的HTML
+    void appendHtmlPrefix(std::string& buffer, INFO_LEVEL level) const {
+        buffer.append("<div class='log ").append(getLevelClass(level)).append("'>[")
+              .append(getLevelString(level)).append("] ");
+    }
 
-        return os.str();
+    template <typename Format, typename ...Args>
+    std::string process_html(INFO_LEVEL level, const Format& format, const Args& ...args){
+        std::string& buffer = formatBuffer();
+        appendHtmlPrefix(buffer, level);
+        FormatDetail::formatTo(buffer, format, args...);
+        buffer.append("</div>");
+        return buffer;
     }
 };
 
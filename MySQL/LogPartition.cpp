@@ -0,0 +1,155 @@
+#include "LogPartition.hpp"
+#include "SqlConnPool.hpp"
+#include "LogStats.hpp"
+#include "../Util/EnvConfig.hpp"
+
+// 由 SqlConnPool::destroyPool 停止, 单例故意不析构, 避免与连接池单例的析构顺序问题
+LogPartitionManager& LogPartitionManager::getInstance() {
+    static LogPartitionManager* instance = new LogPartitionManager();
+    return *instance;
+}
+
+LogPartitionManager::LogPartitionManager() {
+    std::string unit = EnvConfig::getDBPartitionUnit();
+    if (unit == "hour") {
+        _options.unit = PartitionUnit::HOUR;
+    } else if (unit == "none") {
+        _options.unit = PartitionUnit::NONE;
+    } else {
+        _options.unit = PartitionUnit::DAY;
+    }
+    _options.retention = EnvConfig::getDBPartitionRetention();
+}
+
+void LogPartitionManager::setOptions(const PartitionOptions& options) {
+    std::lock_guard<std::mutex> locker(_mutex);
+    _options = options;
+}
+
+PartitionOptions LogPartitionManager::getOptions() {
+    std::lock_guard<std::mutex> locker(_mutex);
+    return _options;
+}
+
+bool LogPartitionManager::createTable(MYSQL* conn) {
+    std::string sql = LogPartition::createTableSql(getOptions(), time(nullptr));
+    if (mysql_query(conn, sql.c_str()) != 0) {
+        LogMessage::logMessage(ERROR, "Failed to create table: %s", mysql_error(conn));
+        return false;
+    }
+    return true;
+}
+
+void LogPartitionManager::start() {
+    std::lock_guard<std::mutex> locker(_mutex);
+    if (_running || _options.unit == PartitionUnit::NONE) {
+        return;
+    }
+    _running = true;
+    _thread = std::thread(&LogPartitionManager::maintainThread, this);
+}
+
+void LogPartitionManager::stop() {
+    {
+        std::lock_guard<std::mutex> locker(_mutex);
+        _running = false;
+        _cond.notify_all();
+    }
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+// 分区按边界升序返回, MAXVALUE 分区的 lessThan 记为 0; 未分区的表返回空
+bool LogPartitionManager::loadPartitions(MYSQL* conn, std::vector<PartitionInfo>& partitions) {
+    static const char* query =
+        "SELECT PARTITION_NAME, PARTITION_DESCRIPTION FROM information_schema.PARTITIONS "
+        "WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'log_table' AND PARTITION_NAME IS NOT NULL "
+        "ORDER BY PARTITION_ORDINAL_POSITION";
+    if (mysql_query(conn, query) != 0) {
+        LogMessage::logMessage(ERROR, "LogPartition: 查询分区失败: %s", mysql_error(conn));
+        return false;
+    }
+    MYSQL_RES* result = mysql_store_result(conn);
+    if (!result) {
+        LogMessage::logMessage(ERROR, "LogPartition: 读取分区失败: %s", mysql_error(conn));
+        return false;
+    }
+
+    partitions.clear();
+    MYSQL_ROW row;
+    while ((row = mysql_fetch_row(result)) != nullptr) {
+        PartitionInfo partition;
+        partition.name = row[0] ? row[0] : "";
+        std::string description = row[1] ? row[1] : "";
+        partition.lessThan = description == "MAXVALUE" ? 0 : std::atoll(description.c_str());
+        partitions.push_back(partition);
+    }
+    mysql_free_result(result);
+    return true;
+}
+
+bool LogPartitionManager::maintain(MYSQL* conn) {
+    PartitionOptions options = getOptions();
+    if (options.unit == PartitionUnit::NONE) {
+        return true;
+    }
+
+    std::vector<PartitionInfo> partitions;
+    if (!loadPartitions(conn, partitions)) {
+        return false;
+    }
+    if (partitions.empty()) {
+        // 旧版本建的未分区表, 迁移需要重写整张表, 交由运维处理
+        std::lock_guard<std::mutex> locker(_mutex);
+        if (!_warnedUnpartitioned) {
+            _warnedUnpartitioned = true;
+            LogMessage::logMessage(WARNING, "LogPartition: log_table 未分区, 跳过分区维护");
+        }
+        return true;
+    }
+
+    PartitionPlan plan = LogPartition::planPartitions(partitions, time(nullptr), options);
+    // 删除前按分区内的实际行数统计, 删除后从汇总累计值中扣除; 统计失败时本轮不删除
+    LogStats::Counts expired{};
+    if (!plan.drop.empty() && !LogStats::getInstance().countPartitions(conn, plan.drop, expired)) {
+        return false;
+    }
+    for (const auto& sql : LogPartition::alterStatements(plan)) {
+        if (mysql_query(conn, sql.c_str()) != 0) {
+            LogMessage::logMessage(ERROR, "LogPartition: %s 失败: %s", sql.c_str(), mysql_error(conn));
+            return false;
+        }
+    }
+    if (!plan.drop.empty()) {
+        int64_t droppedBefore = 0;
+        for (const auto& partition : partitions) {
+            if (std::find(plan.drop.begin(), plan.drop.end(), partition.name) != plan.drop.end()) {
+                droppedBefore = std::max(droppedBefore, partition.lessThan);
+            }
+        }
+        LogStats::getInstance().expireBefore(conn, droppedBefore, expired);
+    }
+    if (!plan.empty()) {
+        LogMessage::logMessage(INFO, "LogPartition: 新建 %zu 个分区, 删除 %zu 个过期分区",
+                               plan.add.size(), plan.drop.size());
+    }
+    return true;
+}
+
+// 启动后立即检查一次, 之后每 checkInterval 检查一次; 失败(如数据库暂时不可用)时下一轮重试
+void LogPartitionManager::maintainThread() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (_running) {
+        lock.unlock();
+        {
+            MYSQL* conn = nullptr;
+            SqlConnRAII connRAII(&conn, SqlConnPool::getInstance());
+            if (conn) {
+                maintain(conn);
+            }
+        }
+        lock.lock();
+        _cond.wait_for(lock, _options.checkInterval, [this] { return !_running; });
+    }
+}
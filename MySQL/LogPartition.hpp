@@ -0,0 +1,214 @@
+#ifndef __LOG_PARTITION_HPP__
+#define __LOG_PARTITION_HPP__
+
+#include <mysql/mysql.h>
+#include <ctime>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+
+// log_table 按 timestamp 分区的粒度; NONE 表示建普通表, 不做分区管理
+enum class PartitionUnit {
+    NONE,
+    DAY,
+    HOUR
+};
+
+// 分区管理参数, 默认值取自环境变量, 需在 SqlConnPool::init 之前设置
+struct PartitionOptions {
+    PartitionUnit               unit = PartitionUnit::DAY;
+    int                         retention = 30;     // 保留最近多少个分区单位的数据, <= 0 表示不删除
+    int                         precreate = 3;      // 提前建好当前之后多少个单位的分区
+    std::chrono::seconds        checkInterval{600}; // 检查分区的间隔
+};
+
+// 一个 RANGE 分区: 存放 UNIX_TIMESTAMP(timestamp) < lessThan 的行; lessThan 为 0 表示 MAXVALUE
+struct PartitionInfo {
+    std::string name;
+    int64_t     lessThan = 0;
+
+    bool isMax() const { return lessThan == 0; }
+};
+
+// 一次维护需要执行的变更
+struct PartitionPlan {
+    std::vector<PartitionInfo>  add;        // 按边界升序
+    std::vector<std::string>    drop;
+    bool                        hasMax = false; // 已有 MAXVALUE 分区时新分区从中拆分, 否则直接追加
+
+    bool empty() const { return add.empty() && drop.empty(); }
+};
+
+// 分区边界按 UTC 对齐, 与 MySQL 中 UNIX_TIMESTAMP(timestamp) 的取值一致, 不受会话时区影响
+namespace LogPartition {
+
+inline int64_t unitSeconds(PartitionUnit unit) {
+    return unit == PartitionUnit::HOUR ? 3600 : 86400;
+}
+
+inline int64_t alignDown(int64_t seconds, PartitionUnit unit) {
+    int64_t step = unitSeconds(unit);
+    return seconds - ((seconds % step) + step) % step;
+}
+
+// 分区以起始时间命名: 按天 p20250409, 按小时 p2025040915
+inline std::string partitionName(int64_t start, PartitionUnit unit) {
+    time_t t = static_cast<time_t>(start);
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    char name[32];
+    if (unit == PartitionUnit::HOUR) {
+        snprintf(name, sizeof(name), "p%04d%02d%02d%02d", tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour);
+    } else {
+        snprintf(name, sizeof(name), "p%04d%02d%02d", tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday);
+    }
+    return name;
+}
+
+// 根据现有分区(按边界升序)和当前时间计算要新建和删除的分区
+// 新建: 补齐到覆盖 [当前单位起点, 之后 precreate 个单位] 为止; 停机较久时中间的空档合并为一个分区,
+// 避免按小时分区时一次建出成千上万个分区
+// 删除: 边界不晚于 now - retention 个单位的分区, 即其中的数据都已过期; MAXVALUE 分区和最后一个普通分区始终保留
+inline PartitionPlan planPartitions(const std::vector<PartitionInfo>& existing, int64_t now, const PartitionOptions& options) {
+    PartitionPlan plan;
+    if (options.unit == PartitionUnit::NONE) {
+        return plan;
+    }
+
+    const int64_t step = unitSeconds(options.unit);
+    const int64_t current = alignDown(now, options.unit);
+    const int64_t target = current + (options.precreate + 1) * step;
+
+    int64_t last = 0;
+    size_t ranged = 0;
+    for (const auto& partition : existing) {
+        if (partition.isMax()) {
+            plan.hasMax = true;
+        } else {
+            last = std::max(last, partition.lessThan);
+            ++ranged;
+        }
+    }
+
+    if (ranged == 0) {
+        last = current;
+    } else if (last < current) {
+        // 空档 [last, current) 合并为一个分区
+        plan.add.push_back({partitionName(last, options.unit), current});
+        last = current;
+    }
+    for (int64_t start = last; start < target; start += step) {
+        plan.add.push_back({partitionName(start, options.unit), start + step});
+    }
+
+    if (options.retention > 0) {
+        const int64_t expireBefore = now - options.retention * step;
+        size_t remaining = ranged + plan.add.size();
+        for (const auto& partition : existing) {
+            if (!partition.isMax() && partition.lessThan <= expireBefore && remaining > 1) {
+                plan.drop.push_back(partition.name);
+                --remaining;
+            }
+        }
+    }
+    return plan;
+}
+
+// 新建 log_table 的语句; 分区表的主键和唯一索引必须包含分区列, 因此主键为 (id, timestamp)
+// 按级别查询走 (level, timestamp) 联合索引, 不带级别的按时间倒序查询走 idx_timestamp
+inline std::string createTableSql(const PartitionOptions& options, int64_t now) {
+    std::string sql = R"(
+        CREATE TABLE IF NOT EXISTS log_table (
+        id BIGINT UNSIGNED AUTO_INCREMENT,
+        level ENUM('TRACE', 'DEBUG', 'INFO', 'WARNING', 'ERROR', 'FATAL') NOT NULL,
+        ip VARCHAR(45) NOT NULL,
+        port SMALLINT UNSIGNED NOT NULL,
+        message TEXT,
+        timestamp TIMESTAMP NOT NULL DEFAULT CURRENT_TIMESTAMP,
+        PRIMARY KEY (id, timestamp),
+        INDEX idx_timestamp (timestamp),
+        INDEX idx_level_timestamp (level, timestamp)
+        ) ENGINE=InnoDB CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci COMMENT='系统日志表')";
+
+    if (options.unit != PartitionUnit::NONE) {
+        PartitionPlan plan = planPartitions({}, now, options);
+        sql += "\n        PARTITION BY RANGE (UNIX_TIMESTAMP(timestamp)) (";
+        for (const auto& partition : plan.add) {
+            sql += "PARTITION " + partition.name + " VALUES LESS THAN (" + std::to_string(partition.lessThan) + "), ";
+        }
+        sql += "PARTITION pmax VALUES LESS THAN MAXVALUE)";
+    }
+    return sql;
+}
+
+// 执行计划对应的 ALTER TABLE 语句, 新建在前、删除在后
+inline std::vector<std::string> alterStatements(const PartitionPlan& plan) {
+    std::vector<std::string> statements;
+    if (!plan.add.empty()) {
+        std::string partitions;
+        for (const auto& partition : plan.add) {
+            partitions += "PARTITION " + partition.name + " VALUES LESS THAN (" + std::to_string(partition.lessThan) + "), ";
+        }
+        if (plan.hasMax) {
+            // pmax 中通常没有数据, 拆分只改元数据
+            statements.push_back("ALTER TABLE log_table REORGANIZE PARTITION pmax INTO (" + partitions +
+                                 "PARTITION pmax VALUES LESS THAN MAXVALUE)");
+        } else {
+            partitions.resize(partitions.size() - 2);
+            statements.push_back("ALTER TABLE log_table ADD PARTITION (" + partitions + ")");
+        }
+    }
+    if (!plan.drop.empty()) {
+        std::string names;
+        for (const auto& name : plan.drop) {
+            names += (names.empty() ? "" : ", ") + name;
+        }
+        statements.push_back("ALTER TABLE log_table DROP PARTITION " + names);
+    }
+    return statements;
+}
+
+} // namespace LogPartition
+
+// log_table 分区维护 (单例)
+// SqlConnPool::init 建表后启动后台线程, 定期提前建好后续分区并整段删除过期分区,
+// 清理过期数据不再需要大范围 DELETE; 已存在的未分区旧表只记录警告, 不自动迁移
+class LogPartitionManager {
+public:
+    static LogPartitionManager& getInstance();
+
+    void setOptions(const PartitionOptions& options);
+    PartitionOptions getOptions();
+
+    // 在 conn 上建表 (不存在时)
+    bool createTable(MYSQL* conn);
+    void start();
+    void stop();
+
+    // 立即检查一次分区, 返回是否成功 (未分区的表视为成功)
+    bool maintain(MYSQL* conn);
+
+private:
+    LogPartitionManager();
+    ~LogPartitionManager() = default;
+    LogPartitionManager(const LogPartitionManager&) = delete;
+    LogPartitionManager& operator=(const LogPartitionManager&) = delete;
+
+    bool loadPartitions(MYSQL* conn, std::vector<PartitionInfo>& partitions);
+    void maintainThread();
+
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    PartitionOptions _options;
+    bool _running = false;
+    bool _warnedUnpartitioned = false;
+    std::thread _thread;
+};
+
+#endif // __LOG_PARTITION_HPP__
@@ -0,0 +1,329 @@
+#include "LogStats.hpp"
+#include "SqlConnPool.hpp"
+
+static const char* const LEVEL_NAMES[LogStats::LEVEL_COUNT] = {"TRACE", "DEBUG", "INFO", "WARNING", "ERROR", "FATAL"};
+
+// 由 SqlConnPool::destroyPool 停止, 单例故意不析构, 避免与连接池单例的析构顺序问题
+LogStats& LogStats::getInstance() {
+    static LogStats* instance = new LogStats();
+    return *instance;
+}
+
+int LogStats::levelIndex(const std::string& level) {
+    for (size_t i = 0; i < LEVEL_COUNT; ++i) {
+        if (level == LEVEL_NAMES[i]) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+const char* LogStats::levelName(size_t index) {
+    return index < LEVEL_COUNT ? LEVEL_NAMES[index] : "INFO";
+}
+
+std::string LogStats::buildMinuteInsert(const MinuteCounts& minutes) {
+    std::string sql;
+    for (const auto& entry : minutes) {
+        for (size_t level = 0; level < LEVEL_COUNT; ++level) {
+            if (entry.second[level] == 0) {
+                continue;
+            }
+            sql += sql.empty() ? "INSERT INTO log_stats (minute, level, count) VALUES " : ", ";
+            sql += "(FROM_UNIXTIME(" + std::to_string(entry.first) + "), '" + LEVEL_NAMES[level] + "', " +
+                   std::to_string(entry.second[level]) + ")";
+        }
+    }
+    if (!sql.empty()) {
+        sql += " ON DUPLICATE KEY UPDATE count = count + VALUES(count)";
+    }
+    return sql;
+}
+
+std::string LogStats::buildTotalInsert(const Counts& counts) {
+    std::string sql;
+    for (size_t level = 0; level < LEVEL_COUNT; ++level) {
+        if (counts[level] == 0) {
+            continue;
+        }
+        sql += sql.empty() ? "INSERT INTO log_stats_total (level, count) VALUES " : ", ";
+        sql += std::string("('") + LEVEL_NAMES[level] + "', " + std::to_string(counts[level]) + ")";
+    }
+    if (!sql.empty()) {
+        sql += " ON DUPLICATE KEY UPDATE count = count + VALUES(count)";
+    }
+    return sql;
+}
+
+// SELECT level, COUNT(*) FROM log_table PARTITION (p20250409, p20250410) GROUP BY level
+std::string LogStats::buildPartitionCount(const std::vector<std::string>& partitions) {
+    std::string sql = "SELECT level, COUNT(*) FROM log_table PARTITION (";
+    for (size_t i = 0; i < partitions.size(); ++i) {
+        sql += (i == 0 ? "" : ", ") + partitions[i];
+    }
+    sql += ") GROUP BY level";
+    return sql;
+}
+
+// 计数列为无符号数, 不足扣减时置 0
+std::string LogStats::buildTotalSubtract(const Counts& counts) {
+    std::string cases;
+    std::string levels;
+    for (size_t level = 0; level < LEVEL_COUNT; ++level) {
+        if (counts[level] == 0) {
+            continue;
+        }
+        std::string n = std::to_string(counts[level]);
+        cases += std::string(" WHEN '") + LEVEL_NAMES[level] + "' THEN IF(count > " + n + ", count - " + n + ", 0)";
+        levels += std::string(levels.empty() ? "'" : ", '") + LEVEL_NAMES[level] + "'";
+    }
+    if (cases.empty()) {
+        return "";
+    }
+    return "UPDATE log_stats_total SET count = CASE level" + cases + " ELSE count END WHERE level IN (" + levels + ")";
+}
+
+void LogStats::record(const Counts& counts, time_t now) {
+    int64_t minute = static_cast<int64_t>(now) - static_cast<int64_t>(now) % 60;
+    std::lock_guard<std::mutex> locker(_mutex);
+    Counts& bucket = _pending[minute];
+    for (size_t level = 0; level < LEVEL_COUNT; ++level) {
+        bucket[level] += counts[level];
+    }
+}
+
+void LogStats::record(int level, uint64_t count) {
+    if (level < 0 || level >= static_cast<int>(LEVEL_COUNT)) {
+        return;
+    }
+    Counts counts{};
+    counts[level] = count;
+    record(counts);
+}
+
+bool LogStats::totals(Counts& out) {
+    std::lock_guard<std::mutex> locker(_mutex);
+    if (!_loaded) {
+        return false;
+    }
+    out = _dbTotals;
+    for (size_t level = 0; level < LEVEL_COUNT; ++level) {
+        out[level] += _inFlight[level];
+    }
+    for (const auto& entry : _pending) {
+        for (size_t level = 0; level < LEVEL_COUNT; ++level) {
+            out[level] += entry.second[level];
+        }
+    }
+    return true;
+}
+
+void LogStats::setFlushInterval(std::chrono::milliseconds interval) {
+    std::lock_guard<std::mutex> locker(_mutex);
+    _flushInterval = interval;
+}
+
+bool LogStats::createTables(MYSQL* conn) {
+    static const char* minuteTable = R"(
+        CREATE TABLE IF NOT EXISTS log_stats (
+        minute TIMESTAMP NOT NULL,
+        level ENUM('TRACE', 'DEBUG', 'INFO', 'WARNING', 'ERROR', 'FATAL') NOT NULL,
+        count BIGINT UNSIGNED NOT NULL DEFAULT 0,
+        PRIMARY KEY (minute, level)
+        ) ENGINE=InnoDB COMMENT='日志按分钟、级别计数')";
+    static const char* totalTable = R"(
+        CREATE TABLE IF NOT EXISTS log_stats_total (
+        level ENUM('TRACE', 'DEBUG', 'INFO', 'WARNING', 'ERROR', 'FATAL') NOT NULL PRIMARY KEY,
+        count BIGINT UNSIGNED NOT NULL DEFAULT 0
+        ) ENGINE=InnoDB COMMENT='日志按级别累计计数')";
+    if (mysql_query(conn, minuteTable) != 0 || mysql_query(conn, totalTable) != 0) {
+        LogMessage::logMessage(ERROR, "LogStats: 创建汇总表失败: %s", mysql_error(conn));
+        return false;
+    }
+
+    if (mysql_query(conn, "SELECT COUNT(*) FROM log_stats_total") != 0) {
+        LogMessage::logMessage(ERROR, "LogStats: 查询汇总表失败: %s", mysql_error(conn));
+        return false;
+    }
+    MYSQL_RES* result = mysql_store_result(conn);
+    MYSQL_ROW row = result ? mysql_fetch_row(result) : nullptr;
+    bool empty = row && row[0] && std::atoll(row[0]) == 0;
+    if (result) {
+        mysql_free_result(result);
+    }
+    if (empty) {
+        // 只在首次启用时扫描一次 log_table; 多个进程同时初始化时 IGNORE 保证只写入一份
+        LogMessage::logMessage(INFO, "LogStats: 按 log_table 初始化累计计数");
+        if (mysql_query(conn, "INSERT IGNORE INTO log_stats_total (level, count) "
+                              "SELECT level, COUNT(*) FROM log_table GROUP BY level") != 0) {
+            LogMessage::logMessage(ERROR, "LogStats: 初始化累计计数失败: %s", mysql_error(conn));
+            return false;
+        }
+    }
+    return true;
+}
+
+bool LogStats::flush(MYSQL* conn) {
+    std::lock_guard<std::mutex> dbLocker(_dbMutex);
+    MinuteCounts minutes;
+    Counts added{};
+    {
+        // 取走的增量在提交或放回之前仍由 totals 计入
+        std::lock_guard<std::mutex> locker(_mutex);
+        minutes.swap(_pending);
+        for (const auto& entry : minutes) {
+            for (size_t level = 0; level < LEVEL_COUNT; ++level) {
+                added[level] += entry.second[level];
+            }
+        }
+        _inFlight = added;
+    }
+    if (minutes.empty()) {
+        return true;
+    }
+
+    std::string minuteSql = buildMinuteInsert(minutes);
+    std::string totalSql = buildTotalInsert(added);
+    bool ok = mysql_query(conn, "START TRANSACTION") == 0 &&
+              (minuteSql.empty() || mysql_query(conn, minuteSql.c_str()) == 0) &&
+              (totalSql.empty() || mysql_query(conn, totalSql.c_str()) == 0) &&
+              mysql_commit(conn) == 0;
+
+    if (!ok) {
+        LogMessage::logMessage(ERROR, "LogStats: 写入汇总表失败: %s", mysql_error(conn));
+        mysql_rollback(conn);
+    }
+    std::lock_guard<std::mutex> locker(_mutex);
+    _inFlight = Counts{};
+    if (!ok) {
+        // 增量放回, 下次一起写入
+        for (const auto& entry : minutes) {
+            Counts& bucket = _pending[entry.first];
+            for (size_t level = 0; level < LEVEL_COUNT; ++level) {
+                bucket[level] += entry.second[level];
+            }
+        }
+        return false;
+    }
+    for (size_t level = 0; level < LEVEL_COUNT; ++level) {
+        _dbTotals[level] += added[level];
+    }
+    return true;
+}
+
+bool LogStats::refresh(MYSQL* conn) {
+    std::lock_guard<std::mutex> dbLocker(_dbMutex);
+    if (mysql_query(conn, "SELECT level, count FROM log_stats_total") != 0) {
+        LogMessage::logMessage(ERROR, "LogStats: 读取累计计数失败: %s", mysql_error(conn));
+        return false;
+    }
+    MYSQL_RES* result = mysql_store_result(conn);
+    if (!result) {
+        LogMessage::logMessage(ERROR, "LogStats: 读取累计计数失败: %s", mysql_error(conn));
+        return false;
+    }
+
+    Counts counts{};
+    MYSQL_ROW row;
+    while ((row = mysql_fetch_row(result)) != nullptr) {
+        int level = row[0] ? levelIndex(row[0]) : -1;
+        if (level >= 0 && row[1]) {
+            counts[level] = std::strtoull(row[1], nullptr, 10);
+        }
+    }
+    mysql_free_result(result);
+    // 池内连接可能被其他代码关闭了自动提交, 结束隐式事务, 下次读取看到最新数据
+    mysql_commit(conn);
+
+    std::lock_guard<std::mutex> locker(_mutex);
+    _dbTotals = counts;
+    _loaded = true;
+    return true;
+}
+
+bool LogStats::countPartitions(MYSQL* conn, const std::vector<std::string>& partitions, Counts& out) {
+    out = Counts{};
+    if (partitions.empty()) {
+        return true;
+    }
+    std::string sql = buildPartitionCount(partitions);
+    if (mysql_query(conn, sql.c_str()) != 0) {
+        LogMessage::logMessage(ERROR, "LogStats: 统计过期分区行数失败: %s", mysql_error(conn));
+        return false;
+    }
+    MYSQL_RES* result = mysql_store_result(conn);
+    if (!result) {
+        LogMessage::logMessage(ERROR, "LogStats: 统计过期分区行数失败: %s", mysql_error(conn));
+        return false;
+    }
+    MYSQL_ROW row;
+    while ((row = mysql_fetch_row(result)) != nullptr) {
+        int level = row[0] ? levelIndex(row[0]) : -1;
+        if (level >= 0 && row[1]) {
+            out[level] = std::strtoull(row[1], nullptr, 10);
+        }
+    }
+    mysql_free_result(result);
+    return true;
+}
+
+bool LogStats::expireBefore(MYSQL* conn, int64_t seconds, const Counts& expired) {
+    std::string subtract = buildTotalSubtract(expired);
+    std::string remove = "DELETE FROM log_stats WHERE minute < FROM_UNIXTIME(" + std::to_string(seconds) + ")";
+
+    bool ok = mysql_query(conn, "START TRANSACTION") == 0 &&
+              (subtract.empty() || mysql_query(conn, subtract.c_str()) == 0) &&
+              mysql_query(conn, remove.c_str()) == 0 &&
+              mysql_commit(conn) == 0;
+    if (!ok) {
+        LogMessage::logMessage(ERROR, "LogStats: 清理过期计数失败: %s", mysql_error(conn));
+        mysql_rollback(conn);
+        return false;
+    }
+    return refresh(conn);
+}
+
+void LogStats::start() {
+    std::lock_guard<std::mutex> locker(_mutex);
+    if (_running) {
+        return;
+    }
+    _running = true;
+    _thread = std::thread(&LogStats::flushThread, this);
+}
+
+void LogStats::stop() {
+    {
+        std::lock_guard<std::mutex> locker(_mutex);
+        if (!_running) {
+            return;
+        }
+        _running = false;
+        _cond.notify_all();
+    }
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+// 启动后立即读取累计值, 之后每个间隔刷新增量并重新读取; 被 stop 唤醒后最后刷新一次再退出
+void LogStats::flushThread() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        bool last = !_running;
+        lock.unlock();
+        {
+            MYSQL* conn = nullptr;
+            SqlConnRAII connRAII(&conn, SqlConnPool::getInstance());
+            if (conn) {
+                flush(conn);
+                refresh(conn);
+            }
+        }
+        lock.lock();
+        if (last) {
+            break;
+        }
+        _cond.wait_for(lock, _flushInterval, [this] { return !_running; });
+    }
+}
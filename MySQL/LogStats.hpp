@@ -0,0 +1,87 @@
+#ifndef __LOG_STATS_HPP__
+#define __LOG_STATS_HPP__
+
+#include <mysql/mysql.h>
+#include <array>
+#include <map>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <ctime>
+#include <cstdint>
+
+// 按分钟、级别汇总的日志计数 (单例), 统计接口不再对 log_table 做 COUNT(*)
+// 写入 log_table 成功后调用 record 累加到内存, 后台线程定期把增量写入汇总表:
+//   log_stats        (minute, level) -> 该分钟写入的行数
+//   log_stats_total  level -> 累计行数, 由增量累加, 删除过期分区时按分区内的实际行数扣减
+// 统计请求由 totals 直接从内存返回: 最近一次读取的 log_stats_total 加上本进程尚未落库(含正在写入)的增量,
+// 其他进程写入的部分最多滞后一个刷新间隔
+// 分钟按写入时间统计, 回放历史日志时与 log_table.timestamp 不一致, 只影响 log_stats 的分钟分布;
+// 分区按 log_table.timestamp 删除, 累计值扣减的是被删分区的 COUNT(*), 不随回放的历史日志偏高
+class LogStats {
+public:
+    static constexpr size_t LEVEL_COUNT = 6;
+    using Counts = std::array<uint64_t, LEVEL_COUNT>;
+    using MinuteCounts = std::map<int64_t, Counts>;     // 分钟起点(秒) -> 各级别行数
+
+    static LogStats& getInstance();
+
+    // 与 log_table.level 的 ENUM 定义顺序一致, 未知级别返回 -1
+    static int levelIndex(const std::string& level);
+    static const char* levelName(size_t index);
+
+    // 批量增量写入两张汇总表的语句
+    static std::string buildMinuteInsert(const MinuteCounts& minutes);
+    static std::string buildTotalInsert(const Counts& counts);
+    // 按级别统计指定分区行数的查询, 以及从累计值中扣除的语句
+    static std::string buildPartitionCount(const std::vector<std::string>& partitions);
+    static std::string buildTotalSubtract(const Counts& counts);
+
+    // 记录已写入 log_table 的行, 只修改内存
+    void record(const Counts& counts, time_t now = time(nullptr));
+    void record(int level, uint64_t count = 1);
+
+    // 各级别累计行数; 尚未从数据库读取过累计值时返回 false, 调用方应退回直接查询
+    bool totals(Counts& out);
+
+    void setFlushInterval(std::chrono::milliseconds interval);
+
+    // 建汇总表; log_stats_total 为空(首次启用)时按 log_table 现有数据初始化一次
+    bool createTables(MYSQL* conn);
+    // 把内存中的增量在一个事务内写入汇总表, 失败时增量留到下次
+    bool flush(MYSQL* conn);
+    // 重新读取 log_stats_total
+    bool refresh(MYSQL* conn);
+    // 删除分区前调用, 按级别统计这些分区中的行数
+    bool countPartitions(MYSQL* conn, const std::vector<std::string>& partitions, Counts& out);
+    // log_table 中早于 seconds 的分区被删除后调用, 从累计值中扣除 expired 并删除对应的分钟计数
+    bool expireBefore(MYSQL* conn, int64_t seconds, const Counts& expired);
+
+    // 后台刷新线程, stop 时最后刷新一次
+    void start();
+    void stop();
+
+private:
+    LogStats() = default;
+    ~LogStats() = default;
+    LogStats(const LogStats&) = delete;
+    LogStats& operator=(const LogStats&) = delete;
+
+    void flushThread();
+
+    std::mutex _mutex;
+    std::mutex _dbMutex;                // 串行化 flush 与 refresh, 避免读到已提交但尚未计入 _dbTotals 的增量
+    std::condition_variable _cond;
+    MinuteCounts _pending;              // 尚未写入汇总表的增量
+    Counts _inFlight{};                 // flush 已取走、事务尚未提交的增量
+    Counts _dbTotals{};                 // 最近一次读取的 log_stats_total, 加上之后本进程刷新的增量
+    bool _loaded = false;
+    bool _running = false;
+    std::chrono::milliseconds _flushInterval{5000};
+    std::thread _thread;
+};
+
+#endif // __LOG_STATS_HPP__
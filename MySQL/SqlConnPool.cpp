@@ -29,9 +29,18 @@ void SqlConnPool::createDatabase(std::string dbName)
 
 #include "SqlConnPool.hpp"
 #include "../Util/EnvConfig.hpp"  // 添加环境配置头文件
+#include "LogPartition.hpp"
+#include "LogStats.hpp"
+#include <algorithm>
 
 // ...existing code...
 
+// 连接池参数取自环境变量 DB_POOL_MIN / DB_POOL_TIMEOUT_MS, 上限在 init 时确定
+SqlConnPool::SqlConnPool() {
+    _options.minConn = EnvConfig::getDBPoolMin();
+    _options.checkoutTimeout = std::chrono::milliseconds(std::max(0, EnvConfig::getDBPoolTimeoutMs()));
+}
+
 bool SqlConnPool::init(const char *host, const char *user, const char *password, const char *dbName, int port, int connSize) {
     // 如果传入的参数为空或默认值，尝试从环境变量获取
     std::string actualHost = (host && strlen(host) > 0) ? host : EnvConfig::getDBHost();
@@ -39,6 +48,8 @@ bool SqlConnPool::init(const char *host, const char *user, const char *password,
     std::string actualPassword = (password && strlen(password) > 0) ? password : EnvConfig::getDBPassword();
     std::string actualDBName = (dbName && strlen(dbName) > 0) ? dbName : EnvConfig::getDBName();
     int actualPort = (port > 0) ? port : EnvConfig::getDBPort();
+    // 连接数上限: DB_POOL_MAX 优先于调用方传入的连接数
+    int maxConn = EnvConfig::getDBPoolMax() > 0 ? EnvConfig::getDBPoolMax() : connSize;
     
     std::string path = std::filesystem::current_path().string() + "/Log/SqlConnPool.txt";
     LogMessage::setDefaultLogPath(path);
@@ -48,7 +59,7 @@ bool SqlConnPool::init(const char *host, const char *user, const char *password,
     std::cout << "  - 端口: " << actualPort << std::endl;
     std::cout << "  - 用户: " << actualUser << std::endl;
     std::cout << "  - 数据库: " << actualDBName << std::endl;
-    std::cout << "  - 连接数: " << connSize << std::endl;
+    std::cout << "  - 连接数: " << _options.minConn << " ~ " << maxConn << std::endl;
 
     // 1. 创建临时连接，不指定数据库
     MYSQL* temp = mysql_init(nullptr);
@@ -81,86 +92,259 @@ bool SqlConnPool::init(const char *host, const char *user, const char *password,
     }
     LogMessage::logMessage(INFO, "Database %s selected successfully", actualDBName.c_str());
 
-    // 3. 创建表结构
-    sql = R"(
-        CREATE TABLE IF NOT EXISTS log_table (
-        id BIGINT UNSIGNED AUTO_INCREMENT PRIMARY KEY, 
-        level ENUM('TRACE', 'DEBUG', 'INFO', 'WARNING', 'ERROR', 'FATAL') NOT NULL, 
-        ip VARCHAR(45) NOT NULL,
-        port SMALLINT UNSIGNED NOT NULL, 
-        message TEXT, 
-        timestamp TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
-        INDEX idx_timestamp (timestamp),
-        INDEX idx_level (level)
-        ) ENGINE=InnoDB CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci COMMENT='系统日志表';
-    )";
-    if (mysql_query(temp, sql.c_str()) != 0) {
-        LogMessage::logMessage(ERROR, "Failed to create table: %s", mysql_error(temp));
+    // 3. 创建表结构, 按 timestamp 分区
+    if (!LogPartitionManager::getInstance().createTable(temp)) {
         mysql_close(temp);
         return false;
     }
+    // 汇总表建不成时统计接口退回 COUNT(*), 不影响启动
+    bool statsReady = LogStats::getInstance().createTables(temp);
     LogMessage::logMessage(INFO, "Database and table created successfully");
 
     mysql_close(temp);
 
-    // 4. 初始化连接池
-    for (int i = 0; i < connSize; i++) {
-        MYSQL *conn = mysql_init(nullptr);
-        if (!conn) {
-            LogMessage::logMessage(ERROR, "MySQL init error!");
-            continue;
+    // 4. 初始化连接池, 先建立 minConn 条连接, 其余按需建立
+    _host = actualHost;
+    _user = actualUser;
+    _password = actualPassword;
+    _db = actualDBName;
+    _port = actualPort;
+    {
+        std::lock_guard<std::mutex> locker(_mutex);
+        _options.maxConn = std::max(1, maxConn);
+        _options.minConn = std::min(std::max(0, _options.minConn), _options.maxConn);
+        _running = true;
+    }
+    for (int i = 0; i < _options.minConn; i++) {
+        {
+            std::lock_guard<std::mutex> locker(_mutex);
+            ++_totalConn;
         }
-
-        conn = mysql_real_connect(conn, actualHost.c_str(), actualUser.c_str(), 
-                                  actualPassword.c_str(), actualDBName.c_str(), 
-                                  actualPort, nullptr, 0);
-        if (!conn) {
-            LogMessage::logMessage(ERROR, "MySQL Connect error: %s", mysql_error(conn));
-            continue;
+        MYSQL* conn = openPooledConnection();
+        std::lock_guard<std::mutex> locker(_mutex);
+        if (conn) {
+            _idleConns.push_back({conn, std::chrono::steady_clock::now()});
+        } else {
+            --_totalConn;
         }
-
-        _connQueue.emplace(conn);
     }
-
-    _maxConn = _connQueue.size();
-    sem_init(&_semID, 0, _maxConn);
+    _maintainThread = std::thread(&SqlConnPool::maintainThread, this);
+    LogPartitionManager::getInstance().start();
+    if (statsReady) {
+        LogStats::getInstance().start();
+    }
 
     return true;
 }
 
+void SqlConnPool::setPoolOptions(const SqlPoolOptions& options) {
+    std::lock_guard<std::mutex> locker(_mutex);
+    _options = options;
+}
 
-MYSQL* SqlConnPool::getConnection(){
-    // 条件变量是先上锁后判断的
-    // 这里使用信号量来控制连接数
-    if(_connQueue.empty()){
-        LogMessage::logMessage(ERROR, "SqlConnPool: No connection available");
-        return nullptr;
+MYSQL* SqlConnPool::openPooledConnection() {
+    MYSQL* conn = createConnection();
+    std::lock_guard<std::mutex> locker(_mutex);
+    if (conn) {
+        _stmtCaches[conn].reset(new StatementCache(conn));
+        ++_stats.created;
     }
-    sem_wait(&_semID);
-    std::unique_lock<std::mutex> lock(_mutex);
-    MYSQL* conn = _connQueue.front();
-    _connQueue.pop();
     return conn;
 }
 
+void SqlConnPool::closePooledConnection(MYSQL* conn) {
+    _stmtCaches.erase(conn);    // 语句句柄要在连接关闭前释放
+    mysql_close(conn);
+    ++_stats.closed;
+}
+
+void SqlConnPool::recordWait(std::chrono::steady_clock::duration waited) {
+    long long us = std::chrono::duration_cast<std::chrono::microseconds>(waited).count();
+    int bucket = 0;
+    while (bucket < SqlPoolStats::WAIT_BUCKETS - 1 && us > SqlPoolStats::WAIT_BOUNDS_US[bucket]) {
+        ++bucket;
+    }
+    ++_stats.waitHistogram[bucket];
+}
+
+MYSQL* SqlConnPool::getConnection(){
+    auto start = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(_mutex);
+    auto deadline = start + _options.checkoutTimeout;
+
+    while (_running) {
+        if (!_idleConns.empty()) {
+            IdleConn idle = _idleConns.back();
+            _idleConns.pop_back();
+            ++_usedConn;
+
+            // 空闲较久的连接可能已被服务端断开 (wait_timeout), 取出前先检查
+            if (start - idle.since >= _options.validateAfterIdle) {
+                lock.unlock();
+                bool alive = mysql_ping(idle.conn) == 0;
+                lock.lock();
+                if (!alive) {
+                    LogMessage::logMessage(WARNING, "SqlConnPool: 空闲连接已失效, 重新建立");
+                    ++_stats.validationFailures;
+                    closePooledConnection(idle.conn);
+                    --_usedConn;
+                    --_totalConn;
+                    continue;
+                }
+            }
+            ++_stats.checkouts;
+            _stats.peakInUse = std::max(_stats.peakInUse, _usedConn);
+            recordWait(std::chrono::steady_clock::now() - start);
+            return idle.conn;
+        }
+
+        // 没有空闲连接且未到上限时新建, 建立连接期间不持有锁
+        if (_totalConn < _options.maxConn) {
+            ++_totalConn;
+            lock.unlock();
+            MYSQL* conn = openPooledConnection();
+            lock.lock();
+            if (conn) {
+                ++_usedConn;
+                ++_stats.checkouts;
+                _stats.peakInUse = std::max(_stats.peakInUse, _usedConn);
+                recordWait(std::chrono::steady_clock::now() - start);
+                return conn;
+            }
+            --_totalConn;
+            _cond.notify_one();
+            if (_totalConn == 0) {
+                // 一条连接都建立不了, 数据库不可用, 不再等待
+                return nullptr;
+            }
+        }
+
+        ++_waiters;
+        bool signaled = _cond.wait_until(lock, deadline) == std::cv_status::no_timeout;
+        --_waiters;
+        if (!signaled) {
+            ++_stats.timeouts;
+            recordWait(std::chrono::steady_clock::now() - start);
+            LogMessage::logMessage(ERROR, "SqlConnPool: 等待连接超时 (使用中 %d 条, 另有 %d 个线程在等待)",
+                                   _usedConn, _waiters);
+            return nullptr;
+        }
+    }
+    LogMessage::logMessage(ERROR, "SqlConnPool: No connection available");
+    return nullptr;
+}
+
 void SqlConnPool::releaseConnection(MYSQL* conn) {
     assert(conn);
     std::lock_guard<std::mutex> locker(_mutex);
-    _connQueue.push(conn);
-    sem_post(&_semID);  // +1
+    --_usedConn;
+    if (!_running) {
+        // 连接池已销毁, 归还的连接直接关闭
+        closePooledConnection(conn);
+        --_totalConn;
+        return;
+    }
+    _idleConns.push_back({conn, std::chrono::steady_clock::now()});
+    _cond.notify_one();
 }
 
 void SqlConnPool::destroyPool() {
+    // 汇总刷新和分区维护线程使用池内连接, 先停止
+    LogStats::getInstance().stop();
+    LogPartitionManager::getInstance().stop();
+    {
+        std::lock_guard<std::mutex> locker(_mutex);
+        _running = false;
+        _cond.notify_all();
+        _maintainCond.notify_all();
+    }
+    if (_maintainThread.joinable()) {
+        _maintainThread.join();
+    }
+
     std::lock_guard<std::mutex> locker(_mutex);
-    while(!_connQueue.empty()) {
-        auto conn = _connQueue.front();
-        _connQueue.pop();
-        mysql_close(conn);
+    while (!_idleConns.empty()) {
+        closePooledConnection(_idleConns.front().conn);
+        _idleConns.pop_front();
+        --_totalConn;
     }
     mysql_library_end();
 }
 
+// 每秒检查一次: 关闭空闲过久的多余连接(从最早归还的开始), 连接数低于 minConn 时补足
+void SqlConnPool::maintainThread() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (_running) {
+        _maintainCond.wait_for(lock, std::chrono::seconds(1), [this] { return !_running; });
+        if (!_running) {
+            break;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        while (!_idleConns.empty() && _totalConn > _options.minConn &&
+               now - _idleConns.front().since >= _options.idleTimeout) {
+            closePooledConnection(_idleConns.front().conn);
+            _idleConns.pop_front();
+            --_totalConn;
+        }
+
+        if (_totalConn < _options.minConn) {
+            ++_totalConn;
+            lock.unlock();
+            MYSQL* conn = openPooledConnection();
+            lock.lock();
+            if (conn) {
+                _idleConns.push_back({conn, std::chrono::steady_clock::now()});
+                _cond.notify_one();
+            } else {
+                --_totalConn;
+            }
+        }
+    }
+}
+
+MYSQL* SqlConnPool::createConnection(bool localInfile) {
+    MYSQL *conn = mysql_init(nullptr);
+    if (!conn) {
+        LogMessage::logMessage(ERROR, "MySQL init error!");
+        return nullptr;
+    }
+
+    // 只有 AsyncDBWriter 的写入连接需要 LOAD DATA LOCAL INFILE 批量导入
+    if (localInfile) {
+        unsigned int enable = 1;
+        mysql_options(conn, MYSQL_OPT_LOCAL_INFILE, &enable);
+    }
+    // 数据库不可达时尽快失败, 不让获取连接的线程长时间阻塞
+    unsigned int connectTimeout = _options.connectTimeout;
+    mysql_options(conn, MYSQL_OPT_CONNECT_TIMEOUT, &connectTimeout);
+
+    if (!mysql_real_connect(conn, _host.c_str(), _user.c_str(), _password.c_str(),
+                            _db.c_str(), _port, nullptr, 0)) {
+        LogMessage::logMessage(ERROR, "MySQL Connect error: %s", mysql_error(conn));
+        mysql_close(conn);
+        return nullptr;
+    }
+    return conn;
+}
+
+StatementCache* SqlConnPool::getStatementCache(MYSQL* conn) {
+    std::lock_guard<std::mutex> locker(_mutex);
+    auto it = _stmtCaches.find(conn);
+    return it == _stmtCaches.end() ? nullptr : it->second.get();
+}
+
 int SqlConnPool::getReleaseConnCount() {
     std::lock_guard<std::mutex> locker(_mutex);
-    return _connQueue.size();
+    return _idleConns.size();
+}
+
+SqlPoolStats SqlConnPool::getStats() {
+    std::lock_guard<std::mutex> locker(_mutex);
+    SqlPoolStats stats = _stats;
+    stats.totalConn = _totalConn;
+    stats.idleConn = _idleConns.size();
+    stats.inUseConn = _usedConn;
+    stats.waiters = _waiters;
+    return stats;
 }
@@ -5,37 +5,166 @@
 #include <mysql/mysql.h>
 #include <thread>
 #include <mutex>
-#include <queue>
-#include <semaphore.h>
+#include <deque>
+#include <chrono>
+#include <condition_variable>
 #include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
 #include "../Util/EnvConfig.hpp"
 #include "../LogMessage/LogMessage.hpp"
-// #include <condition_variable>
+
+// 单个连接上按 SQL 文本缓存的预处理语句, 只由当前持有该连接的线程访问
+// 语句在第一次使用时才准备, 之后复用, 省去每次调用的 prepare 往返和服务端解析;
+// 连接重连后服务端线程 ID 会变化, 此时旧句柄全部作废, 下次使用时重新准备
+class StatementCache {
+private:
+    MYSQL* _conn;
+    unsigned long _threadId;
+    std::unordered_map<std::string, MYSQL_STMT*> _statements;
+
+public:
+    explicit StatementCache(MYSQL* conn) : _conn(conn), _threadId(mysql_thread_id(conn)) {}
+    ~StatementCache() { clear(); }
+    StatementCache(const StatementCache&) = delete;
+    StatementCache& operator=(const StatementCache&) = delete;
+
+    // 返回已准备好的语句, 失败时返回 nullptr (错误已记录)
+    // 查询语句用完后调用方需 mysql_stmt_free_result, 不要关闭句柄
+    MYSQL_STMT* get(const std::string& sql) {
+        unsigned long threadId = mysql_thread_id(_conn);
+        if (threadId != _threadId) {
+            clear();
+            _threadId = threadId;
+        }
+
+        auto it = _statements.find(sql);
+        if (it != _statements.end()) {
+            return it->second;
+        }
+
+        MYSQL_STMT* stmt = mysql_stmt_init(_conn);
+        if (!stmt) {
+            LogMessage::logMessage(ERROR, "mysql_stmt_init() 失败: %s", mysql_error(_conn));
+            return nullptr;
+        }
+        if (mysql_stmt_prepare(stmt, sql.c_str(), sql.length())) {
+            LogMessage::logMessage(ERROR, "mysql_stmt_prepare() 失败: %s", mysql_stmt_error(stmt));
+            mysql_stmt_close(stmt);
+            return nullptr;
+        }
+        _statements.emplace(sql, stmt);
+        return stmt;
+    }
+
+    // 语句执行出错(如连接断开)后丢弃, 下次使用时重新准备
+    void invalidate(const std::string& sql) {
+        auto it = _statements.find(sql);
+        if (it != _statements.end()) {
+            mysql_stmt_close(it->second);
+            _statements.erase(it);
+        }
+    }
+
+    void clear() {
+        for (auto& entry : _statements) {
+            mysql_stmt_close(entry.second);
+        }
+        _statements.clear();
+    }
+
+    size_t size() const {
+        return _statements.size();
+    }
+};
+
+// 连接池伸缩参数, 需在 init 之前设置; init 的 maxConn 参数覆盖 maxConn
+struct SqlPoolOptions {
+    int                         minConn = 2;            // 始终保持的连接数, 断线后由维护线程补足
+    int                         maxConn = 10;           // 连接数上限, 没有空闲连接时按需新建
+    std::chrono::milliseconds   checkoutTimeout{3000};  // 获取连接的最长等待时间, 超时返回 nullptr
+    std::chrono::milliseconds   validateAfterIdle{30000}; // 空闲超过此时间的连接取出前先 mysql_ping
+    std::chrono::milliseconds   idleTimeout{60000};     // 多于 minConn 的连接空闲超过此时间后关闭
+    unsigned int                connectTimeout = 3;     // 建立连接的超时(秒)
+};
+
+// 连接池运行状态, 用于监控连接池是否过小
+struct SqlPoolStats {
+    // 获取连接等待时间直方图各桶的上界(微秒), 最后一桶为超过 1 秒
+    static constexpr int WAIT_BUCKETS = 9;
+    static constexpr long long WAIT_BOUNDS_US[WAIT_BUCKETS - 1] = {100, 1000, 5000, 10000, 50000, 100000, 500000, 1000000};
+
+    int totalConn = 0;                  // 已建立的连接(空闲 + 使用中)
+    int idleConn = 0;
+    int inUseConn = 0;
+    int peakInUse = 0;                  // 启动以来同时使用的最大连接数
+    int waiters = 0;                    // 正在等待连接的线程数
+    uint64_t checkouts = 0;             // 成功获取连接的次数
+    uint64_t timeouts = 0;              // 等待超时的次数
+    uint64_t created = 0;               // 新建的连接数
+    uint64_t closed = 0;                // 因空闲或失效关闭的连接数
+    uint64_t validationFailures = 0;    // 取出前 ping 失败的次数
+    uint64_t waitHistogram[WAIT_BUCKETS] = {};
+};
 
 // 单例模式下的数据库连接池
+// 初始建立 minConn 条连接, 没有空闲连接时新建, 最多 maxConn 条; 达到上限后在条件变量上等待,
+// 超过 checkoutTimeout 返回 nullptr; 空闲连接按最近归还优先取出, 长时间空闲的连接取出前先 ping,
+// 失效则关闭重建; 后台维护线程关闭长时间空闲的多余连接, 并在连接数低于 minConn 时补足
 class SqlConnPool {
 private:
-    std::queue<MYSQL*> _connQueue;      // 连接队列
+    struct IdleConn {
+        MYSQL* conn;
+        std::chrono::steady_clock::time_point since;    // 归还时间
+    };
+
+    std::deque<IdleConn> _idleConns;    // 空闲连接, 尾部为最近归还的
+    std::unordered_map<MYSQL*, std::unique_ptr<StatementCache>> _stmtCaches; // 每个连接的语句缓存
     std::mutex _mutex;                  // 互斥锁
-    sem_t _semID;                       // 信号量
-    int _maxConn;                       // 最大连接数
-    int _usedConn;                      // 已使用的连接数
-    const char* _host;                  // 主机名
-    const char* _user;                  // 用户名
-    const char* _password;              // 密码
-    const char* _db;                    // 数据库名
+    std::condition_variable _cond;      // 有连接归还或连接数下降时通知等待者
+    SqlPoolOptions _options;
+    SqlPoolStats _stats;                // 计数部分, 连接数在 getStats 时填充
+    int _totalConn = 0;                 // 已建立及正在建立的连接数
+    int _usedConn = 0;                  // 已使用的连接数
+    int _waiters = 0;
+    bool _running = false;              // init 之后、destroyPool 之前为 true
+    std::thread _maintainThread;
+    std::condition_variable _maintainCond;
+    std::string _host;                  // 主机名
+    std::string _user;                  // 用户名
+    std::string _password;              // 密码
+    std::string _db;                    // 数据库名
+    int _port = 0;                      // 端口
+
+    // 新建一条连接并登记语句缓存, 调用方已为其预留 _totalConn 名额且未持有锁
+    MYSQL* openPooledConnection();
+    // 关闭一条池内连接, 调用方已持有锁并负责扣减 _totalConn
+    void closePooledConnection(MYSQL* conn);
+    void recordWait(std::chrono::steady_clock::duration waited);
+    void maintainThread();
+
 public:
     static SqlConnPool* getInstance();
+    // 获取连接, 等待超过 checkoutTimeout 或连接池未初始化时返回 nullptr
     MYSQL* getConnection();
     void releaseConnection(MYSQL* conn);
     void destroyPool();
     void createDatabase(std::string dbName);
+    void setPoolOptions(const SqlPoolOptions& options);
     bool init(const char* host, const char* user, const char* password, const char* dbName, int port, int maxConn);
     int getReleaseConnCount();
+    SqlPoolStats getStats();
+    // 返回连接对应的语句缓存, 仅在持有该连接期间使用
+    StatementCache* getStatementCache(MYSQL* conn);
+    // 按 init 时的配置新建一条不属于连接池的连接, 供需要长期独占连接的线程使用,
+    // 由调用方 mysql_close 关闭; 失败返回 nullptr
+    // localInfile 为 true 时允许该连接执行 LOAD DATA LOCAL INFILE, 连接池自己的连接不开启
+    MYSQL* createConnection(bool localInfile = false);
 
 
 private:
-    SqlConnPool() = default;
+    SqlConnPool();
     ~SqlConnPool() { destroyPool(); }
     SqlConnPool(const SqlConnPool&) = delete;
     SqlConnPool& operator=(const SqlConnPool&) = delete;
@@ -60,10 +189,35 @@ public:
             _connPool->releaseConnection(_conn);
         }
     }
+
+    // 取当前连接上缓存的预处理语句, 首次使用时准备
+    MYSQL_STMT* prepare(const std::string& sql) {
+        StatementCache* cache = statements();
+        return cache ? cache->get(sql) : nullptr;
+    }
+
+    // 语句执行失败后调用, 使缓存的句柄作废
+    void invalidate(const std::string& sql) {
+        StatementCache* cache = statements();
+        if (cache) {
+            cache->invalidate(sql);
+        }
+    }
+
+    StatementCache* statements() {
+        if (!_conn) {
+            return nullptr;
+        }
+        if (!_stmtCache) {
+            _stmtCache = _connPool->getStatementCache(_conn);
+        }
+        return _stmtCache;
+    }
     
 private:
     SqlConnPool* _connPool;
     MYSQL* _conn;
+    StatementCache* _stmtCache = nullptr;
 };
 
 #endif // __SQLCONNPOOLRAII_CPP__
\ No newline at end of file
@@ -1,29 +1,105 @@
 #include "AsyncDBWriter.hpp"
+#include "../MySQL/LogStats.hpp"
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
 
 using namespace Server;
 namespace AsyncDBWriterSpace {
 
-void AsyncDBWriter::addTask(const DBWriteTask& task) {
+static_assert(DBWriteTask::LEVEL_COUNT == LogStats::LEVEL_COUNT, "level 下标需与 LogStats 一致");
+
+bool AsyncDBWriter::addTask(DBWriteTask&& task) {
+    LOG_LEVEL level = task.logLevel();
+    size_t shardCount = shards_.size();
+    Shard& shard = *shards_[nextShard_.fetch_add(1, std::memory_order_relaxed) % shardCount];
+    size_t shardCapacity = std::max<size_t>(1, overload_->capacity() / shardCount);
     {
-        std::unique_lock<std::mutex> lock(mutex_);
-        taskQueue_.push(task);
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        // 轮询分配下各分片积压相近, 用本分片深度估算整体积压
+        if (!overload_->admit(level, shard.tasks.size() * shardCount)) {
+            return false;
+        }
+        // 启用缓冲文件时, 分片已满说明数据库跟不上, 直接顺序写入缓冲文件而不阻塞生产者
+        if (spool_ && shard.tasks.size() >= shardCapacity) {
+            lock.unlock();
+            return spoolTasks(&task, 1);
+        }
+        // 分片已满时等待工作线程取走任务, 关闭过程中不再等待
+        shard.notFull.wait(lock, [this, &shard, shardCapacity] {
+            return shard.tasks.size() < shardCapacity || !running_;
+        });
+        shard.tasks.push(std::move(task));
+    }
+    shard.cv.notify_one(); // 通知该分片的工作线程有新任务
+    return true;
+}
+
+void AsyncDBWriter::setOverloadPolicy(const OverloadPolicy& policy) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    overload_.reset(new OverloadController(policy, DEFAULT_QUEUE_CAPACITY));
+}
+
+void AsyncDBWriter::setSpoolOptions(const SpoolOptions& options) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    spoolOptions_ = options;
+}
+
+uint64_t AsyncDBWriter::getDroppedCount() const {
+    return overload_->totalDropped();
+}
+
+void AsyncDBWriter::setBatchOptions(const BatchOptions& options) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    batchOptions_ = options;
+    if (batchOptions_.maxBatchSize == 0) {
+        batchOptions_.maxBatchSize = 1;
     }
-    cv_.notify_one(); // 通知工作线程有新任务
 }
 
 void AsyncDBWriter::start(int numThreads) {
+    numThreads = std::max(1, numThreads);
+    running_ = true;
+
+    // 按线程数重建分片, start 之前已提交的任务依次分配到新分片
+    std::vector<std::unique_ptr<Shard>> shards;
     for (int i = 0; i < numThreads; ++i) {
-        workerThreads_.emplace_back(&AsyncDBWriter::workerThread, this);
+        shards.emplace_back(new Shard());
+    }
+    size_t next = 0;
+    for (auto& old : shards_) {
+        while (!old->tasks.empty()) {
+            shards[next++ % shards.size()]->tasks.push(std::move(old->tasks.front()));
+            old->tasks.pop();
+        }
+    }
+    shards_.swap(shards);
+
+    // 打开缓冲文件, 上次未写回的记录由回放线程在启动后写入数据库
+    if (!spoolOptions_.directory.empty()) {
+        spool_.reset(new WriteSpool(spoolOptions_));
+        if (spool_->open()) {
+            spoolThread_ = std::thread(&AsyncDBWriter::spoolThread, this);
+        } else {
+            LogMessage::logMessage(ERROR, "本地缓冲文件不可用, 数据库写入失败的日志将被丢弃");
+            spool_.reset();
+        }
+    }
+
+    for (int i = 0; i < numThreads; ++i) {
+        workerThreads_.emplace_back(&AsyncDBWriter::workerThread, this, static_cast<size_t>(i));
         LogMessage::logMessage(INFO, "启动数据库工作线程 #%d", i + 1);
     }
 }
 
 void AsyncDBWriter::shutdown() {
-    {
-        std::unique_lock<std::mutex> lock(mutex_);
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
         running_ = false;
+        shard->cv.notify_all();         // 通知工作线程
+        shard->notFull.notify_all();    // 唤醒等待分片空位的生产者
     }
-    cv_.notify_all(); // 通知所有工作线程
+    running_ = false;
     
     // 等待所有线程结束
     for (auto& thread : workerThreads_) {
@@ -31,18 +107,44 @@ void AsyncDBWriter::shutdown() {
             thread.join();
         }
     }
+    workerThreads_.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(spoolMutex_);
+        spoolCv_.notify_all();
+    }
+    if (spoolThread_.joinable()) {
+        spoolThread_.join();
+    }
     
     // 处理剩余任务
-    std::queue<DBWriteTask> remainingTasks;
-    {
-        std::unique_lock<std::mutex> lock(mutex_);
-        remainingTasks.swap(taskQueue_);
+    std::vector<DBWriteTask> remainingTasks;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        while (!shard->tasks.empty()) {
+            remainingTasks.push_back(std::move(shard->tasks.front()));
+            shard->tasks.pop();
+        }
     }
     
+    if (spool_) {
+        // 剩余任务整批写入缓冲文件, 下次启动时回放, 关闭过程不等待数据库
+        LogMessage::logMessage(INFO, "剩余的 %zu 个数据库任务写入缓冲文件", remainingTasks.size());
+        spoolTasks(remainingTasks.data(), remainingTasks.size());
+        spool_->sync(true);
+        spool_.reset();
+        return;
+    }
+
     LogMessage::logMessage(INFO, "处理剩余的 %zu 个数据库任务", remainingTasks.size());
-    while (!remainingTasks.empty()) {
-        executeWrite(remainingTasks.front());
-        remainingTasks.pop();
+    WorkerContext context;
+    std::vector<DBWriteTask> batch;
+    for (size_t i = 0; i < remainingTasks.size(); ++i) {
+        batch.push_back(std::move(remainingTasks[i]));
+        if (batch.size() >= batchOptions_.maxBatchSize || i + 1 == remainingTasks.size()) {
+            executeBatch(batch, context);
+            batch.clear();
+        }
     }
 }
 
@@ -53,121 +155,419 @@ AsyncDBWriter::~AsyncDBWriter() {
 }
 
 int AsyncDBWriter::getQueueSize() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return taskQueue_.size();
+    size_t total = 0;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        total += shard->tasks.size();
+    }
+    return total;
 }
 
-void AsyncDBWriter::workerThread() {
+void AsyncDBWriter::workerThread(size_t shardIndex) {
+    Shard& shard = *shards_[shardIndex];
+    WorkerContext context;
+    std::vector<DBWriteTask> batch;
+    batch.reserve(batchOptions_.maxBatchSize);
+
     while (running_) {
-        DBWriteTask task = [this] {
-            std::unique_lock<std::mutex> lock(mutex_);
-            cv_.wait_for(lock, std::chrono::seconds(1), [this] { 
-                return !taskQueue_.empty() || !running_; 
-            });
-            
-            if (!running_ && taskQueue_.empty()) {
-                return DBWriteTask("", "", 0, ""); // 返回空任务表示结束
-            }
-            
-            if (taskQueue_.empty()) {
-                return DBWriteTask("", "", 0, ""); // 超时返回空任务
-            }
-            
-            DBWriteTask task = taskQueue_.front();
-            taskQueue_.pop();
-            return task;
-        }();
-        
-        if (!task.logLevel.empty()) {
-            executeWrite(task);
+        collectBatch(shard, batch);
+        if (!batch.empty()) {
+            executeBatch(batch, context);
+            batch.clear();
+        }
+
+        // 有任务因过载被丢弃时, 按间隔输出一行汇总
+        std::string summary;
+        if (overload_->takeSummary("AsyncDBWriter", summary)) {
+            LogMessage::logMessage(WARNING, "%s", summary.c_str());
         }
     }
 }
 
-bool AsyncDBWriter::executeWrite(const DBWriteTask& task) {
-    MYSQL* conn = nullptr;
-    SqlConnRAII connRAII(&conn, SqlConnPool::getInstance());
-    
+void AsyncDBWriter::collectBatch(Shard& shard, std::vector<DBWriteTask>& batch) {
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    shard.cv.wait_for(lock, std::chrono::seconds(1), [this, &shard] {
+        return !shard.tasks.empty() || !running_;
+    });
+    if (shard.tasks.empty()) {
+        return; // 超时或正在关闭
+    }
+
+    // 积压严重时一次取走更多任务, 交给 LOAD DATA 批量导入
+    size_t limit = batchOptions_.maxBatchSize;
+    if (bulkAvailable_ && batchOptions_.bulkThreshold > 0 &&
+        shard.tasks.size() * shards_.size() >= batchOptions_.bulkThreshold) {
+        limit = std::max(limit, batchOptions_.bulkBatchSize);
+    }
+
+    // 取到第一条任务后, 最多再等 maxWait 凑满一批; 关闭时剩余任务由 shutdown 处理
+    auto deadline = std::chrono::steady_clock::now() + batchOptions_.maxWait;
+    while (true) {
+        while (!shard.tasks.empty() && batch.size() < limit) {
+            batch.push_back(std::move(shard.tasks.front()));
+            shard.tasks.pop();
+        }
+        shard.notFull.notify_all();
+
+        if (batch.size() >= limit || !running_) {
+            return;
+        }
+        bool more = shard.cv.wait_until(lock, deadline, [this, &shard] {
+            return !shard.tasks.empty() || !running_;
+        });
+        if (!more) {
+            return;
+        }
+    }
+}
+
+// 剩余行数不足 maxBatchSize 时按 2 的幂拆分, 如 37 行 = 32 + 4 + 1,
+// 使每个连接上需要缓存的语句数保持在很小的范围
+size_t AsyncDBWriter::chunkRows(size_t remaining, size_t maxBatchSize) {
+    if (remaining >= maxBatchSize) {
+        return maxBatchSize;
+    }
+    size_t rows = 1;
+    while (rows * 2 <= remaining) {
+        rows *= 2;
+    }
+    return rows;
+}
+
+// 连接类错误(2xxx)及连接数过多、服务端关闭、锁等待超时、死锁、只读(主从切换中)可以稍后重试
+static bool retryableError(unsigned int err) {
+    return (err >= 2000 && err < 3000) || err == 1040 || err == 1053 || err == 1205 ||
+           err == 1213 || err == 1290;
+}
+
+static int64_t steadyNow() {
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+bool AsyncDBWriter::databaseDown() const {
+    return steadyNow() < retryAfter_.load(std::memory_order_relaxed);
+}
+
+void AsyncDBWriter::markDatabaseDown() {
+    auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(spoolOptions_.retryInterval);
+    retryAfter_.store(steadyNow() + interval.count(), std::memory_order_relaxed);
+}
+
+bool AsyncDBWriter::spoolTasks(const DBWriteTask* tasks, size_t count) {
+    if (spool_->append(tasks, count)) {
+        rowsSpooled_ += count;
+        return true;
+    }
+    rowsFailed_ += count;
+    return false;
+}
+
+bool AsyncDBWriter::executeBatch(const std::vector<DBWriteTask>& tasks, WorkerContext& context) {
+    // 重试等待期内不再逐批尝试连接, 直接写缓冲文件
+    bool attempted = !spool_ || !databaseDown();
+    BatchResult result = attempted ? writeBatch(tasks, context) : BatchResult::RETRY;
+    if (result == BatchResult::OK) {
+        return true;
+    }
+    if (result == BatchResult::RETRY && spool_) {
+        if (attempted) {
+            markDatabaseDown();
+        }
+        return spoolTasks(tasks.data(), tasks.size());
+    }
+    rowsFailed_ += tasks.size();
+    return false;
+}
+
+AsyncDBWriter::BatchResult AsyncDBWriter::writeBatch(const std::vector<DBWriteTask>& tasks, WorkerContext& context) {
+    MYSQL* conn = context.connection();
     if (!conn) {
         LogMessage::logMessage(ERROR, "无法获取数据库连接");
-        return false;
+        return BatchResult::RETRY;
     }
 
-    // 设置自动提交为 false
-    mysql_autocommit(conn, 0);
-    
-    // 设置事务隔离级别
-    mysql_query(conn, "SET TRANSACTION ISOLATION LEVEL READ COMMITTED");
-    mysql_query(conn, "START TRANSACTION");
+    // 连接已断开(2006/2013)时丢弃连接, 下一批重新建立
+    context.lastError = 0;
+    auto fail = [&]() {
+        unsigned int err = context.lastError ? context.lastError : mysql_errno(conn);
+        if (err == 2006 || err == 2013) {
+            context.disconnect();
+        }
+        return retryableError(err) ? BatchResult::RETRY : BatchResult::FAILED;
+    };
 
-    // 初始化预处理语句
-    MYSQL_STMT *stmt = mysql_stmt_init(conn);
+    // 整批任务在一个事务内写入, 只需一次 START TRANSACTION 和一次 COMMIT
+    if (mysql_query(conn, "START TRANSACTION")) {
+        LogMessage::logMessage(ERROR, "开启事务失败: %s", mysql_error(conn));
+        return fail();
+    }
+
+    bool ok = true;
+    size_t offset = 0;
+    if (tasks.size() > batchOptions_.maxBatchSize && bulkAvailable_) {
+        if (bulkLoad(conn, tasks, context)) {
+            offset = tasks.size();
+            rowsBulkLoaded_ += tasks.size();
+        } else {
+            // 导入失败(服务端不允许 LOAD DATA 或其他错误)时回滚, 本批退回多行 INSERT;
+            // 连接已断开时重新开启事务失败, 按连接错误处理
+            mysql_rollback(conn);
+            if (mysql_query(conn, "START TRANSACTION")) {
+                LogMessage::logMessage(ERROR, "开启事务失败: %s", mysql_error(conn));
+                return fail();
+            }
+        }
+    }
+    while (ok && offset < tasks.size()) {
+        size_t rows = chunkRows(tasks.size() - offset, batchOptions_.maxBatchSize);
+        ok = insertRows(tasks, offset, rows, context);
+        offset += rows;
+    }
+
+    // 提交事务
+    if (!ok || mysql_commit(conn) != 0) {
+        if (ok) {
+            LogMessage::logMessage(ERROR, "事务提交失败: %s", mysql_error(conn));
+        }
+        BatchResult result = fail();    // 回滚会清除错误码, 先判断
+        if (context.conn) {
+            mysql_rollback(conn);
+        }
+        return result;
+    }
+
+    rowsWritten_ += tasks.size();
+    ++batchesWritten_;
+    LogStats::Counts counts{};
+    for (const auto& task : tasks) {
+        ++counts[task.level];
+    }
+    LogStats::getInstance().record(counts);
+    LogMessage::logMessage(INFO, "MySQL 成功批量插入 %zu 条日志", tasks.size());
+
+    // broadcastLogToWebSocket(task.logLevel, task.message, task.timestamp);
+    return BatchResult::OK;
+}
+
+void AsyncDBWriter::spoolThread() {
+    WorkerContext context;
+    std::vector<DBWriteTask> batch;
+
+    while (running_) {
+        {
+            std::unique_lock<std::mutex> lock(spoolMutex_);
+            spoolCv_.wait_for(lock, spoolOptions_.retryInterval, [this] { return !running_; });
+        }
+        spool_->sync(false);
+
+        // 缓冲文件中的积压一次最多取 bulkBatchSize 条, 交给 LOAD DATA 导入
+        size_t limit = batchOptions_.maxBatchSize;
+        if (bulkAvailable_ && batchOptions_.bulkThreshold > 0) {
+            limit = std::max(limit, batchOptions_.bulkBatchSize);
+        }
+        while (running_) {
+            batch.clear();
+            if (spool_->read(batch, limit) == 0) {
+                break;
+            }
+            BatchResult result = writeBatch(batch, context);
+            if (result == BatchResult::RETRY) {
+                markDatabaseDown();     // 本批留在缓冲文件中, 下一轮重试
+                break;
+            }
+            if (result == BatchResult::OK) {
+                rowsReplayed_ += batch.size();
+                retryAfter_.store(0, std::memory_order_relaxed);   // 数据库已恢复
+            } else {
+                // 数据本身被拒绝, 重试也不会成功, 跳过以免阻塞后续记录
+                rowsFailed_ += batch.size();
+                LogMessage::logMessage(ERROR, "缓冲文件中的 %zu 条日志写入失败, 已跳过", batch.size());
+            }
+            spool_->commit();
+        }
+    }
+}
+
+namespace {
+
+    // LOAD DATA 的数据源: 本地文件回调直接读取内存缓冲区
+    struct BulkSource {
+        const std::string* data;
+        size_t offset;
+    };
+
+    int bulkInit(void** ptr, const char*, void* userdata) {
+        *ptr = userdata;
+        return 0;
+    }
+
+    int bulkRead(void* ptr, char* buf, unsigned int length) {
+        BulkSource* source = static_cast<BulkSource*>(ptr);
+        size_t n = std::min<size_t>(length, source->data->size() - source->offset);
+        std::memcpy(buf, source->data->data() + source->offset, n);
+        source->offset += n;
+        return static_cast<int>(n);
+    }
+
+    void bulkEnd(void*) {}
+
+    int bulkError(void*, char* msg, unsigned int length) {
+        snprintf(msg, length, "bulk load source error");
+        return 2000; // CR_UNKNOWN_ERROR
+    }
+
+    // 按 LOAD DATA 默认转义规则写入一个字段
+    void appendField(std::string& out, std::string_view value) {
+        for (char c : value) {
+            switch (c) {
+                case '\\': out.append("\\\\"); break;
+                case '\t': out.append("\\t"); break;
+                case '\n': out.append("\\n"); break;
+                case '\r': out.append("\\r"); break;
+                case '\0': out.append("\\0"); break;
+                default:   out.push_back(c); break;
+            }
+        }
+    }
+}
+
+// 每行: level \t ip \t port \t message \t timestamp \n, 时间戳为空时使用当前时间
+bool AsyncDBWriter::bulkLoad(MYSQL* conn, const std::vector<DBWriteTask>& tasks, WorkerContext& context) {
+    static const char* query =
+        "LOAD DATA LOCAL INFILE 'async_db_writer.tsv' INTO TABLE log_table CHARACTER SET utf8mb4 "
+        "FIELDS TERMINATED BY '\\t' ESCAPED BY '\\\\' LINES TERMINATED BY '\\n' "
+        "(level, ip, port, message, @ts) "
+        "SET timestamp = IF(@ts = '', CURRENT_TIMESTAMP, @ts)";
+
+    std::string& data = context.bulkData;
+    data.clear();
+    char ip[INET6_ADDRSTRLEN];
+    for (const auto& task : tasks) {
+        data.append(task.levelName());
+        data.push_back('\t');
+        data.append(ip, task.formatIP(ip));
+        data.push_back('\t');
+        data.append(std::to_string(task.clientPort));
+        data.push_back('\t');
+        appendField(data, task.message.view());
+        data.push_back('\t');
+        appendField(data, task.timestampView());
+        data.push_back('\n');
+    }
+
+    BulkSource source{&data, 0};
+    mysql_set_local_infile_handler(conn, bulkInit, bulkRead, bulkEnd, bulkError, &source);
+    int ret = mysql_query(conn, query);
+    mysql_set_local_infile_default(conn);
+    if (ret == 0) {
+        return true;
+    }
+
+    // 1148/3948: 客户端或服务端禁用了 LOCAL INFILE
+    unsigned int err = mysql_errno(conn);
+    LogMessage::logMessage(ERROR, "LOAD DATA 批量导入失败(%u): %s", err, mysql_error(conn));
+    if (err == 1148 || err == 3948 || err == 2068) {
+        bulkAvailable_ = false;
+        LogMessage::logMessage(WARNING, "服务端未开启 local_infile, 批量导入退回多行 INSERT");
+    }
+    return false;
+}
+
+bool AsyncDBWriter::insertRows(const std::vector<DBWriteTask>& tasks, size_t offset, size_t rows,
+                               WorkerContext& context) {
+    const std::string& sql = context.insertSqlFor(rows);
+    MYSQL_STMT* stmt = context.statements->get(sql);
     if (!stmt) {
-        LogMessage::logMessage(ERROR, "mysql_stmt_init() 失败: %s", mysql_error(conn));
         return false;
     }
-    
-    // 准备带有占位符的SQL语句
-    const char *query = "INSERT INTO log_table (level, ip, port, message) VALUES (?, ?, ?, ?)";
-    if (mysql_stmt_prepare(stmt, query, strlen(query))) {
-        LogMessage::logMessage(ERROR, "mysql_stmt_prepare() 失败: %s", mysql_stmt_error(stmt));
-        mysql_stmt_close(stmt);
-        return false;
+
+    // 绑定参数, 每行依次为 level, ip, port, message, timestamp; 正文直接指向任务自己的缓冲区
+    context.binds.assign(rows * INSERT_COLUMNS, MYSQL_BIND());
+    context.ports.resize(rows);
+    context.ips.resize(rows);
+    for (size_t i = 0; i < rows; ++i) {
+        const DBWriteTask& task = tasks[offset + i];
+        MYSQL_BIND* bind = &context.binds[i * INSERT_COLUMNS];
+
+        bind[0].buffer_type = MYSQL_TYPE_STRING;
+        bind[0].buffer = (void*)task.levelName();
+        bind[0].buffer_length = strlen(task.levelName());
+
+        bind[1].buffer_type = MYSQL_TYPE_STRING;
+        bind[1].buffer = (void*)context.ips[i].data();
+        bind[1].buffer_length = task.formatIP(context.ips[i].data());
+
+        context.ports[i] = task.clientPort;
+        bind[2].buffer_type = MYSQL_TYPE_LONG;
+        bind[2].buffer = (void*)&context.ports[i];
+
+        bind[3].buffer_type = MYSQL_TYPE_STRING;
+        bind[3].buffer = (void*)task.message.data();
+        bind[3].buffer_length = task.message.size();
+
+        std::string_view timestamp = task.timestampView();
+        bind[4].buffer_type = MYSQL_TYPE_STRING;
+        bind[4].buffer = (void*)timestamp.data();
+        bind[4].buffer_length = timestamp.size();
     }
-    
-    // 绑定参数
-    MYSQL_BIND bind[4];
-    memset(bind, 0, sizeof(bind));
-    
-    // level 参数
-    bind[0].buffer_type = MYSQL_TYPE_STRING;
-    bind[0].buffer = (void*)task.logLevel.c_str();
-    bind[0].buffer_length = task.logLevel.length();
-    
-    // ip 参数
-    bind[1].buffer_type = MYSQL_TYPE_STRING;
-    bind[1].buffer = (void*)task.clientIP.c_str();
-    bind[1].buffer_length = task.clientIP.length();
-    
-    // port 参数
-    unsigned int port = task.clientPort;
-    bind[2].buffer_type = MYSQL_TYPE_LONG;
-    bind[2].buffer = (void*)&port;
-    
-    // message 参数
-    bind[3].buffer_type = MYSQL_TYPE_STRING;
-    bind[3].buffer = (void*)task.message.c_str();
-    bind[3].buffer_length = task.message.length();
-    
-    // 绑定参数到预处理语句
-    if (mysql_stmt_bind_param(stmt, bind)) {
+
+    if (mysql_stmt_bind_param(stmt, context.binds.data())) {
         LogMessage::logMessage(ERROR, "mysql_stmt_bind_param() 失败: %s", mysql_stmt_error(stmt));
-        mysql_stmt_close(stmt);
+        context.lastError = mysql_stmt_errno(stmt);
+        context.statements->invalidate(sql);
         return false;
     }
-    
-    // 执行预处理语句
+
     if (mysql_stmt_execute(stmt)) {
         LogMessage::logMessage(ERROR, "mysql_stmt_execute() 失败: %s", mysql_stmt_error(stmt));
-        mysql_stmt_close(stmt);
+        context.lastError = mysql_stmt_errno(stmt);
+        // 连接可能已断开, 丢弃该语句, 下次重新准备
+        context.statements->invalidate(sql);
         return false;
     }
+    return true;
+}
 
-    // 提交事务
-    if (mysql_commit(conn) != 0) {
-        mysql_rollback(conn);
-        LogMessage::logMessage(ERROR, "事务提交失败: %s", mysql_error(conn));
-        mysql_stmt_close(stmt);
-        return false;
+MYSQL* AsyncDBWriter::WorkerContext::connection() {
+    if (!conn) {
+        // 批量导入使用 LOAD DATA LOCAL INFILE, 只在写入线程自己的连接上开启
+        conn = SqlConnPool::getInstance()->createConnection(true);
+        if (conn) {
+            statements.reset(new StatementCache(conn));
+        }
     }
+    return conn;
+}
 
-    LogMessage::logMessage(INFO, "MySQL 成功插入日志: level=%s, ip=%s, port=%u", 
-                           task.logLevel.c_str(), task.clientIP.c_str(), port);
-    
-    // broadcastLogToWebSocket(task.logLevel, task.message, task.timestamp);
-    // 关闭预处理语句
-    mysql_stmt_close(stmt);
-    return true;
+void AsyncDBWriter::WorkerContext::disconnect() {
+    statements.reset();     // 语句句柄要在连接关闭前释放
+    if (conn) {
+        mysql_close(conn);
+        conn = nullptr;
+    }
+}
+
+const std::string& AsyncDBWriter::WorkerContext::insertSqlFor(size_t rows) {
+    std::string& query = insertSql[rows];
+    if (query.empty()) {
+        query = buildInsertSql(rows);
+    }
+    return query;
+}
+
+// INSERT INTO log_table (level, ip, port, message, timestamp) VALUES (?, ?, ?, ?, COALESCE(...)),(...)...
+// 时间戳为空时使用当前时间, 与 bulkLoad 的 IF(@ts = '', CURRENT_TIMESTAMP, @ts) 一致
+std::string AsyncDBWriter::buildInsertSql(size_t rows) {
+    static const char row[] = "(?, ?, ?, ?, COALESCE(NULLIF(?, ''), CURRENT_TIMESTAMP))";
+    std::string query = "INSERT INTO log_table (level, ip, port, message, timestamp) VALUES ";
+    query.reserve(query.size() + rows * sizeof(row));
+    for (size_t i = 0; i < rows; ++i) {
+        if (i != 0) {
+            query.push_back(',');
+        }
+        query += row;
+    }
+    return query;
 }
 
 } // namespace AsyncDBWriter
\ No newline at end of file
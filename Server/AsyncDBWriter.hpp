@@ -7,37 +7,73 @@
 #include <thread>
 #include <vector>
 #include <atomic>
+#include <map>
+#include <array>
+#include <chrono>
 #include <mysql/mysql.h>
 #include "Server.hpp"
 #include "../MySQL/SqlConnPool.hpp"
 #include "../LogMessage/LogMessage.hpp"
+#include "../LogMessage/OverloadPolicy.hpp"
+#include "DBWriteTask.hpp"
+#include "WriteSpool.hpp"
+#include <memory>
 
 namespace AsyncDBWriterSpace {
 
-// 数据库写入任务结构
-struct DBWriteTask {
-    std::string logLevel;
-    std::string clientIP;
-    int clientPort;
-    std::string message;
-    std::string timestamp;  // 可选，如果需要记录时间戳
-    
-    DBWriteTask(const std::string& level, const std::string& ip, int port, 
-                const std::string& msg, const std::string& time = "")
-        : logLevel(level), clientIP(ip), clientPort(port), message(msg), timestamp(time) {}
+// 批量写入参数: 工作线程最多凑 maxBatchSize 条任务, 或从取到第一条起最多等待 maxWait,
+// 然后在一个事务中用多行 INSERT 写入
+// 队列积压达到 bulkThreshold 时(如回放历史日志)改为一次取 bulkBatchSize 条,
+// 拼成内存中的 TSV 缓冲区后用 LOAD DATA LOCAL INFILE 导入, 不落临时文件;
+// 需要服务端开启 local_infile, 导入被拒绝时自动退回多行 INSERT
+struct BatchOptions {
+    size_t                      maxBatchSize = 256;
+    std::chrono::milliseconds   maxWait{5};
+    size_t                      bulkThreshold = 20000;  // 0 表示不使用批量导入
+    size_t                      bulkBatchSize = 50000;
 };
 
+// 任务队列按工作线程分片, 生产者轮询选择分片, 每个分片只有自己的工作线程消费,
+// 不同生产者/工作线程之间不再争用同一把锁;
+// 每个工作线程在整个生命周期内独占一条数据库连接, 写入时不经过连接池的锁和信号量
+// 启用本地缓冲文件后, 数据库不可用(连接失败、断线、锁超时等)的批次、分片已满时新提交的任务
+// 以及关闭时队列中剩余的任务都顺序追加到缓冲文件, 由回放线程在数据库恢复后(及下次启动时)分批写回
 class AsyncDBWriter {
 public:
+    static const size_t DEFAULT_QUEUE_CAPACITY = 100000;   // 任务队列默认容量 (所有分片合计)
+
     static AsyncDBWriter& getInstance() {
         static AsyncDBWriter instance;
         return instance;
     }
     
-    // 添加任务到队列
-    void addTask(const DBWriteTask& task);
+    // 添加任务到队列, 队列超过高水位时按等级策略丢弃/采样, 返回 false 表示任务被丢弃
+    // 右值版本直接移入队列, 不复制消息正文
+    bool addTask(DBWriteTask&& task);
+    bool addTask(const DBWriteTask& task) { return addTask(DBWriteTask(task)); }
+
+    // 设置过载策略 (容量单位为任务条数), 需在 start 之前调用
+    void setOverloadPolicy(const OverloadPolicy& policy);
+
+    // 设置批量写入参数, 需在 start 之前调用; maxBatchSize 为 1 时退化为逐条写入
+    void setBatchOptions(const BatchOptions& options);
+
+    // 设置本地缓冲文件, 需在 start 之前调用; directory 为空表示不启用
+    void setSpoolOptions(const SpoolOptions& options);
+
+    // 因过载被丢弃的任务数
+    uint64_t getDroppedCount() const;
+
+    // 已成功写入/写入失败的行数及已提交的批次数
+    uint64_t getWrittenRows() const { return rowsWritten_.load(); }
+    uint64_t getFailedRows() const { return rowsFailed_.load(); }
+    uint64_t getBatchCount() const { return batchesWritten_.load(); }
+    uint64_t getBulkLoadedRows() const { return rowsBulkLoaded_.load(); }
+    // 写入缓冲文件的行数及从缓冲文件写回数据库的行数
+    uint64_t getSpooledRows() const { return rowsSpooled_.load(); }
+    uint64_t getReplayedRows() const { return rowsReplayed_.load(); }
     
-    // 启动后台处理线程
+    // 启动后台处理线程, 每个线程对应一个队列分片; 会重建分片, 不能与 addTask 并发调用
     void start(int numThreads = 2);
     
     // 优雅关闭
@@ -45,21 +81,98 @@ public:
 
     int getQueueSize();
 
+    // 多行 INSERT 下一条语句的行数: 剩余不少于 maxBatchSize 时取 maxBatchSize, 否则取不超过剩余行数的最大 2 的幂
+    static size_t chunkRows(size_t remaining, size_t maxBatchSize);
+
+    // rows 行的多行 INSERT 语句, 每行 INSERT_COLUMNS 个参数: level, ip, port, message, timestamp
+    static constexpr size_t INSERT_COLUMNS = 5;
+    static std::string buildInsertSql(size_t rows);
+
 private:
-    AsyncDBWriter() : running_(true) {}
+    AsyncDBWriter() : running_(true), overload_(new OverloadController(OverloadPolicy(), DEFAULT_QUEUE_CAPACITY)) {
+        shards_.emplace_back(new Shard()); // start 之前提交的任务先放在单个分片中
+    }
     ~AsyncDBWriter();
+
+    // 一个工作线程的任务队列分片
+    struct Shard {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::condition_variable notFull;    // 分片已满时 BLOCK 等级的生产者在此等待
+        std::queue<DBWriteTask> tasks;
+    };
     
+    // 工作线程私有的数据库连接、预处理语句缓存、多行 INSERT 语句文本及绑定缓冲区
+    // 行数只取 maxBatchSize 和 2 的幂, 每个连接最多缓存 log2(maxBatchSize) + 2 条批量语句
+    struct WorkerContext {
+        MYSQL* conn = nullptr;
+        std::unique_ptr<StatementCache> statements;
+        std::map<size_t, std::string> insertSql;
+        std::vector<MYSQL_BIND> binds;
+        std::vector<unsigned int> ports;
+        std::vector<std::array<char, INET6_ADDRSTRLEN>> ips;   // 地址文本, 绑定期间保持有效
+        std::string bulkData;           // LOAD DATA 的数据缓冲区, 跨批次复用
+        unsigned int lastError = 0;     // 预处理语句的错误码, 语句失效前记录
+
+        ~WorkerContext() { disconnect(); }
+        MYSQL* connection();            // 未连接时新建连接
+        void disconnect();
+        const std::string& insertSqlFor(size_t rows);
+    };
+
     // 工作线程函数
-    void workerThread();
-    
-    // 执行数据库写入操作
-    bool executeWrite(const DBWriteTask& task);
+    void workerThread(size_t shardIndex);
+
+    // 从分片取出一批任务, 分片为空时最多等待 1 秒
+    void collectBatch(Shard& shard, std::vector<DBWriteTask>& batch);
+
+    // 批次写入结果: RETRY 表示数据库暂时不可用, 稍后重试可能成功
+    enum class BatchResult { OK, RETRY, FAILED };
+
+    // 写入整批任务, 数据库暂时不可用时转存到缓冲文件
+    bool executeBatch(const std::vector<DBWriteTask>& tasks, WorkerContext& context);
+
+    // 在一个事务中写入整批任务
+    BatchResult writeBatch(const std::vector<DBWriteTask>& tasks, WorkerContext& context);
+
+    // 追加到缓冲文件并计数, 缓冲文件写入失败时计为失败
+    bool spoolTasks(const DBWriteTask* tasks, size_t count);
+
+    // 回放线程函数: 把缓冲文件中的记录分批写回数据库
+    void spoolThread();
+
+    // 数据库是否处于重试等待期内
+    bool databaseDown() const;
+    void markDatabaseDown();
+
+    // 用 LOAD DATA LOCAL INFILE 从内存缓冲区导入整批任务, 调用方已开启事务
+    bool bulkLoad(MYSQL* conn, const std::vector<DBWriteTask>& tasks, WorkerContext& context);
+
+    // 用一条 rows 行的 INSERT 写入 tasks[offset, offset + rows)
+    bool insertRows(const std::vector<DBWriteTask>& tasks, size_t offset, size_t rows,
+                    WorkerContext& context);
     
-    std::queue<DBWriteTask> taskQueue_;
-    std::mutex mutex_;
-    std::condition_variable cv_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<size_t> nextShard_{0};  // 轮询分配分片
+    std::mutex mutex_;                  // 只保护配置修改
     std::vector<std::thread> workerThreads_;
     std::atomic<bool> running_;
+    std::unique_ptr<OverloadController> overload_;
+    BatchOptions batchOptions_;
+    std::atomic<uint64_t> rowsWritten_{0};
+    std::atomic<uint64_t> rowsFailed_{0};
+    std::atomic<uint64_t> batchesWritten_{0};
+    std::atomic<uint64_t> rowsBulkLoaded_{0};
+    std::atomic<bool> bulkAvailable_{true};     // 服务端拒绝 LOAD DATA 后不再尝试
+
+    SpoolOptions spoolOptions_;
+    std::unique_ptr<WriteSpool> spool_;         // 未启用时为空
+    std::thread spoolThread_;
+    std::mutex spoolMutex_;
+    std::condition_variable spoolCv_;           // 关闭时唤醒回放线程
+    std::atomic<int64_t> retryAfter_{0};        // 数据库不可用时, 此时刻(steady_clock)之前直接写缓冲文件
+    std::atomic<uint64_t> rowsSpooled_{0};
+    std::atomic<uint64_t> rowsReplayed_{0};
 };
 
 // 创建SyncDBWriter类作为对照组
@@ -76,18 +189,10 @@ public:
             return false;
         }
         
-        // 初始化预处理语句
-        MYSQL_STMT *stmt = mysql_stmt_init(conn);
+        // 取连接上缓存的预处理语句
+        static const std::string query = "INSERT INTO log_table (level, ip, port, message) VALUES (?, ?, ?, ?)";
+        MYSQL_STMT *stmt = connRAII.prepare(query);
         if (!stmt) {
-            LogMessage::logMessage(ERROR, "mysql_stmt_init() 失败: %s", mysql_error(conn));
-            return false;
-        }
-        
-        // 准备带有占位符的SQL语句
-        const char *query = "INSERT INTO log_table (level, ip, port, message) VALUES (?, ?, ?, ?)";
-        if (mysql_stmt_prepare(stmt, query, strlen(query))) {
-            LogMessage::logMessage(ERROR, "mysql_stmt_prepare() 失败: %s", mysql_stmt_error(stmt));
-            mysql_stmt_close(stmt);
             return false;
         }
         
@@ -97,13 +202,14 @@ public:
         
         // level 参数
         bind[0].buffer_type = MYSQL_TYPE_STRING;
-        bind[0].buffer = (void*)task.logLevel.c_str();
-        bind[0].buffer_length = task.logLevel.length();
+        bind[0].buffer = (void*)task.levelName();
+        bind[0].buffer_length = strlen(task.levelName());
         
         // ip 参数
+        char ip[INET6_ADDRSTRLEN];
         bind[1].buffer_type = MYSQL_TYPE_STRING;
-        bind[1].buffer = (void*)task.clientIP.c_str();
-        bind[1].buffer_length = task.clientIP.length();
+        bind[1].buffer = (void*)ip;
+        bind[1].buffer_length = task.formatIP(ip);
         
         // port 参数
         unsigned int port = task.clientPort;
@@ -112,28 +218,25 @@ public:
         
         // message 参数
         bind[3].buffer_type = MYSQL_TYPE_STRING;
-        bind[3].buffer = (void*)task.message.c_str();
-        bind[3].buffer_length = task.message.length();
+        bind[3].buffer = (void*)task.message.data();
+        bind[3].buffer_length = task.message.size();
         
         // 绑定参数到预处理语句
         if (mysql_stmt_bind_param(stmt, bind)) {
             LogMessage::logMessage(ERROR, "mysql_stmt_bind_param() 失败: %s", mysql_stmt_error(stmt));
-            mysql_stmt_close(stmt);
+            connRAII.invalidate(query);
             return false;
         }
         
         // 执行预处理语句
         if (mysql_stmt_execute(stmt)) {
             LogMessage::logMessage(ERROR, "mysql_stmt_execute() 失败: %s", mysql_stmt_error(stmt));
-            mysql_stmt_close(stmt);
+            connRAII.invalidate(query);
             return false;
         }
         
         LogMessage::logMessage(INFO, "MySQL 成功插入日志: level=%s, ip=%s, port=%u", 
-                            task.logLevel.c_str(), task.clientIP.c_str(), port);
-        
-        // 关闭预处理语句
-        mysql_stmt_close(stmt);
+                            task.levelName(), ip, port);
         
         return true;
     }
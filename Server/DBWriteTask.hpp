@@ -0,0 +1,101 @@
+#ifndef __DB_WRITE_TASK_HPP__
+#define __DB_WRITE_TASK_HPP__
+
+#include <string>
+#include <string_view>
+#include <cstring>
+#include <cstdint>
+#include <arpa/inet.h>
+#include "MessageSlab.hpp"
+#include "../LogMessage/LogLevel.hpp"
+
+namespace AsyncDBWriterSpace {
+
+// 数据库写入任务
+// 等级、地址、端口、时间戳按值存放, 只有消息正文占用一块 slab 内存;
+// 入队/出队都是移动, 一条日志从提交到写入只分配一次
+struct DBWriteTask {
+    static constexpr size_t LEVEL_COUNT = 6;
+    static constexpr size_t TIMESTAMP_SIZE = 32;
+
+    MessageBuffer   message;
+    uint16_t        clientPort = 0;
+    uint8_t         level = 2;              // log_table.level 枚举下标, 默认 INFO
+    uint8_t         family = 0;             // AF_INET / AF_INET6, 0 表示地址无法解析
+    uint8_t         timestampLength = 0;    // 为 0 时使用写入时间
+    unsigned char   address[16] = {};
+    char            timestamp[TIMESTAMP_SIZE] = {};
+
+    DBWriteTask() = default;
+
+    DBWriteTask(std::string_view levelName, std::string_view ip, int port,
+                std::string_view msg, std::string_view time = std::string_view())
+        : message(msg), clientPort(static_cast<uint16_t>(port)), level(levelIndex(levelName)) {
+        setAddress(ip);
+        timestampLength = static_cast<uint8_t>(std::min(time.size(), TIMESTAMP_SIZE - 1));
+        std::memcpy(timestamp, time.data(), timestampLength);
+    }
+
+    // 与 log_table.level 的 ENUM 定义顺序一致
+    static const char* const* levelNames() {
+        static const char* const names[LEVEL_COUNT] = {"TRACE", "DEBUG", "INFO", "WARNING", "ERROR", "FATAL"};
+        return names;
+    }
+
+    // 无法识别的等级(如 NORMAL)按 INFO 写入
+    static uint8_t levelIndex(std::string_view name) {
+        for (size_t i = 0; i < LEVEL_COUNT; ++i) {
+            if (name == levelNames()[i]) {
+                return static_cast<uint8_t>(i);
+            }
+        }
+        return 2;
+    }
+
+    const char* levelName() const {
+        return levelNames()[level];
+    }
+
+    // 过载策略使用的日志等级, TRACE 与 DEBUG 同等对待
+    LOG_LEVEL logLevel() const {
+        static const LOG_LEVEL levels[LEVEL_COUNT] = {DEBUG, DEBUG, INFO, WARNING, ERROR, FATAL};
+        return levels[level];
+    }
+
+    std::string_view timestampView() const {
+        return std::string_view(timestamp, timestampLength);
+    }
+
+    // 把地址格式化为文本写入 out (至少 INET6_ADDRSTRLEN 字节), 返回长度
+    size_t formatIP(char* out) const {
+        if (family == 0 || !inet_ntop(family, address, out, INET6_ADDRSTRLEN)) {
+            out[0] = '\0';
+            return 0;
+        }
+        return std::strlen(out);
+    }
+
+    std::string clientIP() const {
+        char text[INET6_ADDRSTRLEN];
+        size_t length = formatIP(text);
+        return std::string(text, length);
+    }
+
+private:
+    void setAddress(std::string_view ip) {
+        char text[INET6_ADDRSTRLEN] = {};
+        if (ip.empty() || ip.size() >= sizeof(text)) {
+            return;
+        }
+        std::memcpy(text, ip.data(), ip.size());
+        if (inet_pton(AF_INET, text, address) == 1) {
+            family = AF_INET;
+        } else if (inet_pton(AF_INET6, text, address) == 1) {
+            family = AF_INET6;
+        }
+    }
+};
+
+} // namespace AsyncDBWriterSpace
+
+#endif // __DB_WRITE_TASK_HPP__
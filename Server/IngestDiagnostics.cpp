@@ -0,0 +1,183 @@
+#include "IngestDiagnostics.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <iostream>
+
+using namespace Server;
+
+IngestDiagnostics& IngestDiagnostics::getInstance() {
+    // 不析构, 避免退出时其他静态对象仍在累加计数
+    static IngestDiagnostics* instance = new IngestDiagnostics();
+    return *instance;
+}
+
+IngestDiagnostics::Verbosity IngestDiagnostics::parseVerbosity(const std::string& name) {
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+    if (lower == "quiet") return Verbosity::QUIET;
+    if (lower == "sampled") return Verbosity::SAMPLED;
+    if (lower == "verbose") return Verbosity::VERBOSE;
+    return Verbosity::SUMMARY;
+}
+
+const char* IngestDiagnostics::verbosityName(Verbosity verbosity) {
+    switch (verbosity) {
+        case Verbosity::QUIET:   return "quiet";
+        case Verbosity::SAMPLED: return "sampled";
+        case Verbosity::VERBOSE: return "verbose";
+        default:                 return "summary";
+    }
+}
+
+void IngestDiagnostics::setVerbosity(Verbosity verbosity) {
+    _verbosity.store(verbosity, std::memory_order_relaxed);
+}
+
+void IngestDiagnostics::setSampleRate(uint32_t perSecond) {
+    _sampleRate.store(perSecond, std::memory_order_relaxed);
+}
+
+void IngestDiagnostics::setReportInterval(std::chrono::milliseconds interval) {
+    std::lock_guard<std::mutex> locker(_mutex);
+    _reportInterval = std::max(interval, std::chrono::milliseconds(100));
+}
+
+void IngestDiagnostics::setReportSink(ReportSink sink) {
+    std::lock_guard<std::mutex> locker(_mutex);
+    _sink = std::move(sink);
+}
+
+IngestDiagnostics::Counters IngestDiagnostics::snapshot() const {
+    Counters values{};
+    for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+        values[i] = _counters[i].load(std::memory_order_relaxed);
+    }
+    return values;
+}
+
+// 当前这一秒内的名额用完后返回 false; 跨秒时由先到的线程重置计数, 边界上可能多放过几条
+bool IngestDiagnostics::takeSample() {
+    int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t second = _sampleSecond.load(std::memory_order_relaxed);
+    if (second != now && _sampleSecond.compare_exchange_strong(second, now, std::memory_order_relaxed)) {
+        _sampledInSecond.store(0, std::memory_order_relaxed);
+    }
+    return _sampledInSecond.fetch_add(1, std::memory_order_relaxed) < _sampleRate.load(std::memory_order_relaxed);
+}
+
+bool IngestDiagnostics::traceEvent() {
+    Verbosity level = verbosity();
+    if (level != Verbosity::SAMPLED) {
+        return level == Verbosity::VERBOSE;
+    }
+    if (!takeSample()) {
+        add(SUPPRESSED);
+        return false;
+    }
+    return true;
+}
+
+bool IngestDiagnostics::traceError() {
+    Verbosity level = verbosity();
+    if (level == Verbosity::QUIET || level == Verbosity::VERBOSE) {
+        return level == Verbosity::VERBOSE;
+    }
+    if (!takeSample()) {
+        add(SUPPRESSED);
+        return false;
+    }
+    return true;
+}
+
+std::string IngestDiagnostics::report(std::chrono::milliseconds elapsed) {
+    Counters current = snapshot();
+    Counters delta{};
+    {
+        std::lock_guard<std::mutex> locker(_mutex);
+        bool changed = false;
+        for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+            delta[i] = current[i] - _reported[i];
+            changed = changed || delta[i] != 0;
+        }
+        _reported = current;
+        if (!changed) {
+            return "";
+        }
+    }
+
+    double seconds = std::max<double>(elapsed.count(), 1) / 1000.0;
+    char line[512];
+    snprintf(line, sizeof(line),
+             "\033[1;36m[摄入统计]\033[0m 最近 %.1f 秒: 读取 %llu 次 / %llu 字节, 日志 %llu 条 (%.1f 条/秒), "
+             "解析失败 %llu, 入库 %llu, 低于WARNING %llu, 连接 +%llu/-%llu (当前 %llu), 未打印事件 %llu",
+             seconds,
+             static_cast<unsigned long long>(delta[READS]),
+             static_cast<unsigned long long>(delta[BYTES]),
+             static_cast<unsigned long long>(delta[LOGS_PARSED]),
+             delta[LOGS_PARSED] / seconds,
+             static_cast<unsigned long long>(delta[PARSE_ERRORS]),
+             static_cast<unsigned long long>(delta[DB_QUEUED]),
+             static_cast<unsigned long long>(delta[BELOW_THRESHOLD]),
+             static_cast<unsigned long long>(delta[CONNECTIONS_OPENED]),
+             static_cast<unsigned long long>(delta[CONNECTIONS_CLOSED]),
+             static_cast<unsigned long long>(current[CONNECTIONS_OPENED] - current[CONNECTIONS_CLOSED]),
+             static_cast<unsigned long long>(delta[SUPPRESSED]));
+    return line;
+}
+
+void IngestDiagnostics::start() {
+    std::lock_guard<std::mutex> locker(_mutex);
+    if (_running) {
+        return;
+    }
+    _running = true;
+    _thread = std::thread(&IngestDiagnostics::reportThread, this);
+}
+
+void IngestDiagnostics::stop() {
+    {
+        std::lock_guard<std::mutex> locker(_mutex);
+        if (!_running) {
+            return;
+        }
+        _running = false;
+        _cond.notify_all();
+    }
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+// QUIET 时也推进报告基准, 切换回其他级别后的第一行只包含切换之后的增量
+void IngestDiagnostics::emitReport(std::chrono::steady_clock::time_point& last) {
+    auto now = std::chrono::steady_clock::now();
+    std::string line = report(std::chrono::duration_cast<std::chrono::milliseconds>(now - last));
+    last = now;
+    if (line.empty() || verbosity() == Verbosity::QUIET) {
+        return;
+    }
+    ReportSink sink;
+    {
+        std::lock_guard<std::mutex> locker(_mutex);
+        sink = _sink;
+    }
+    if (sink) {
+        sink(line);
+    } else {
+        std::cout << line << std::endl;
+    }
+}
+
+// 每个间隔报告一次增量; 被 stop 唤醒后最后报告一次再退出
+void IngestDiagnostics::reportThread() {
+    auto last = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (_running) {
+        _cond.wait_until(lock, last + _reportInterval, [this] { return !_running; });
+        lock.unlock();
+        emitReport(last);
+        lock.lock();
+    }
+}
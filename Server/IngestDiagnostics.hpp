@@ -0,0 +1,101 @@
+#ifndef __INGEST_DIAGNOSTICS_HPP__
+#define __INGEST_DIAGNOSTICS_HPP__
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Server {
+
+// 日志摄入路径的诊断输出 (单例)
+// 热路径上只累加计数器, 后台线程每个报告间隔打印一行汇总, 代替每条消息打印多行到控制台
+// 逐条事件(收到消息、日志等级、入库、响应大小等)按级别决定是否输出:
+//   QUIET    不打印汇总和逐条事件, 只保留计数
+//   SUMMARY  只打印周期汇总, 错误按采样上限打印 (默认)
+//   SAMPLED  逐条事件和错误按采样上限打印, 每秒最多 sampleRate 条, 超出的只计数
+//   VERBOSE  逐条事件全部打印, 与原来的行为一致
+class IngestDiagnostics {
+public:
+    enum class Verbosity { QUIET, SUMMARY, SAMPLED, VERBOSE };
+
+    enum Counter {
+        READS,              // 读到数据的次数
+        BYTES,              // 读到的字节数
+        LOGS_PARSED,        // 解析成功的日志条数
+        PARSE_ERRORS,       // 解析失败的日志条数
+        DB_QUEUED,          // 提交到异步写入队列的条数
+        BELOW_THRESHOLD,    // 低于 WARNING, 不入库的条数
+        CONNECTIONS_OPENED,
+        CONNECTIONS_CLOSED,
+        SUPPRESSED,         // 超出采样上限而未打印的事件数
+        COUNTER_COUNT
+    };
+    using Counters = std::array<uint64_t, COUNTER_COUNT>;
+    using ReportSink = std::function<void(const std::string& line)>;
+
+    static IngestDiagnostics& getInstance();
+
+    // quiet / summary / sampled / verbose, 不区分大小写; 无法识别时返回 SUMMARY
+    static Verbosity parseVerbosity(const std::string& name);
+    static const char* verbosityName(Verbosity verbosity);
+
+    // 以下设置可在运行中随时修改, 报告间隔从下一次报告起生效
+    void setVerbosity(Verbosity verbosity);
+    Verbosity verbosity() const { return _verbosity.load(std::memory_order_relaxed); }
+    void setSampleRate(uint32_t perSecond);
+    void setReportInterval(std::chrono::milliseconds interval);
+    // 汇总行的输出位置, 默认打印到 std::cout
+    void setReportSink(ReportSink sink);
+
+    void add(Counter counter, uint64_t value = 1) {
+        _counters[counter].fetch_add(value, std::memory_order_relaxed);
+    }
+    Counters snapshot() const;
+
+    // 调用方据此决定是否格式化并打印一条逐条事件/错误; 因采样上限被拒绝的记入 SUPPRESSED
+    bool traceEvent();
+    bool traceError();
+
+    // 与上次报告相比的增量汇总; 没有任何变化时返回空串
+    std::string report(std::chrono::milliseconds elapsed);
+
+    // 后台报告线程, stop 时最后报告一次
+    void start();
+    void stop();
+
+private:
+    IngestDiagnostics() = default;
+    ~IngestDiagnostics() = default;
+    IngestDiagnostics(const IngestDiagnostics&) = delete;
+    IngestDiagnostics& operator=(const IngestDiagnostics&) = delete;
+
+    bool takeSample();
+    void emitReport(std::chrono::steady_clock::time_point& last);
+    void reportThread();
+
+    std::array<std::atomic<uint64_t>, COUNTER_COUNT> _counters{};
+    std::atomic<Verbosity> _verbosity{Verbosity::SUMMARY};
+
+    // 采样: 按秒计数, 每秒最多 _sampleRate 条
+    std::atomic<uint32_t> _sampleRate{20};
+    std::atomic<int64_t>  _sampleSecond{0};
+    std::atomic<uint32_t> _sampledInSecond{0};
+
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    Counters _reported{};                   // 上次报告时的计数
+    ReportSink _sink;
+    bool _running = false;
+    std::chrono::milliseconds _reportInterval{10000};
+    std::thread _thread;
+};
+
+} // namespace Server
+
+#endif // __INGEST_DIAGNOSTICS_HPP__
@@ -0,0 +1,269 @@
+#include "IngestReactor.hpp"
+#include "../Util/Sock.hpp"
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+
+namespace Server {
+
+IngestReactor::IngestReactor(int listenFd, MessageHandler onMessage)
+    : _listenFd(listenFd), _onMessage(std::move(onMessage)) {
+    _epollFd = epoll_create1(EPOLL_CLOEXEC);
+    _wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    _idleFd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    if (_epollFd < 0 || _wakeFd < 0) {
+        std::cerr << "\033[1;31m[错误]\033[0m IngestReactor 初始化失败: " << strerror(errno) << std::endl;
+        return;
+    }
+    Sock::SetNonBlock(_listenFd);
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.fd = _listenFd;
+    if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, _listenFd, &ev) < 0) {
+        std::cerr << "\033[1;31m[错误]\033[0m epoll_ctl 添加监听套接字失败: " << strerror(errno) << std::endl;
+    }
+    ev.events = EPOLLIN;
+    ev.data.fd = _wakeFd;
+    epoll_ctl(_epollFd, EPOLL_CTL_ADD, _wakeFd, &ev);
+}
+
+IngestReactor::~IngestReactor() {
+    for (auto& entry : _connections) {
+        close(entry.first);
+    }
+    _connections.clear();
+    if (_epollFd >= 0) close(_epollFd);
+    if (_wakeFd >= 0) close(_wakeFd);
+    if (_idleFd >= 0) close(_idleFd);
+}
+
+void IngestReactor::setSessionHandlers(SessionHandler onOpen, SessionHandler onClose) {
+    _onOpen = std::move(onOpen);
+    _onClose = std::move(onClose);
+}
+
+void IngestReactor::setReadDoneHandler(ReadDoneHandler onReadDone) {
+    _onReadDone = std::move(onReadDone);
+}
+
+void IngestReactor::stop() {
+    _running = false;
+    uint64_t one = 1;
+    ssize_t n = write(_wakeFd, &one, sizeof(one));
+    (void)n;
+}
+
+void IngestReactor::run() {
+    if (_epollFd < 0 || _wakeFd < 0) {
+        return;
+    }
+    _running = true;
+    struct epoll_event events[256];
+    while (_running) {
+        int ready = epoll_wait(_epollFd, events, 256, _backlog.empty() ? -1 : 0);
+        if (ready < 0) {
+            if (errno != EINTR) {
+                std::cerr << "\033[1;31m[错误]\033[0m epoll_wait 失败: " << strerror(errno) << std::endl;
+            }
+            continue;
+        }
+        for (int i = 0; i < ready; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == _wakeFd) {
+                uint64_t count;
+                while (read(_wakeFd, &count, sizeof(count)) > 0) {
+                }
+                continue;
+            }
+            if (fd == _listenFd) {
+                acceptAll();
+                continue;
+            }
+
+            auto it = _connections.find(fd);
+            if (it == _connections.end()) {
+                continue;
+            }
+            Connection& conn = *it->second;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                closeConnection(fd);
+                continue;
+            }
+            if ((events[i].events & EPOLLOUT) && !flushOutput(conn)) {
+                closeConnection(fd);
+                continue;
+            }
+            // EPOLLRDHUP 时仍先读完对端关闭前发来的数据
+            if ((events[i].events & (EPOLLIN | EPOLLRDHUP)) && !conn.backlogged) {
+                onReadable(conn);
+            }
+        }
+
+        std::vector<int> backlog;
+        backlog.swap(_backlog);
+        for (int fd : backlog) {
+            auto it = _connections.find(fd);
+            if (it != _connections.end()) {
+                it->second->backlogged = false;
+                onReadable(*it->second);
+            }
+        }
+    }
+}
+
+// 边沿触发下必须接受到 EAGAIN 为止, 否则积压的连接不会再触发事件
+void IngestReactor::acceptAll() {
+    for (;;) {
+        struct sockaddr_in addr;
+        socklen_t len = sizeof(addr);
+        int fd = accept4(_listenFd, (struct sockaddr*)&addr, &len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            if ((errno == EMFILE || errno == ENFILE) && _idleFd >= 0) {
+                // 描述符耗尽: 腾出预留的描述符接受并关闭一个连接, 避免积压的连接反复唤醒却无法处理
+                close(_idleFd);
+                int rejected = accept(_listenFd, nullptr, nullptr);
+                if (rejected >= 0) {
+                    close(rejected);
+                }
+                _idleFd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+                std::cerr << "\033[1;31m[错误]\033[0m 文件描述符耗尽, 拒绝新连接" << std::endl;
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                std::cerr << "\033[1;31m[错误]\033[0m accept 失败: " << strerror(errno) << std::endl;
+            }
+            return;
+        }
+
+        std::unique_ptr<Connection> conn(new Connection());
+        conn->fd = fd;
+        char ip[INET_ADDRSTRLEN] = {0};
+        inet_ntop(AF_INET, &addr.sin_addr, ip, sizeof(ip));
+        conn->session.ip = ip;
+        conn->session.port = ntohs(addr.sin_port);
+        conn->session.startTime = time(nullptr);
+
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+        ev.data.fd = fd;
+        if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            std::cerr << "\033[1;31m[错误]\033[0m epoll_ctl 添加客户端失败: " << strerror(errno) << std::endl;
+            close(fd);
+            continue;
+        }
+        if (_onOpen) {
+            _onOpen(conn->session);
+        }
+        _connections[fd] = std::move(conn);
+        _connectionCount.store(_connections.size(), std::memory_order_relaxed);
+    }
+}
+
+// 读到 EAGAIN 或本轮配额用完为止, 每块数据交给 onMessage 处理, 响应合并后一起发送
+void IngestReactor::onReadable(Connection& conn) {
+    char buffer[READ_CHUNK];
+    bool peerClosed = false;
+    for (size_t reads = 0;; ++reads) {
+        if (reads == READS_PER_EVENT) {
+            conn.backlogged = true;
+            _backlog.push_back(conn.fd);
+            break;
+        }
+        ssize_t n = read(conn.fd, buffer, sizeof(buffer));
+        if (n > 0) {
+            conn.session.totalBytes += n;
+            conn.session.messageCount++;
+            conn.output += _onMessage(buffer, static_cast<size_t>(n), conn.session);
+            if (conn.session.closeAfterReply) {
+                peerClosed = true;
+                break;
+            }
+            continue;
+        }
+        if (n == 0) {
+            peerClosed = true;
+            break;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            std::cerr << "\033[1;31m[错误]\033[0m 读取失败. 错误码: " << errno << " (" << strerror(errno) << ")" << std::endl;
+            peerClosed = true;
+        }
+        break;
+    }
+
+    if (_onReadDone) {
+        conn.output += _onReadDone(conn.session);
+    }
+    int fd = conn.fd;
+    if (!flushOutput(conn) || peerClosed) {
+        closeConnection(fd);
+    }
+}
+
+// 尽量发出缓冲的响应; 发不完时关注 EPOLLOUT, 发完后取消; 连接出错返回 false
+bool IngestReactor::flushOutput(Connection& conn) {
+    size_t sent = 0;
+    while (sent < conn.output.size()) {
+        ssize_t n = send(conn.fd, conn.output.data() + sent, conn.output.size() - sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            sent += n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        return false;
+    }
+    conn.output.erase(0, sent);
+    if (conn.output.size() > MAX_PENDING_OUTPUT) {
+        std::cerr << "\033[1;31m[错误]\033[0m 客户端 " << conn.session.ip << ":" << conn.session.port
+                  << " 长时间不读取响应, 断开连接" << std::endl;
+        return false;
+    }
+
+    bool needWrite = !conn.output.empty();
+    if (needWrite != conn.writing) {
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN | EPOLLRDHUP | EPOLLET | (needWrite ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+        ev.data.fd = conn.fd;
+        epoll_ctl(_epollFd, EPOLL_CTL_MOD, conn.fd, &ev);
+        conn.writing = needWrite;
+    }
+    return true;
+}
+
+void IngestReactor::closeConnection(int fd) {
+    auto it = _connections.find(fd);
+    if (it == _connections.end()) {
+        return;
+    }
+    if (_onClose) {
+        _onClose(it->second->session);
+    }
+    epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    _connections.erase(it);
+    _connectionCount.store(_connections.size(), std::memory_order_relaxed);
+}
+
+} // namespace Server
@@ -0,0 +1,98 @@
+#ifndef __INGEST_REACTOR_HPP__
+#define __INGEST_REACTOR_HPP__
+
+#include <string>
+#include <memory>
+#include <atomic>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include <ctime>
+#include <cstdint>
+#include "../Util/IngestProtocol.hpp"
+
+namespace Server {
+
+// 一个日志上报连接的对端信息与统计
+struct IngestSession {
+    std::string ip;
+    int         port = 0;
+    uint64_t    totalBytes = 0;
+    uint64_t    messageCount = 0;
+    time_t      startTime = 0;
+
+    // 以下由消息处理函数维护
+    enum class Protocol { UNKNOWN, LEGACY, FRAMED };
+    Protocol    protocol = Protocol::UNKNOWN;   // 由连接上的第一个字节决定
+    IngestProtocol::FrameDecoder decoder;       // 分帧协议下尚未凑成完整帧的数据
+    uint64_t    processed = 0;                  // 已处理的日志条数
+    uint64_t    acked = 0;                      // 已确认给客户端的条数
+    bool        closeAfterReply = false;        // 协议错误等情况下, 发出已有响应后断开
+};
+
+// 原始 TCP 日志协议的事件循环: 边沿触发 epoll, 监听套接字和客户端连接都是非阻塞的,
+// 一个线程服务任意多个连接, 连接数与线程数无关
+// 每次 read 到的数据(最多 READ_CHUNK 字节)作为一条消息交给 onMessage, 返回值作为响应写回;
+// 发送缓冲区满时响应暂存在连接上, 等 EPOLLOUT 再发; 一轮读满 READS_PER_EVENT 块仍未读完的连接
+// 留到下一轮继续, 其间 epoll_wait 不阻塞
+// 每轮读取结束后调用 onReadDone, 返回值同样写回, 用于把一轮内的多条消息合并成一次确认
+class IngestReactor {
+public:
+    static constexpr size_t READ_CHUNK = 16 * 1024;
+    static constexpr size_t READS_PER_EVENT = 64;                  // 单个连接一轮最多处理的块数, 避免一个快客户端独占循环
+    static constexpr size_t MAX_PENDING_OUTPUT = 4 * 1024 * 1024;   // 对端长期不读响应时断开
+
+    using MessageHandler = std::function<std::string(const char* data, size_t size, IngestSession& session)>;
+    using SessionHandler = std::function<void(const IngestSession& session)>;
+    using ReadDoneHandler = std::function<std::string(IngestSession& session)>;
+
+    // listenFd 已 bind/listen, 由调用方负责关闭
+    IngestReactor(int listenFd, MessageHandler onMessage);
+    ~IngestReactor();
+
+    IngestReactor(const IngestReactor&) = delete;
+    IngestReactor& operator=(const IngestReactor&) = delete;
+
+    // 连接建立/断开时回调, 需在 run 之前设置
+    void setSessionHandlers(SessionHandler onOpen, SessionHandler onClose);
+    // 需在 run 之前设置
+    void setReadDoneHandler(ReadDoneHandler onReadDone);
+
+    // 在当前线程运行事件循环, 直到 stop
+    void run();
+    // 可在任意线程调用
+    void stop();
+
+    size_t connectionCount() const { return _connectionCount.load(std::memory_order_relaxed); }
+
+private:
+    struct Connection {
+        int             fd = -1;
+        IngestSession   session;
+        std::string     output;             // 尚未发出的响应
+        bool            writing = false;    // 是否已关注 EPOLLOUT
+        bool            backlogged = false; // 本轮未读完, 已放入 _backlog
+    };
+
+    void acceptAll();
+    void onReadable(Connection& conn);
+    bool flushOutput(Connection& conn);
+    void closeConnection(int fd);
+
+    int _listenFd;
+    int _epollFd = -1;
+    int _wakeFd = -1;       // stop 时写入, 唤醒 epoll_wait
+    int _idleFd = -1;       // 预留的描述符, 文件描述符耗尽时用来接受并立即关闭新连接
+    MessageHandler _onMessage;
+    SessionHandler _onOpen;
+    SessionHandler _onClose;
+    ReadDoneHandler _onReadDone;
+    std::unordered_map<int, std::unique_ptr<Connection>> _connections;
+    std::vector<int> _backlog;  // 数据未读完的连接, 边沿触发不会再通知, 下一轮继续读
+    std::atomic<bool> _running{false};
+    std::atomic<size_t> _connectionCount{0};
+};
+
+} // namespace Server
+
+#endif // __INGEST_REACTOR_HPP__
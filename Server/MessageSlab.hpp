@@ -0,0 +1,209 @@
+#ifndef __MESSAGE_SLAB_HPP__
+#define __MESSAGE_SLAB_HPP__
+
+#include <mutex>
+#include <vector>
+#include <string_view>
+#include <cstring>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+
+// 日志消息正文的定长块分配器
+// 按 64B ~ 4KB 分 7 级, 每个线程为每级持有一小批空闲块(magazine), 分配和释放通常不加锁;
+// 本地空闲块用完或攒得过多时才与全局空闲链表成批交换, 生产者线程分配、工作线程释放也能循环复用.
+// 超过 4KB 的消息直接走堆分配
+class MessageSlab {
+public:
+    static constexpr size_t  CLASS_COUNT = 7;
+    static constexpr size_t  MIN_BLOCK = 64;
+    static constexpr size_t  MAX_BLOCK = MIN_BLOCK << (CLASS_COUNT - 1);    // 4KB
+    static constexpr uint8_t HEAP_CLASS = 0xFF;
+    static constexpr size_t  MAGAZINE_SIZE = 64;                // 每线程每级最多缓存的空闲块
+    static constexpr size_t  TRANSFER_SIZE = 32;                // 与全局链表一次交换的块数
+    static constexpr size_t  GLOBAL_LIMIT = 8 * 1024 * 1024;    // 每级全局链表最多保留的字节数
+
+    // 线程局部缓存在线程退出时归还空闲块, 单例故意不析构, 避免退出顺序问题
+    static MessageSlab& getInstance() {
+        static MessageSlab* instance = new MessageSlab();
+        return *instance;
+    }
+
+    static size_t blockSize(uint8_t sizeClass) {
+        return MIN_BLOCK << sizeClass;
+    }
+
+    // 返回至少 size 字节的块, sizeClass 供释放时使用
+    char* allocate(size_t size, uint8_t& sizeClass) {
+        if (size > MAX_BLOCK) {
+            sizeClass = HEAP_CLASS;
+            return new char[size];
+        }
+        sizeClass = classFor(size);
+        if (s_cacheDestroyed) {
+            return new char[blockSize(sizeClass)];
+        }
+        std::vector<char*>& local = localCache().blocks[sizeClass];
+        if (local.empty()) {
+            refill(sizeClass, local);
+        }
+        if (local.empty()) {
+            return new char[blockSize(sizeClass)];
+        }
+        char* block = local.back();
+        local.pop_back();
+        return block;
+    }
+
+    void deallocate(char* block, uint8_t sizeClass) {
+        if (sizeClass == HEAP_CLASS) {
+            delete[] block;
+            return;
+        }
+        if (s_cacheDestroyed) {
+            // 线程退出阶段(如静态对象析构)本地缓存已销毁, 直接还给全局链表
+            std::vector<char*> single(1, block);
+            release(sizeClass, single, 1);
+            return;
+        }
+        std::vector<char*>& local = localCache().blocks[sizeClass];
+        local.push_back(block);
+        if (local.size() >= MAGAZINE_SIZE) {
+            release(sizeClass, local, TRANSFER_SIZE);
+        }
+    }
+
+    // 全局链表中的空闲块数, 用于测试与统计
+    size_t globalFreeBlocks(uint8_t sizeClass) {
+        std::lock_guard<std::mutex> lock(m_classes[sizeClass].mutex);
+        return m_classes[sizeClass].blocks.size();
+    }
+
+private:
+    struct ClassList {
+        std::mutex          mutex;
+        std::vector<char*>  blocks;
+    };
+
+    struct LocalCache {
+        std::vector<char*> blocks[CLASS_COUNT];
+
+        ~LocalCache() {
+            s_cacheDestroyed = true;
+            for (size_t i = 0; i < CLASS_COUNT; ++i) {
+                MessageSlab::getInstance().release(static_cast<uint8_t>(i), blocks[i], blocks[i].size());
+            }
+        }
+    };
+
+    ClassList m_classes[CLASS_COUNT];
+    static inline thread_local bool s_cacheDestroyed = false;  // 平凡类型, 线程退出后仍可读取
+
+    MessageSlab() = default;
+
+    static LocalCache& localCache() {
+        thread_local LocalCache cache;
+        return cache;
+    }
+
+    static uint8_t classFor(size_t size) {
+        uint8_t sizeClass = 0;
+        while (blockSize(sizeClass) < size) {
+            ++sizeClass;
+        }
+        return sizeClass;
+    }
+
+    void refill(uint8_t sizeClass, std::vector<char*>& local) {
+        ClassList& list = m_classes[sizeClass];
+        std::lock_guard<std::mutex> lock(list.mutex);
+        size_t count = std::min(TRANSFER_SIZE, list.blocks.size());
+        local.insert(local.end(), list.blocks.end() - count, list.blocks.end());
+        list.blocks.resize(list.blocks.size() - count);
+    }
+
+    // 把本地最后 count 个块还给全局链表, 超出上限的直接释放
+    void release(uint8_t sizeClass, std::vector<char*>& local, size_t count) {
+        ClassList& list = m_classes[sizeClass];
+        size_t limit = GLOBAL_LIMIT / blockSize(sizeClass);
+        std::lock_guard<std::mutex> lock(list.mutex);
+        for (size_t i = 0; i < count && !local.empty(); ++i) {
+            if (list.blocks.size() < limit) {
+                list.blocks.push_back(local.back());
+            } else {
+                delete[] local.back();
+            }
+            local.pop_back();
+        }
+    }
+};
+
+// 从 MessageSlab 分配的消息正文, 移动时只转移指针
+class MessageBuffer {
+private:
+    char*       m_data = nullptr;
+    uint32_t    m_size = 0;
+    uint8_t     m_class = MessageSlab::HEAP_CLASS;
+
+    void release() {
+        if (m_data) {
+            MessageSlab::getInstance().deallocate(m_data, m_class);
+            m_data = nullptr;
+            m_size = 0;
+        }
+    }
+
+public:
+    MessageBuffer() = default;
+
+    explicit MessageBuffer(std::string_view text) {
+        assign(text);
+    }
+
+    MessageBuffer(const MessageBuffer& other) {
+        assign(other.view());
+    }
+
+    MessageBuffer(MessageBuffer&& other) noexcept
+        : m_data(other.m_data), m_size(other.m_size), m_class(other.m_class) {
+        other.m_data = nullptr;
+        other.m_size = 0;
+    }
+
+    MessageBuffer& operator=(const MessageBuffer& other) {
+        if (this != &other) {
+            assign(other.view());
+        }
+        return *this;
+    }
+
+    MessageBuffer& operator=(MessageBuffer&& other) noexcept {
+        if (this != &other) {
+            release();
+            std::swap(m_data, other.m_data);
+            std::swap(m_size, other.m_size);
+            std::swap(m_class, other.m_class);
+        }
+        return *this;
+    }
+
+    ~MessageBuffer() {
+        release();
+    }
+
+    void assign(std::string_view text) {
+        release();
+        if (!text.empty()) {
+            m_data = MessageSlab::getInstance().allocate(text.size(), m_class);
+            std::memcpy(m_data, text.data(), text.size());
+            m_size = static_cast<uint32_t>(text.size());
+        }
+    }
+
+    const char* data() const { return m_data ? m_data : ""; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    std::string_view view() const { return std::string_view(data(), m_size); }
+};
+
+#endif // __MESSAGE_SLAB_HPP__
@@ -1,6 +1,11 @@
 #include "Server.hpp"
 #include "AsyncDBWriter.hpp"
+#include "../Util/EnvConfig.hpp"
+#include "../Util/LogLineParser.hpp"
+#include "IngestDiagnostics.hpp"
 using namespace AsyncDBWriterSpace;
+using Server::IngestSession;
+using Server::IngestDiagnostics;
 
 int Server::LeveltoInt(const std::string& level) {
     if (level == "NORMAL") return NORMAL;
@@ -12,7 +17,7 @@ int Server::LeveltoInt(const std::string& level) {
     return -1; // 未知等级
 }
 
-void Server::broadcastLogToWebSocket(const std::string& level, const std::string& message, const std::string& timestamp) {
+void Server::broadcastLogToWebSocket(const std::string& level, const std::string& message, const std::string& timestamp, bool verbose) {
     // 构造JSON格式的日志数据
     std::string logJson = "{\n";
     logJson += "\"type\": \"log_update\",\n";
@@ -24,47 +29,280 @@ void Server::broadcastLogToWebSocket(const std::string& level, const std::string
     // 调用全局WebSocket广播函数
     if (g_server) {
         g_server->broadcastWebSocketMessage(logJson);
-        LogMessage::logMessage(INFO, "WebSocket广播日志: %s - %s", level.c_str(), message.c_str());
+        if (verbose) {
+            LogMessage::logMessage(INFO, "WebSocket广播日志: %s - %s", level.c_str(), message.c_str());
+        }
     } else {
         LogMessage::logMessage(WARNING, "WebSocket服务器未初始化，无法广播日志");
     }
 }
 
-void Server::socketIO(int socket){
+void Server::logSessionOpened(const IngestSession& session) {
+    IngestDiagnostics::getInstance().add(IngestDiagnostics::CONNECTIONS_OPENED);
+    if (!IngestDiagnostics::getInstance().traceEvent()) {
+        return;
+    }
+    std::cout << "\033[1;34m[连接建立]\033[0m 客户端 " << session.ip << ":" << session.port << " 已连接" << std::endl;
+}
 
-    std::string defaultLogPath = std::filesystem::current_path().string() + "/Log/Server.txt";
-    LogMessage::setDefaultLogPath(defaultLogPath);
+void Server::logSessionClosed(const IngestSession& session) {
+    IngestDiagnostics::getInstance().add(IngestDiagnostics::CONNECTIONS_CLOSED);
+    if (!IngestDiagnostics::getInstance().traceEvent()) {
+        return;
+    }
+    std::cout << "\033[1;33m[连接终止]\033[0m 客户端 " << session.ip << ":" << session.port << " 断开连接" << std::endl;
+    // 显示会话统计信息
+    time_t session_duration = time(nullptr) - session.startTime;
+    std::cout << "\033[1;36m[会话统计]\033[0m 总接收: " 
+              << session.totalBytes << " 字节, 消息数: " << session.messageCount 
+              << ", 持续时间: " << session_duration << " 秒";
+    if (session.protocol == IngestSession::Protocol::FRAMED) {
+        std::cout << ", 已确认日志: " << session.acked << " 条";
+    }
+    std::cout << std::endl;
+}
+
+// 解析一条日志, 提交数据库写入和 WebSocket 广播; 格式不对返回 false
+// verbose 由 IngestDiagnostics 按输出级别和采样决定, 为 false 时只累加计数, 不逐条打印
+static bool ingestLogLine(std::string_view line, IngestSession& session, bool verbose){
+    IngestDiagnostics& diagnostics = IngestDiagnostics::getInstance();
+    // <log info>[INFO] {Scheduled task executed - Task: process_bitmap, Status: failed, Duration: {time}ms - Exception: bitmap & BITMAP_1} at 2025-04-09 15:45:45
+    LogLineParser::LogLine parsed;
+    if (!LogLineParser::parseIngestLine(line, parsed)) {
+        diagnostics.add(IngestDiagnostics::PARSE_ERRORS);
+        return false;
+    }
+    diagnostics.add(IngestDiagnostics::LOGS_PARSED);
+    std::string logLevel(parsed.level);
+    std::string message(parsed.message);
+    std::string timestamp(parsed.timestamp);
+    if (verbose) {
+        LogMessage::logMessage(INFO, "解析到日志等级: %s, 消息: %s, 时间戳: %s", logLevel.c_str(), message.c_str(), timestamp.c_str());
+    }
 
-    char buffer[1024] = {0}; // 初始化缓冲区
+    if((Server::LeveltoInt(logLevel) < 0 || Server::LeveltoInt(logLevel) > 5) && diagnostics.traceError()){
+        // 日志等级解析失败
+        std::cerr << "\033[1;31m[错误]\033[0m 日志等级解析失败" << std::endl;
+    }
+    if(Server::LeveltoInt(logLevel) < Server::LeveltoInt("WARNING")){
+        // 日志等级小于WARNING, 不记录到数据库
+        diagnostics.add(IngestDiagnostics::BELOW_THRESHOLD);
+        if (verbose) {
+            std::cout << "\033[1;33m[日志等级]\033[0m 日志等级小于WARNING, 不记录到数据库" << std::endl;
+        }
+    }
+    else{
+        if (verbose) {
+            std::cout << "\033[1;32m[日志等级]\033[0m 日志等级: " << logLevel << std::endl;
+            // 记录到数据库
+            std::cout << "\033[1;32m[数据库记录]\033[0m 日志记录到数据库" << std::endl;
+        }
+        // TODO: message字段需要更新
+
+        
+        // MYSQL* conn = nullptr;
+        // SqlConnRAII connRAII(&conn, SqlConnPool::getInstance());
+
+
+        // if(conn){
+        //     // 1. 初始化预处理语句
+        //     MYSQL_STMT *stmt = mysql_stmt_init(conn);
+        //     if (!stmt) {
+        //         LogMessage::logMessage(ERROR, "mysql_stmt_init() 失败: %s", mysql_error(conn));
+        //         continue;
+        //     }
+            
+        //     // 2. 准备带有占位符的SQL语句
+        //     const char *query = "INSERT INTO log_table (level, ip, port, message) VALUES (?, ?, ?, ?)";
+        //     if (mysql_stmt_prepare(stmt, query, strlen(query))) {
+        //         LogMessage::logMessage(ERROR, "mysql_stmt_prepare() 失败: %s", mysql_stmt_error(stmt));
+        //         mysql_stmt_close(stmt);
+        //         continue;
+        //     }
+            
+        //     // 3. 绑定参数
+        //     MYSQL_BIND bind[4];
+        //     memset(bind, 0, sizeof(bind));
+            
+        //     // level 参数
+        //     bind[0].buffer_type = MYSQL_TYPE_STRING;
+        //     bind[0].buffer = (void*)logLevel.c_str();
+        //     bind[0].buffer_length = logLevel.length();
+            
+        //     // ip 参数
+        //     bind[1].buffer_type = MYSQL_TYPE_STRING;
+        //     bind[1].buffer = (void*)session.ip.c_str();
+        //     bind[1].buffer_length = session.ip.length();
+            
+        //     // port 参数
+        //     unsigned int port = session.port;
+        //     bind[2].buffer_type = MYSQL_TYPE_LONG;
+        //     bind[2].buffer = (void*)&port;
+            
+        //     // message 参数
+        //     bind[3].buffer_type = MYSQL_TYPE_STRING;
+        //     bind[3].buffer = (void*)message.c_str();
+        //     bind[3].buffer_length = message.length();
+            
+        //     // 4. 绑定参数到预处理语句
+        //     if (mysql_stmt_bind_param(stmt, bind)) {
+        //         LogMessage::logMessage(ERROR, "mysql_stmt_bind_param() 失败: %s", mysql_stmt_error(stmt));
+        //         mysql_stmt_close(stmt);
+        //         continue;
+        //     }
+            
+        //     // 5. 执行预处理语句
+        //     if (mysql_stmt_execute(stmt)) {
+        //         LogMessage::logMessage(ERROR, "mysql_stmt_execute() 失败: %s", mysql_stmt_error(stmt));
+        //         mysql_stmt_close(stmt);
+        //         continue;
+        //     }
+            
+        //     LogMessage::logMessage(INFO, "MySQL 成功插入日志: level=%s, ip=%s, port=%u", 
+        //                           logLevel.c_str(), session.ip.c_str(), port);
+            
+        //     // 6. 关闭预处理语句
+        //     mysql_stmt_close(stmt);
+        // }
+        AsyncDBWriter::getInstance().addTask(DBWriteTask(logLevel, session.ip, session.port, message));
+        diagnostics.add(IngestDiagnostics::DB_QUEUED);
+        if (verbose) {
+            std::cout << "\033[1;32m[数据库记录]\033[0m 日志已提交到异步写入队列" << std::endl;
+        }
+
+        Server::broadcastLogToWebSocket(logLevel, message, timestamp, verbose);
+    }
+    return true;
+}
+
+// 旧协议: 每次读到的数据作为一条文本日志, 逐条回复 JSON
+static std::string handleLegacyMessage(const char* data, size_t size, IngestSession& session){
+    IngestDiagnostics& diagnostics = IngestDiagnostics::getInstance();
+    bool verbose = diagnostics.traceEvent();
+
+    // 格式化当前时间
+    auto now = std::chrono::system_clock::now();
+    std::time_t now_time = std::chrono::system_clock::to_time_t(now);
+    char time_buffer[64];
+    std::strftime(time_buffer, sizeof(time_buffer), "%Y-%m-%d %H:%M:%S", std::localtime(&now_time));
+    
+    // 消息摘要只在需要打印时构造
+    auto message_preview = [data, size]() {
+        return size > 50 ? std::string(data, 47) + "..." : std::string(data, size);
+    };
+    
+    if (verbose) {
+        std::cout << "\033[1;32m[消息接收]\033[0m [" << time_buffer << "] " 
+                  << session.ip << ":" << session.port << " > " << message_preview() 
+                  << " (" << size << " 字节)" << std::endl;
+    }
     
+    // 创建更结构化的响应消息
+    std::string response = "{\n";
+    response += "  \"status\": \"success\",\n";
+    response += "  \"timestamp\": \"" + std::string(time_buffer) + "\",\n";
+    response += "  \"message_size\": " + std::to_string(size) + ",\n";
+    response += "  \"server_id\": \"log_server_01\",\n";
+    response += "  \"client\": \"" + session.ip + ":" + std::to_string(session.port) + "\",\n";
+    response += "  \"message_number\": " + std::to_string(session.messageCount) + ",\n";
+    response += "  \"total_bytes\": " + std::to_string(session.totalBytes) + "\n";
+    response += "}";
+    
+    if (verbose) {
+        LogMessage::logMessage(INFO, "接收客户端消息: %.*s", static_cast<int>(size), data);
+    }
+    // 解析客户端信息并将其插入到数据库中
+    if (!ingestLogLine(std::string_view(data, size), session, verbose) && diagnostics.traceError()) {
+        std::string preview = message_preview();
+        LogMessage::logMessage(ERROR, "日志解析失败: %s", preview.c_str());
+        std::cerr << "\033[1;31m[错误]\033[0m 日志解析失败: " << preview << std::endl;
+    }
+
+    if (verbose) {
+        std::cout << "\033[1;36m[响应发送]\033[0m 响应大小: " << response.size() << " 字节" << std::endl;
+    }
+    return response;
+}
+
+// 分帧协议: 数据可能在任意位置被截断, 由会话上的 decoder 拼成完整帧后逐条处理, 不逐条回复
+static std::string handleFramedMessage(const char* data, size_t size, IngestSession& session){
+    IngestDiagnostics& diagnostics = IngestDiagnostics::getInstance();
+    session.decoder.feed(data, size);
+    IngestProtocol::Frame frame;
+    while (session.decoder.next(frame)) {
+        bool valid = true;
+        if (frame.type == IngestProtocol::LOG) {
+            if (!ingestLogLine(frame.payload, session, diagnostics.traceEvent()) && diagnostics.traceError()) {
+                LogMessage::logMessage(ERROR, "日志解析失败: %s", frame.payload.c_str());
+            }
+            session.processed++;
+        } else if (frame.type == IngestProtocol::BATCH) {
+            valid = IngestProtocol::forEachRecord(frame.payload, [&session, &diagnostics](const char* record, size_t length) {
+                if (!ingestLogLine(std::string_view(record, length), session, diagnostics.traceEvent()) && diagnostics.traceError()) {
+                    LogMessage::logMessage(ERROR, "日志解析失败: %.*s", static_cast<int>(length), record);
+                }
+                session.processed++;
+            });
+        } else {
+            valid = false;  // 客户端不应发送 ACK
+        }
+        if (!valid) {
+            std::cerr << "\033[1;31m[错误]\033[0m 客户端 " << session.ip << ":" << session.port << " 发送了格式错误的帧" << std::endl;
+            session.closeAfterReply = true;
+            return "";
+        }
+    }
+    if (session.decoder.error()) {
+        std::cerr << "\033[1;31m[错误]\033[0m 客户端 " << session.ip << ":" << session.port << " 发送了无法识别的帧" << std::endl;
+        session.closeAfterReply = true;
+    }
+    return "";
+}
+
+// 处理一次读到的数据(调用方已更新会话统计), 返回要写回客户端的响应
+// 连接上的第一个字节是帧类型时按分帧协议处理, 否则按旧的文本协议处理
+std::string Server::handleIngestMessage(const char* data, size_t size, IngestSession& session){
+    IngestDiagnostics::getInstance().add(IngestDiagnostics::READS);
+    IngestDiagnostics::getInstance().add(IngestDiagnostics::BYTES, size);
+    if (session.protocol == IngestSession::Protocol::UNKNOWN && size > 0) {
+        session.protocol = IngestProtocol::isFrameType(static_cast<uint8_t>(data[0]))
+            ? IngestSession::Protocol::FRAMED : IngestSession::Protocol::LEGACY;
+    }
+    if (session.protocol == IngestSession::Protocol::FRAMED) {
+        return handleFramedMessage(data, size, session);
+    }
+    return handleLegacyMessage(data, size, session);
+}
+
+// 一轮读取结束后回复一次累计确认, 客户端据此释放已发送的日志
+std::string Server::ackIngestProgress(IngestSession& session){
+    if (session.protocol != IngestSession::Protocol::FRAMED || session.processed == session.acked) {
+        return "";
+    }
+    session.acked = session.processed;
+    return IngestProtocol::encodeAck(session.acked);
+}
+
+// 阻塞方式处理单个连接, 直到对端关闭; ServerTCP 已改用 IngestReactor, 保留供单连接场景使用
+void Server::socketIO(int socket){
+    char buffer[IngestReactor::READ_CHUNK];
+
     // 获取客户端信息
     struct sockaddr_in client_addr;
     socklen_t addr_len = sizeof(client_addr);
     getpeername(socket, (struct sockaddr*)&client_addr, &addr_len);
-    std::string client_ip = inet_ntoa(client_addr.sin_addr);
-    int client_port = ntohs(client_addr.sin_port);
-    
-    // 记录连接信息
-    std::cout << "\033[1;34m[连接建立]\033[0m 客户端 " << client_ip << ":" << client_port << " 已连接" << std::endl;
-    
-    // 消息统计
-    uint64_t total_bytes = 0;
-    uint64_t message_count = 0;
-    time_t start_time = time(nullptr);
-    
+    IngestSession session;
+    session.ip = inet_ntoa(client_addr.sin_addr);
+    session.port = ntohs(client_addr.sin_port);
+    session.startTime = time(nullptr);
+    logSessionOpened(session);
+
     for (;;)
     {
-        memset(buffer, 0, sizeof(buffer)); // 每次读取前清空缓冲区
-
-        int valread = read(socket, buffer, sizeof(buffer));
+        ssize_t valread = read(socket, buffer, sizeof(buffer));
         if (valread == 0)
         {
-            std::cout << "\033[1;33m[连接终止]\033[0m 客户端 " << client_ip << ":" << client_port << " 断开连接" << std::endl;
-            // 显示会话统计信息
-            time_t session_duration = time(nullptr) - start_time;
-            std::cout << "\033[1;36m[会话统计]\033[0m 总接收: " 
-                      << total_bytes << " 字节, 消息数: " << message_count 
-                      << ", 持续时间: " << session_duration << " 秒" << std::endl;
+            logSessionClosed(session);
             break;
         }
         else if (valread == -1)
@@ -74,150 +312,11 @@ void Server::socketIO(int socket){
         }
 
         // 更新统计信息
-        total_bytes += valread;
-        message_count++;
-        
-        // 格式化当前时间
-        auto now = std::chrono::system_clock::now();
-        std::time_t now_time = std::chrono::system_clock::to_time_t(now);
-        char time_buffer[64];
-        std::strftime(time_buffer, sizeof(time_buffer), "%Y-%m-%d %H:%M:%S", std::localtime(&now_time));
-        
-        std::string message_total(buffer);
-        // 打印收到的消息摘要
-        std::string message_preview;
-        if (valread > 50) {
-            message_preview = std::string(buffer).substr(0, 47) + "...";
-        } else {
-            message_preview = std::string(buffer);
-        }
-        
-        std::cout << "\033[1;32m[消息接收]\033[0m [" << time_buffer << "] " 
-                  << client_ip << ":" << client_port << " > " << message_preview 
-                  << " (" << valread << " 字节)" << std::endl;
-        
-        // 创建更结构化的响应消息
-        std::string response = "{\n";
-        response += "  \"status\": \"success\",\n";
-        response += "  \"timestamp\": \"" + std::string(time_buffer) + "\",\n";
-        response += "  \"message_size\": " + std::to_string(valread) + ",\n";
-        response += "  \"server_id\": \"log_server_01\",\n";
-        response += "  \"client\": \"" + client_ip + ":" + std::to_string(client_port) + "\",\n";
-        response += "  \"message_number\": " + std::to_string(message_count) + ",\n";
-        response += "  \"total_bytes\": " + std::to_string(total_bytes) + "\n";
-        response += "}";
-        
-        // 发送响应
-        std::string path = std::filesystem::current_path().string() + "/Log/Server.txt";
-        LogMessage::logMessage(INFO, "接收客户端消息: %s", buffer);
-        // 解析客户端信息并将其插入到数据库中
-
-        // <log info>[INFO] {Scheduled task executed - Task: process_bitmap, Status: failed, Duration: {time}ms - Exception: bitmap & BITMAP_1} at 2025-04-09 15:45:45
-        // 解析 message_preview 即可
-        std::regex pattern(R"(<([^>]+)>\[([^\]]+)\]\s+\{(.*?)\}\s+at\s+([\d-]+\s[\d:]+))");
-        std::smatch match;
-        if (std::regex_search(message_total, match, pattern)) {
-            std::string logLevel = match[2];
-            std::string message = match[3];
-            std::string timestamp = match[4];
-            LogMessage::logMessage(INFO, "解析到日志等级: %s, 消息: %s, 时间戳: %s", logLevel.c_str(), message.c_str(), timestamp.c_str());
-
-            MYSQL* conn = nullptr;
-            SqlConnRAII connRAII(&conn, SqlConnPool::getInstance());
-
-            if(LeveltoInt(logLevel) < 0 || LeveltoInt(logLevel) > 5){
-                // 日志等级解析失败
-                std::cerr << "\033[1;31m[错误]\033[0m 日志等级解析失败" << std::endl;
-            }
-            if(LeveltoInt(logLevel) < LeveltoInt("WARNING")){
-                // 日志等级小于WARNING, 不记录到数据库
-                std::cout << "\033[1;33m[日志等级]\033[0m 日志等级小于WARNING, 不记录到数据库" << std::endl;
-            }
-            else{
-                std::cout << "\033[1;32m[日志等级]\033[0m 日志等级: " << logLevel << std::endl;
-                // 记录到数据库
-                std::cout << "\033[1;32m[数据库记录]\033[0m 日志记录到数据库" << std::endl;
-                // TODO: message字段需要更新
-
-                
-                // MYSQL* conn = nullptr;
-                // SqlConnRAII connRAII(&conn, SqlConnPool::getInstance());
-
-
-                // if(conn){
-                //     // 1. 初始化预处理语句
-                //     MYSQL_STMT *stmt = mysql_stmt_init(conn);
-                //     if (!stmt) {
-                //         LogMessage::logMessage(ERROR, "mysql_stmt_init() 失败: %s", mysql_error(conn));
-                //         continue;
-                //     }
-                    
-                //     // 2. 准备带有占位符的SQL语句
-                //     const char *query = "INSERT INTO log_table (level, ip, port, message) VALUES (?, ?, ?, ?)";
-                //     if (mysql_stmt_prepare(stmt, query, strlen(query))) {
-                //         LogMessage::logMessage(ERROR, "mysql_stmt_prepare() 失败: %s", mysql_stmt_error(stmt));
-                //         mysql_stmt_close(stmt);
-                //         continue;
-                //     }
-                    
-                //     // 3. 绑定参数
-                //     MYSQL_BIND bind[4];
-                //     memset(bind, 0, sizeof(bind));
-                    
-                //     // level 参数
-                //     bind[0].buffer_type = MYSQL_TYPE_STRING;
-                //     bind[0].buffer = (void*)logLevel.c_str();
-                //     bind[0].buffer_length = logLevel.length();
-                    
-                //     // ip 参数
-                //     bind[1].buffer_type = MYSQL_TYPE_STRING;
-                //     bind[1].buffer = (void*)client_ip.c_str();
-                //     bind[1].buffer_length = client_ip.length();
-                    
-                //     // port 参数
-                //     unsigned int port = client_port;
-                //     bind[2].buffer_type = MYSQL_TYPE_LONG;
-                //     bind[2].buffer = (void*)&port;
-                    
-                //     // message 参数
-                //     bind[3].buffer_type = MYSQL_TYPE_STRING;
-                //     bind[3].buffer = (void*)message.c_str();
-                //     bind[3].buffer_length = message.length();
-                    
-                //     // 4. 绑定参数到预处理语句
-                //     if (mysql_stmt_bind_param(stmt, bind)) {
-                //         LogMessage::logMessage(ERROR, "mysql_stmt_bind_param() 失败: %s", mysql_stmt_error(stmt));
-                //         mysql_stmt_close(stmt);
-                //         continue;
-                //     }
-                    
-                //     // 5. 执行预处理语句
-                //     if (mysql_stmt_execute(stmt)) {
-                //         LogMessage::logMessage(ERROR, "mysql_stmt_execute() 失败: %s", mysql_stmt_error(stmt));
-                //         mysql_stmt_close(stmt);
-                //         continue;
-                //     }
-                    
-                //     LogMessage::logMessage(INFO, "MySQL 成功插入日志: level=%s, ip=%s, port=%u", 
-                //                           logLevel.c_str(), client_ip.c_str(), port);
-                    
-                //     // 6. 关闭预处理语句
-                //     mysql_stmt_close(stmt);
-                // }
-                DBWriteTask task(logLevel, client_ip, client_port, message);
-                AsyncDBWriter::getInstance().addTask(task);
-                std::cout << "\033[1;32m[数据库记录]\033[0m 日志已提交到异步写入队列" << std::endl;
-
-                broadcastLogToWebSocket(logLevel, message, timestamp);
-            }
-        }
-        else{
-            LogMessage::logMessage(ERROR, "日志解析失败: %s", message_preview.c_str());
-            std::cerr << "\033[1;31m[错误]\033[0m 日志解析失败: " << message_preview << std::endl;
-        }
+        session.totalBytes += valread;
+        session.messageCount++;
 
-        int bytes_sent = write(socket, response.c_str(), response.size());
-        std::cout << "\033[1;36m[响应发送]\033[0m 响应大小: " << bytes_sent << " 字节" << std::endl;
+        std::string response = handleIngestMessage(buffer, static_cast<size_t>(valread), session);
+        send(socket, response.c_str(), response.size(), MSG_NOSIGNAL);
     }
     
     close(socket); // 关闭套接字
@@ -247,12 +346,16 @@ Server::ServerTCP::ServerTCP(uint64_t    port
                 exit(1);
             }
             
-            // 启动异步数据库写入器
+            // 启动异步数据库写入器, 数据库不可用时日志暂存到本地缓冲目录
+            SpoolOptions spoolOptions;
+            spoolOptions.directory = EnvConfig::getDBSpoolDir();
+            AsyncDBWriter::getInstance().setSpoolOptions(spoolOptions);
             AsyncDBWriter::getInstance().start(10); // 启动2个工作线程
         }
 
 // 修改析构函数，确保正确关闭异步写入器
 Server::ServerTCP::~ServerTCP() {
+    IngestDiagnostics::getInstance().stop();
     AsyncDBWriter::getInstance().shutdown();
     close(_socketfd);
 }
@@ -289,8 +392,8 @@ void Server::ServerTCP::init(){
         exit(1);
     }
 
-    // listen
-    if(listen(_socketfd, 5) < 0){
+    // listen, 积压队列取系统上限 (net.core.somaxconn)
+    if(listen(_socketfd, SOMAXCONN) < 0){
         std::cerr << "Error listening on socket" << std::endl;
         exit(1);
     }
@@ -299,21 +402,22 @@ void Server::ServerTCP::init(){
 }
 
 void Server::ServerTCP::run(){
-    // 连接客户端
-    for (;;)
-    {
-        struct sockaddr_in client_addr;
-        socklen_t client_addr_size = sizeof(client_addr);
-        int client_socket = accept(_socketfd, (struct sockaddr *)&client_addr, &client_addr_size);
-        if (client_socket < 0)
-        {
-            std::cerr << "Error accepting client" << std::endl;
-            continue;
-        }
+    // 单线程边沿触发事件循环处理所有客户端连接
+    std::string defaultLogPath = std::filesystem::current_path().string() + "/Log/Server.txt";
+    LogMessage::setDefaultLogPath(defaultLogPath);
 
-        std::thread client_thread(socketIO, client_socket);
-        client_thread.detach(); // 分离线程，允许其独立运行
-    }
+    // 逐条输出按级别和采样决定, 汇总由后台线程定期打印
+    IngestDiagnostics& diagnostics = IngestDiagnostics::getInstance();
+    diagnostics.setVerbosity(IngestDiagnostics::parseVerbosity(EnvConfig::getIngestLogVerbosity()));
+    diagnostics.setSampleRate(static_cast<uint32_t>(std::max(0, EnvConfig::getIngestLogSampleRate())));
+    diagnostics.setReportInterval(std::chrono::seconds(std::max(1, EnvConfig::getIngestStatsInterval())));
+    diagnostics.start();
+    std::cout << "\033[1;34m[运行]\033[0m 摄入日志输出级别: " << IngestDiagnostics::verbosityName(diagnostics.verbosity()) << std::endl;
+
+    IngestReactor reactor(_socketfd, handleIngestMessage);
+    reactor.setSessionHandlers(logSessionOpened, logSessionClosed);
+    reactor.setReadDoneHandler(ackIngestProgress);
+    reactor.run();
 }
 
 void Server::setGlobalServerReference(EpollServerSpace::EpollServer* server) {
@@ -20,6 +20,7 @@
 #include "../Logger.hpp"
 #include "../EpollServer/EpollServer.hpp"
 #include "../LogMessage/LogMessage.hpp"
+#include "IngestReactor.hpp"
 
 namespace EpollServerSpace{
     class EpollServer;
@@ -27,16 +28,24 @@ namespace EpollServerSpace{
 
 // 客户端从本地文件读取日志信息后传到远端服务器
 // 服务器接收日志信息并返回确认信息给客户端
-// 目前只支持单个客户端连接
+// 所有客户端连接由 IngestReactor 的事件循环处理
 namespace Server{
     extern EpollServerSpace::EpollServer* g_server; // 声明外部全局服务器变量
     // initialize socket
     // bind socket
     // listen socket
     void socketIO(int socket);
+    // 处理一次读到的数据: 分帧协议下拼帧后逐条处理, 旧文本协议下整块作为一条日志;
+    // 提交数据库写入和 WebSocket 广播, 返回给客户端的响应
+    std::string handleIngestMessage(const char* data, size_t size, IngestSession& session);
+    // 一轮读取结束后调用, 分帧协议下返回累计确认帧
+    std::string ackIngestProgress(IngestSession& session);
+    void logSessionOpened(const IngestSession& session);
+    void logSessionClosed(const IngestSession& session);
     int LeveltoInt(const std::string& level);
 
-    void broadcastLogToWebSocket(const std::string& level, const std::string& message, const std::string& timestamp);
+    // verbose 为 false 时不逐条写入 LogMessage
+    void broadcastLogToWebSocket(const std::string& level, const std::string& message, const std::string& timestamp, bool verbose = true);
     void setGlobalServerReference(EpollServerSpace::EpollServer* server);
     
     class ServerTCP{
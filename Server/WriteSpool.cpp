@@ -0,0 +1,464 @@
+#include "WriteSpool.hpp"
+#include "../LogMessage/LogMessage.hpp"
+#include <zlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <filesystem>
+
+namespace AsyncDBWriterSpace {
+
+namespace {
+
+    namespace fs = std::filesystem;
+
+    const size_t HEADER_SIZE = 8;                   // 长度 + CRC32
+    const size_t FIXED_SIZE = 21;                   // level, family, port, address, 时间戳长度
+    const size_t MAX_RECORD = 16 * 1024 * 1024;     // 超过此长度视为损坏
+    const size_t READ_CHUNK = 256 * 1024;
+    const char* const SEGMENT_PREFIX = "spool-";
+    const char* const SEGMENT_SUFFIX = ".dat";
+    const char* const CHECKPOINT_NAME = "checkpoint";
+
+    void encodeTask(const DBWriteTask& task, std::string& out) {
+        uint32_t length = static_cast<uint32_t>(FIXED_SIZE + task.timestampLength + task.message.size());
+        size_t start = out.size();
+        out.resize(start + HEADER_SIZE + length);
+        char* p = &out[start + HEADER_SIZE];
+        p[0] = static_cast<char>(task.level);
+        p[1] = static_cast<char>(task.family);
+        std::memcpy(p + 2, &task.clientPort, 2);
+        std::memcpy(p + 4, task.address, 16);
+        p[20] = static_cast<char>(task.timestampLength);
+        std::memcpy(p + FIXED_SIZE, task.timestamp, task.timestampLength);
+        std::memcpy(p + FIXED_SIZE + task.timestampLength, task.message.data(), task.message.size());
+
+        uint32_t crc = static_cast<uint32_t>(crc32(0L, reinterpret_cast<const Bytef*>(p), length));
+        std::memcpy(&out[start], &length, 4);
+        std::memcpy(&out[start + 4], &crc, 4);
+    }
+
+    bool decodeTask(const char* p, uint32_t length, DBWriteTask& task) {
+        if (length < FIXED_SIZE) {
+            return false;
+        }
+        uint8_t level = static_cast<uint8_t>(p[0]);
+        uint8_t family = static_cast<uint8_t>(p[1]);
+        uint8_t timestampLength = static_cast<uint8_t>(p[20]);
+        if (level >= DBWriteTask::LEVEL_COUNT || timestampLength >= DBWriteTask::TIMESTAMP_SIZE ||
+            FIXED_SIZE + timestampLength > length) {
+            return false;
+        }
+        task.level = level;
+        task.family = family;
+        std::memcpy(&task.clientPort, p + 2, 2);
+        std::memcpy(task.address, p + 4, 16);
+        task.timestampLength = timestampLength;
+        std::memcpy(task.timestamp, p + FIXED_SIZE, timestampLength);
+        task.message.assign(std::string_view(p + FIXED_SIZE + timestampLength, length - FIXED_SIZE - timestampLength));
+        return true;
+    }
+
+    // 读取 size 字节, 处理部分读取和 EINTR; 返回实际读到的字节数
+    size_t readFully(int fd, char* buf, size_t size, uint64_t offset) {
+        size_t done = 0;
+        while (done < size) {
+            ssize_t n = pread(fd, buf + done, size - done, static_cast<off_t>(offset + done));
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                break;
+            }
+            done += static_cast<size_t>(n);
+        }
+        return done;
+    }
+
+    bool writeFully(int fd, const char* data, size_t size) {
+        while (size > 0) {
+            ssize_t n = write(fd, data, size);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    // 解析 [begin, end) 内的完整记录; 返回最后一条有效记录之后的位置, corrupt 表示遇到损坏记录
+    size_t parseRecords(const char* data, size_t size, std::vector<DBWriteTask>* out, size_t maxCount, bool& corrupt) {
+        size_t pos = 0;
+        corrupt = false;
+        while (pos + HEADER_SIZE <= size && (!out || out->size() < maxCount)) {
+            uint32_t length, crc;
+            std::memcpy(&length, data + pos, 4);
+            std::memcpy(&crc, data + pos + 4, 4);
+            if (length > MAX_RECORD) {
+                corrupt = true;
+                break;
+            }
+            if (pos + HEADER_SIZE + length > size) {
+                break;
+            }
+            const char* payload = data + pos + HEADER_SIZE;
+            if (static_cast<uint32_t>(crc32(0L, reinterpret_cast<const Bytef*>(payload), length)) != crc) {
+                corrupt = true;
+                break;
+            }
+            if (out) {
+                DBWriteTask task;
+                if (!decodeTask(payload, length, task)) {
+                    corrupt = true;
+                    break;
+                }
+                out->push_back(std::move(task));
+            }
+            pos += HEADER_SIZE + length;
+        }
+        return pos;
+    }
+
+    // 扫描整个分段, 返回有效记录的总长度
+    uint64_t validLength(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return 0;
+        }
+        std::string buffer;
+        uint64_t offset = 0;
+        while (true) {
+            buffer.resize(READ_CHUNK);
+            size_t n = readFully(fd, &buffer[0], buffer.size(), offset);
+            if (n >= HEADER_SIZE) {
+                uint32_t length;
+                std::memcpy(&length, buffer.data(), 4);
+                if (length <= MAX_RECORD && HEADER_SIZE + length > n && n == buffer.size()) {
+                    // 单条记录超过一次读取的长度
+                    buffer.resize(HEADER_SIZE + length);
+                    n = readFully(fd, &buffer[0], buffer.size(), offset);
+                }
+            }
+            bool corrupt = false;
+            size_t used = parseRecords(buffer.data(), n, nullptr, 0, corrupt);
+            offset += used;
+            if (used == 0 || corrupt) {
+                break;
+            }
+        }
+        close(fd);
+        return offset;
+    }
+}
+
+WriteSpool::WriteSpool(const SpoolOptions& options)
+    : options_(options), lastSync_(std::chrono::steady_clock::now()) {
+}
+
+WriteSpool::~WriteSpool() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closeSegment();
+    if (readFd_ >= 0) {
+        close(readFd_);
+    }
+    if (checkpointFd_ >= 0) {
+        close(checkpointFd_);
+    }
+}
+
+std::string WriteSpool::segmentPath(uint64_t segment) const {
+    char name[64];
+    snprintf(name, sizeof(name), "%s%012llu%s", SEGMENT_PREFIX, static_cast<unsigned long long>(segment), SEGMENT_SUFFIX);
+    return (fs::path(options_.directory) / name).string();
+}
+
+bool WriteSpool::open() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::error_code ec;
+    fs::create_directories(options_.directory, ec);
+    if (ec) {
+        LogMessage::logMessage(ERROR, "无法创建缓冲目录 %s: %s", options_.directory.c_str(), ec.message().c_str());
+        return false;
+    }
+
+    for (const auto& entry : fs::directory_iterator(options_.directory, ec)) {
+        std::string name = entry.path().filename().string();
+        size_t prefix = strlen(SEGMENT_PREFIX);
+        size_t suffix = strlen(SEGMENT_SUFFIX);
+        if (name.size() > prefix + suffix && name.compare(0, prefix, SEGMENT_PREFIX) == 0 &&
+            name.compare(name.size() - suffix, suffix, SEGMENT_SUFFIX) == 0) {
+            uint64_t segment = std::strtoull(name.c_str() + prefix, nullptr, 10);
+            segments_[segment] = entry.file_size(ec);
+        }
+    }
+
+    // 只有最后一个分段可能在崩溃时留下半条记录
+    if (!segments_.empty()) {
+        auto last = segments_.rbegin();
+        uint64_t valid = validLength(segmentPath(last->first));
+        if (valid < last->second) {
+            LogMessage::logMessage(WARNING, "缓冲分段 %s 末尾有 %llu 字节不完整记录, 已截断",
+                                   segmentPath(last->first).c_str(),
+                                   static_cast<unsigned long long>(last->second - valid));
+            truncate(segmentPath(last->first).c_str(), static_cast<off_t>(valid));
+            last->second = valid;
+        }
+    }
+
+    std::string checkpointPath = (fs::path(options_.directory) / CHECKPOINT_NAME).string();
+    checkpointFd_ = ::open(checkpointPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (checkpointFd_ < 0) {
+        LogMessage::logMessage(ERROR, "无法打开缓冲检查点 %s: %s", checkpointPath.c_str(), strerror(errno));
+        return false;
+    }
+    Position saved;
+    if (readFully(checkpointFd_, reinterpret_cast<char*>(&saved), sizeof(saved), 0) == sizeof(saved)) {
+        committed_ = saved;
+    }
+
+    // 检查点之前的分段已全部写入数据库
+    while (!segments_.empty() && segments_.begin()->first < committed_.segment) {
+        unlink(segmentPath(segments_.begin()->first).c_str());
+        segments_.erase(segments_.begin());
+    }
+    if (segments_.empty() || segments_.begin()->first != committed_.segment) {
+        committed_.segment = segments_.empty() ? committed_.segment : segments_.begin()->first;
+        committed_.offset = 0;
+    }
+
+    // 恢复出的分段都不再追加, 新记录写入新分段
+    uint64_t lastSegment = segments_.empty() ? committed_.segment : segments_.rbegin()->first;
+    writeSegment_ = lastSegment + 1;
+    if (segments_.empty()) {
+        committed_ = Position{writeSegment_, 0};
+    }
+    readEnd_ = committed_;
+
+    uint64_t pending = 0;
+    for (const auto& segment : segments_) {
+        pending += segment.second;
+    }
+    pending -= std::min(pending, committed_.offset);
+    if (pending > 0) {
+        LogMessage::logMessage(INFO, "缓冲目录 %s 中有 %llu 字节待回放", options_.directory.c_str(),
+                               static_cast<unsigned long long>(pending));
+    }
+    return true;
+}
+
+// 调用方需持有 mutex_
+bool WriteSpool::openSegment() {
+    std::string path = segmentPath(writeSegment_);
+    writeFd_ = ::open(path.c_str(), O_CREAT | O_WRONLY | O_APPEND | O_CLOEXEC, 0644);
+    if (writeFd_ < 0) {
+        LogMessage::logMessage(ERROR, "无法打开缓冲分段 %s: %s", path.c_str(), strerror(errno));
+        return false;
+    }
+    segments_.emplace(writeSegment_, 0);
+    return true;
+}
+
+// 调用方需持有 mutex_
+void WriteSpool::closeSegment() {
+    if (writeFd_ >= 0) {
+        syncLocked(true);
+        close(writeFd_);
+        writeFd_ = -1;
+    }
+}
+
+bool WriteSpool::append(const DBWriteTask* tasks, size_t count) {
+    if (count == 0) {
+        return true;
+    }
+    // 序列化在锁外完成, 锁内只有一次顺序写
+    std::string data;
+    bool urgent = false;
+    for (size_t i = 0; i < count; ++i) {
+        encodeTask(tasks[i], data);
+        urgent = urgent || tasks[i].logLevel() >= ERROR;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (writeFd_ < 0 && !openSegment()) {
+        return false;
+    }
+    uint64_t& size = segments_[writeSegment_];
+    if (!writeFully(writeFd_, data.data(), data.size())) {
+        LogMessage::logMessage(ERROR, "写入缓冲分段失败: %s", strerror(errno));
+        // 去掉写了一半的记录, 保证分段中只有完整记录
+        if (ftruncate(writeFd_, static_cast<off_t>(size)) != 0) {
+            closeSegment();
+            ++writeSegment_;
+        }
+        return false;
+    }
+    size += data.size();
+    bytesSinceSync_ += data.size();
+
+    syncLocked(urgent && options_.sync.policy == LogSyncPolicy::ON_ERROR);
+    if (size >= options_.segmentBytes) {
+        closeSegment();
+        ++writeSegment_;
+    }
+    return true;
+}
+
+size_t WriteSpool::read(std::vector<DBWriteTask>& out, size_t maxCount) {
+    Position position;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        position = committed_;
+    }
+
+    size_t begin = out.size();
+    while (out.size() - begin < maxCount) {
+        uint64_t end;
+        bool active;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = segments_.lower_bound(position.segment);
+            if (it == segments_.end()) {
+                break;
+            }
+            if (it->first != position.segment) {
+                position = Position{it->first, 0};
+            }
+            end = it->second;
+            active = position.segment == writeSegment_;
+        }
+
+        if (position.offset >= end) {
+            if (active) {
+                break;
+            }
+            position = Position{position.segment + 1, 0};  // 已封存的分段读完, 转到下一个
+            continue;
+        }
+
+        if (readFdSegment_ != position.segment) {
+            if (readFd_ >= 0) {
+                close(readFd_);
+            }
+            readFd_ = ::open(segmentPath(position.segment).c_str(), O_RDONLY | O_CLOEXEC);
+            readFdSegment_ = position.segment;
+            if (readFd_ < 0) {
+                LogMessage::logMessage(ERROR, "无法读取缓冲分段 %s: %s",
+                                       segmentPath(position.segment).c_str(), strerror(errno));
+                break;
+            }
+        }
+
+        readBuffer_.resize(std::min<uint64_t>(end - position.offset, READ_CHUNK));
+        size_t n = readFully(readFd_, &readBuffer_[0], readBuffer_.size(), position.offset);
+        if (n >= HEADER_SIZE) {
+            uint32_t length;
+            std::memcpy(&length, readBuffer_.data(), 4);
+            if (length <= MAX_RECORD && HEADER_SIZE + length > n && position.offset + HEADER_SIZE + length <= end) {
+                readBuffer_.resize(HEADER_SIZE + length);
+                n = readFully(readFd_, &readBuffer_[0], readBuffer_.size(), position.offset);
+            }
+        }
+
+        bool corrupt = false;
+        size_t used = parseRecords(readBuffer_.data(), n, &out, begin + maxCount, corrupt);
+        position.offset += used;
+        if (corrupt || used == 0) {
+            // 数据在写入后被破坏, 跳过该分段的剩余部分
+            LogMessage::logMessage(ERROR, "缓冲分段 %s 在偏移 %llu 处损坏, 丢弃剩余 %llu 字节",
+                                   segmentPath(position.segment).c_str(),
+                                   static_cast<unsigned long long>(position.offset),
+                                   static_cast<unsigned long long>(end - position.offset));
+            position.offset = end;
+        }
+    }
+
+    readEnd_ = position;
+    return out.size() - begin;
+}
+
+void WriteSpool::commit() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    committed_ = readEnd_;
+
+    // 删除已读完的分段; 当前分段全部确认后也一并删除, 下一条记录写入新分段
+    while (!segments_.empty() && segments_.begin()->first < committed_.segment) {
+        unlink(segmentPath(segments_.begin()->first).c_str());
+        segments_.erase(segments_.begin());
+    }
+    auto active = segments_.find(writeSegment_);
+    if (committed_.segment == writeSegment_ && active != segments_.end() && committed_.offset >= active->second) {
+        if (writeFd_ >= 0) {
+            close(writeFd_);
+            writeFd_ = -1;
+            bytesSinceSync_ = 0;
+        }
+        unlink(segmentPath(writeSegment_).c_str());
+        segments_.erase(active);
+        committed_ = Position{++writeSegment_, 0};
+        readEnd_ = committed_;
+    }
+    writeCheckpoint();
+}
+
+// 检查点只影响重复写入的多少, 不单独刷盘; 调用方需持有 mutex_
+void WriteSpool::writeCheckpoint() {
+    if (checkpointFd_ >= 0 &&
+        pwrite(checkpointFd_, &committed_, sizeof(committed_), 0) != static_cast<ssize_t>(sizeof(committed_))) {
+        LogMessage::logMessage(WARNING, "写入缓冲检查点失败: %s", strerror(errno));
+    }
+}
+
+void WriteSpool::sync(bool force) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    syncLocked(force);
+}
+
+// 调用方需持有 mutex_
+void WriteSpool::syncLocked(bool force) {
+    if (writeFd_ < 0 || bytesSinceSync_ == 0) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    bool needSync = force;
+    switch (options_.sync.policy) {
+        case LogSyncPolicy::NEVER:
+            needSync = false;
+            break;
+        case LogSyncPolicy::EVERY_N_BYTES:
+            needSync = needSync || bytesSinceSync_ >= options_.sync.everyBytes;
+            break;
+        case LogSyncPolicy::INTERVAL:
+            needSync = needSync || now - lastSync_ >= options_.sync.interval;
+            break;
+        case LogSyncPolicy::ON_ERROR:
+            break;
+    }
+    if (!needSync) {
+        return;
+    }
+    fdatasync(writeFd_);
+    bytesSinceSync_ = 0;
+    lastSync_ = now;
+}
+
+uint64_t WriteSpool::pendingBytes() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t pending = 0;
+    for (const auto& segment : segments_) {
+        if (segment.first >= committed_.segment) {
+            pending += segment.second;
+        }
+    }
+    return pending - std::min(pending, committed_.offset);
+}
+
+} // namespace AsyncDBWriterSpace
@@ -0,0 +1,86 @@
+#ifndef __WRITE_SPOOL_HPP__
+#define __WRITE_SPOOL_HPP__
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include "DBWriteTask.hpp"
+#include "../LogMessage/AsyncLogBuffer.hpp"
+
+namespace AsyncDBWriterSpace {
+
+// 本地缓冲文件参数; directory 为空表示不启用
+// 默认按间隔刷盘: 进程崩溃不丢数据, 机器掉电最多丢失最近 interval 内写入的记录
+struct SpoolOptions {
+    std::string                 directory;
+    size_t                      segmentBytes = 64 * 1024 * 1024;    // 单个分段文件写满后换新文件
+    LogSyncOptions              sync{LogSyncPolicy::INTERVAL, 4 * 1024 * 1024, std::chrono::milliseconds(1000)};
+    std::chrono::milliseconds   retryInterval{1000};                // 数据库不可用时的重试间隔
+};
+
+// 数据库写入任务的本地预写缓冲文件 (只追加)
+// 目录下按序号存放分段文件 spool-<序号>.dat, 每条记录为 [长度 u32][CRC32 u32][正文],
+// 正文依次为 level, family, port, address[16], 时间戳长度, 时间戳, 消息, 整数按本机字节序存放;
+// checkpoint 文件记录已确认写入数据库的位置 (分段序号 + 偏移), 重启后从该位置继续回放,
+// 检查点之前的分段整段删除; 检查点滞后时会重复写入少量记录 (至少一次语义)
+// 追加可由多个线程并发调用, 读取/确认只允许回放线程调用
+class WriteSpool {
+public:
+    explicit WriteSpool(const SpoolOptions& options);
+    ~WriteSpool();
+
+    // 创建目录, 恢复已有分段并截断末尾不完整的记录
+    bool open();
+
+    // 顺序追加 count 条任务, 写入失败(如磁盘已满)时返回 false 且不留下残缺记录
+    bool append(const DBWriteTask* tasks, size_t count);
+
+    // 从已确认位置起读取最多 maxCount 条记录, 不移动已确认位置; 再次调用会重新读取同一批
+    size_t read(std::vector<DBWriteTask>& out, size_t maxCount);
+
+    // 确认上一次 read 返回的记录已写入数据库, 推进检查点并删除已读完的分段
+    void commit();
+
+    // 按刷盘策略 fdatasync, force 为 true 时只要有未刷盘数据就刷盘
+    void sync(bool force);
+
+    // 尚未确认的字节数
+    uint64_t pendingBytes();
+
+private:
+    struct Position {
+        uint64_t segment = 0;
+        uint64_t offset = 0;
+    };
+
+    std::string segmentPath(uint64_t segment) const;
+    bool openSegment();
+    void closeSegment();
+    void writeCheckpoint();
+    void syncLocked(bool force);
+
+    const SpoolOptions options_;
+    std::mutex mutex_;
+    std::map<uint64_t, uint64_t> segments_;     // 分段序号 -> 已写入的完整记录字节数
+
+    // 以下成员受 mutex_ 保护
+    int writeFd_ = -1;
+    uint64_t writeSegment_ = 1;                 // 当前追加的分段序号, 对应文件可能尚未创建
+    size_t bytesSinceSync_ = 0;
+    std::chrono::steady_clock::time_point lastSync_;
+    Position committed_;                        // 已确认写入数据库的位置
+
+    // 以下成员只由回放线程访问
+    Position readEnd_;                          // 上一次 read 读到的位置
+    std::string readBuffer_;
+    int readFd_ = -1;
+    uint64_t readFdSegment_ = 0;
+    int checkpointFd_ = -1;
+};
+
+} // namespace AsyncDBWriterSpace
+
+#endif // __WRITE_SPOOL_HPP__
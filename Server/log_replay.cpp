@@ -0,0 +1,227 @@
+// log_replay.cpp
+// 把轮转后的历史日志文件(文本/JSON, 支持 .gz)回放到 log_table
+// 支持两种行格式:
+//   {"level": "INFO", "message": "...", "timestamp": "2025-04-09 15:45:45"}   (Logger 文本输出, timestamp 可选)
+//   <log info>[INFO] {message} at 2025-04-09 15:45:45                         (客户端上报格式)
+// 任务经 AsyncDBWriter 写入, 积压超过阈值后自动切换到 LOAD DATA LOCAL INFILE 批量导入
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "AsyncDBWriter.hpp"
+#include "../LogCompression.hpp"
+
+using namespace AsyncDBWriterSpace;
+
+struct ReplayOptions {
+    std::string ip = "127.0.0.1";
+    int port = 0;
+    int threads = 4;
+    size_t bulkThreshold = BatchOptions().bulkThreshold;
+    size_t bulkBatchSize = BatchOptions().bulkBatchSize;
+    std::vector<std::string> files;
+};
+
+struct ReplayStats {
+    uint64_t lines = 0;
+    uint64_t parsed = 0;
+    uint64_t skipped = 0;
+};
+
+// log_table.level 只接受这几种取值, 其余(如 NORMAL/UNKNOWN)按 INFO 处理
+static std::string normalizeLevel(std::string level) {
+    std::transform(level.begin(), level.end(), level.begin(), ::toupper);
+    static const char* const levels[] = {"TRACE", "DEBUG", "INFO", "WARNING", "ERROR", "FATAL"};
+    for (const char* name : levels) {
+        if (level == name) {
+            return level;
+        }
+    }
+    return "INFO";
+}
+
+// 读取 JSON 字符串字段值, 处理常见转义
+static bool jsonField(const std::string& line, const char* key, std::string& value) {
+    std::string pattern = std::string("\"") + key + "\"";
+    size_t pos = line.find(pattern);
+    if (pos == std::string::npos) {
+        return false;
+    }
+    pos = line.find(':', pos + pattern.size());
+    if (pos == std::string::npos) {
+        return false;
+    }
+    pos = line.find('"', pos + 1);
+    if (pos == std::string::npos) {
+        return false;
+    }
+
+    value.clear();
+    for (size_t i = pos + 1; i < line.size(); ++i) {
+        char c = line[i];
+        if (c == '"') {
+            return true;
+        }
+        if (c == '\\' && i + 1 < line.size()) {
+            char next = line[++i];
+            switch (next) {
+                case 'n': value.push_back('\n'); break;
+                case 't': value.push_back('\t'); break;
+                case 'r': value.push_back('\r'); break;
+                default:  value.push_back(next); break;
+            }
+            continue;
+        }
+        value.push_back(c);
+    }
+    // 未闭合(如消息中含未转义的引号被截断)时取到行尾
+    return true;
+}
+
+// <tag>[LEVEL] {message} at YYYY-MM-DD HH:MM:SS
+static bool parseTextLine(const std::string& line, std::string& level, std::string& message, std::string& timestamp) {
+    size_t tagEnd = line.find('>');
+    if (line.empty() || line[0] != '<' || tagEnd == std::string::npos) {
+        return false;
+    }
+    size_t levelBegin = line.find('[', tagEnd);
+    size_t levelEnd = line.find(']', levelBegin);
+    size_t messageBegin = line.find('{', levelEnd);
+    size_t at = line.rfind("} at ");
+    if (levelBegin == std::string::npos || levelEnd == std::string::npos ||
+        messageBegin == std::string::npos || at == std::string::npos || at < messageBegin) {
+        return false;
+    }
+    level = line.substr(levelBegin + 1, levelEnd - levelBegin - 1);
+    message = line.substr(messageBegin + 1, at - messageBegin - 1);
+    timestamp = line.substr(at + 5);
+    while (!timestamp.empty() && (timestamp.back() == '\r' || timestamp.back() == ' ')) {
+        timestamp.pop_back();
+    }
+    return true;
+}
+
+static void replayLine(const std::string& line, const ReplayOptions& options, ReplayStats& stats) {
+    ++stats.lines;
+    std::string level, message, timestamp;
+    bool ok = false;
+    if (!line.empty() && line[0] == '{') {
+        ok = jsonField(line, "level", level) && jsonField(line, "message", message);
+        if (ok && !jsonField(line, "timestamp", timestamp)) {
+            timestamp.clear();
+        }
+    } else {
+        ok = parseTextLine(line, level, message, timestamp);
+    }
+
+    if (!ok) {
+        ++stats.skipped;
+        return;
+    }
+    ++stats.parsed;
+    AsyncDBWriter::getInstance().addTask(DBWriteTask(normalizeLevel(level), options.ip, options.port, message, timestamp));
+}
+
+static bool replayFile(const std::string& path, const ReplayOptions& options, ReplayStats& stats) {
+    if (LogCompression::isCompressed(path)) {
+        // 流式解压, 按行切分; 跨块的半行留到下一块拼接
+        std::string pending;
+        bool ok = LogCompression::decompressStream(path, [&](const char* data, size_t size) {
+            pending.append(data, size);
+            size_t begin = 0;
+            size_t end;
+            while ((end = pending.find('\n', begin)) != std::string::npos) {
+                replayLine(pending.substr(begin, end - begin), options, stats);
+                begin = end + 1;
+            }
+            pending.erase(0, begin);
+            return true;
+        });
+        if (!pending.empty()) {
+            replayLine(pending, options, stats);
+        }
+        return ok;
+    }
+
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        replayLine(line, options, stats);
+    }
+    return true;
+}
+
+static void usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [--ip IP] [--port PORT] [--threads N] [--bulk-threshold N]"
+              << " [--bulk-batch N] <log_file>..." << std::endl;
+    std::cerr << "  数据库连接参数从环境变量读取 (见 EnvConfig)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    ReplayOptions options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--ip" && hasValue) {
+            options.ip = argv[++i];
+        } else if (arg == "--port" && hasValue) {
+            options.port = std::stoi(argv[++i]);
+        } else if (arg == "--threads" && hasValue) {
+            options.threads = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--bulk-threshold" && hasValue) {
+            options.bulkThreshold = std::stoul(argv[++i]);
+        } else if (arg == "--bulk-batch" && hasValue) {
+            options.bulkBatchSize = std::stoul(argv[++i]);
+        } else if (!arg.empty() && arg[0] == '-') {
+            usage(argv[0]);
+            return 1;
+        } else {
+            options.files.push_back(arg);
+        }
+    }
+    if (options.files.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (!SqlConnPool::getInstance()->init("", "", "", "", 0, options.threads)) {
+        std::cerr << "数据库连接池初始化失败" << std::endl;
+        return 1;
+    }
+
+    AsyncDBWriter& writer = AsyncDBWriter::getInstance();
+    // 回放时不丢弃任何日志, 队列满了就等待
+    OverloadPolicy policy;
+    for (auto& action : policy.actions) {
+        action = OverloadAction::BLOCK;
+    }
+    writer.setOverloadPolicy(policy);
+
+    BatchOptions batchOptions;
+    batchOptions.bulkThreshold = options.bulkThreshold;
+    batchOptions.bulkBatchSize = options.bulkBatchSize;
+    writer.setBatchOptions(batchOptions);
+    writer.start(options.threads);
+
+    auto start = std::chrono::steady_clock::now();
+    ReplayStats stats;
+    for (const auto& file : options.files) {
+        std::cout << "回放 " << file << " ..." << std::endl;
+        if (!replayFile(file, options, stats)) {
+            std::cerr << "读取失败: " << file << std::endl;
+        }
+    }
+    writer.shutdown();
+    auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "读取 " << stats.lines << " 行, 解析 " << stats.parsed << " 行, 跳过 " << stats.skipped << " 行" << std::endl;
+    std::cout << "写入 " << writer.getWrittenRows() << " 行 (其中 LOAD DATA 导入 " << writer.getBulkLoadedRows()
+              << " 行), 失败 " << writer.getFailedRows() << " 行, 用时 " << seconds << " 秒, "
+              << (seconds > 0 ? writer.getWrittenRows() / seconds : 0) << " 行/秒" << std::endl;
+    return writer.getFailedRows() == 0 ? 0 : 2;
+}
@@ -22,4 +22,7 @@ for threads in "${THREAD_COUNTS[@]}"; do
     sleep 5  # 缓冲时间
 done
 
+echo "=== 批量写入对比测试 ==="
+./test_log_throughput compare 8 $LOGS_PER_THREAD 256 > ./pressure_test_results/batch_compare.txt
+
 echo "压力测试完成，结果已保存到 ./pressure_test_results/ 目录"
\ No newline at end of file
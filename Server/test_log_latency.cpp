@@ -19,7 +19,7 @@ void test_latency(bool async_mode, int iterations) {
             // 由于异步，我们需要特别标记以知道何时完成
             // 这里使用一个特殊的回调机制或共享状态来检测
             // 这里简化为直接测量提交时间
-            AsyncDBWriter::getInstance().addTask(task);
+            AsyncDBWriter::getInstance().addTask(std::move(task));
         } else {
             SyncDBWriter::writeLog(task);
         }
@@ -4,6 +4,7 @@
 #include <thread>
 #include <vector>
 #include <atomic>
+#include <algorithm>
 #include "AsyncDBWriter.hpp"
 
 using namespace AsyncDBWriterSpace;
@@ -13,7 +14,7 @@ void async_writer_test(int log_count) {
     for (int i = 0; i < log_count; i++) {
         DBWriteTask task("INFO", "192.168.1.1", 8080, 
                                 "Test log message " + std::to_string(i));
-        AsyncDBWriter::getInstance().addTask(task);
+        AsyncDBWriter::getInstance().addTask(std::move(task));
     }
     completed++;
 }
@@ -27,52 +28,78 @@ void sync_writer_test(int log_count) {
     completed++;
 }
 
+// 以指定批量大小运行一次异步写入, 返回吞吐量(条/秒)
+double run_async(int thread_count, int logs_per_thread, size_t batch_size) {
+    AsyncDBWriter& writer = AsyncDBWriter::getInstance();
+    BatchOptions options;
+    options.maxBatchSize = batch_size;
+    writer.setBatchOptions(options);
+
+    uint64_t total = static_cast<uint64_t>(thread_count) * logs_per_thread;
+    uint64_t baseFailed = writer.getFailedRows();
+    uint64_t baseRows = writer.getWrittenRows() + baseFailed;
+    uint64_t baseBatches = writer.getBatchCount();
+    writer.start(40); // 启动40个工作线程
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // 创建多个生产者线程
+    std::vector<std::thread> threads;
+    for (int i = 0; i < thread_count; i++) {
+        threads.emplace_back(async_writer_test, logs_per_thread);
+    }
+
+    // 等待所有线程完成
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    // 确保所有日志都被写入数据库(包括工作线程手中尚未提交的批次)
+    while (writer.getWrittenRows() + writer.getFailedRows() - baseRows < total) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::max<long long>(1, std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
+    writer.shutdown();
+
+    uint64_t batches = std::max<uint64_t>(1, writer.getBatchCount() - baseBatches);
+    double throughput = total * 1000.0 / duration;
+    std::cout << "异步模式(批量 " << batch_size << "): 处理 " << total << " 条日志用时 "
+              << duration << " ms, 平均每批 " << (total / batches) << " 条, 失败 "
+              << (writer.getFailedRows() - baseFailed) << " 条" << std::endl;
+    std::cout << "吞吐量: " << throughput << " 条/秒" << std::endl;
+    return throughput;
+}
+
 int main(int argc, char* argv[]) {
     if (argc < 4) {
-        std::cerr << "Usage: " << argv[0] << " [async|sync] <threads> <logs_per_thread>" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " [async|sync|compare] <threads> <logs_per_thread> [batch_size]" << std::endl;
+        std::cerr << "  compare: 依次以逐条写入(批量 1)和批量写入运行异步模式, 输出吞吐量提升倍数" << std::endl;
         return 1;
     }
     
     std::string mode = argv[1];
     int thread_count = std::stoi(argv[2]);
     int logs_per_thread = std::stoi(argv[3]);
+    size_t batch_size = argc > 4 ? std::stoul(argv[4]) : BatchOptions().maxBatchSize;
+
+    // 压测时所有等级都阻塞等待, 不因过载丢弃任务
+    OverloadPolicy policy;
+    for (auto& action : policy.actions) {
+        action = OverloadAction::BLOCK;
+    }
+    AsyncDBWriter::getInstance().setOverloadPolicy(policy);
     
     std::vector<std::thread> threads;
     
     if (mode == "async") {
-        AsyncDBWriter::getInstance().start(40); // 启动4个工作线程
-        
-        auto start = std::chrono::high_resolution_clock::now();
-        
-        // 创建多个生产者线程
-        for (int i = 0; i < thread_count; i++) {
-            threads.emplace_back(async_writer_test, logs_per_thread);
-        }
-        
-        // 等待所有线程完成
-        for (auto& t : threads) {
-            t.join();
-        }
-        
-        // 确保所有日志都被处理完
-        while (true) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            
-            // 通过检查队列大小判断是否处理完成
-            if (AsyncDBWriter::getInstance().getQueueSize() == 0) {
-                break;
-            }
-        }
-        
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-        
-        std::cout << "异步模式: 处理 " << thread_count * logs_per_thread << " 条日志用时 " 
-                  << duration << " ms" << std::endl;
-        std::cout << "吞吐量: " << (thread_count * logs_per_thread * 1000.0 / duration) 
-                  << " 条/秒" << std::endl;
-                  
-        AsyncDBWriter::getInstance().shutdown();
+        run_async(thread_count, logs_per_thread, batch_size);
+    }
+    else if (mode == "compare") {
+        double single = run_async(thread_count, logs_per_thread, 1);
+        double batched = run_async(thread_count, logs_per_thread, batch_size);
+        std::cout << "批量写入吞吐量提升: " << (batched / single) << " 倍" << std::endl;
     }
     else if (mode == "sync") {
         auto start = std::chrono::high_resolution_clock::now();
@@ -97,4 +124,4 @@ int main(int argc, char* argv[]) {
     }
     
     return 0;
-}
\ No newline at end of file
+}
@@ -35,11 +35,51 @@ std::string EnvConfig::getDBName() {
     return getEnvVar("DB_NAME", "logging_db");
 }
 
+std::string EnvConfig::getDBSpoolDir() {
+    return getEnvVar("DB_SPOOL_DIR", "db_spool");
+}
+
+std::string EnvConfig::getDBPartitionUnit() {
+    return getEnvVar("DB_PARTITION_UNIT", "day");
+}
+
+int EnvConfig::getDBPartitionRetention() {
+    return getEnvVarInt("DB_PARTITION_RETENTION", 30);
+}
+
+int EnvConfig::getDBPoolMin() {
+    return getEnvVarInt("DB_POOL_MIN", 2);
+}
+
+int EnvConfig::getDBPoolMax() {
+    return getEnvVarInt("DB_POOL_MAX", 0);
+}
+
+int EnvConfig::getDBPoolTimeoutMs() {
+    return getEnvVarInt("DB_POOL_TIMEOUT_MS", 3000);
+}
+
 // 应用配置相关实现
 int EnvConfig::getAppPort() {
     return getEnvVarInt("APP_PORT", 8080);
 }
 
+int EnvConfig::getWebReactorThreads() {
+    return getEnvVarInt("WEB_REACTOR_THREADS", 0);
+}
+
+std::string EnvConfig::getIngestLogVerbosity() {
+    return getEnvVar("INGEST_LOG_VERBOSITY", "summary");
+}
+
+int EnvConfig::getIngestLogSampleRate() {
+    return getEnvVarInt("INGEST_LOG_SAMPLE_RATE", 20);
+}
+
+int EnvConfig::getIngestStatsInterval() {
+    return getEnvVarInt("INGEST_STATS_INTERVAL", 10);
+}
+
 std::string EnvConfig::getLogLevel() {
     return getEnvVar("LOG_LEVEL", "INFO");
 }
@@ -77,6 +117,15 @@ void EnvConfig::printConfig() {
     std::cout << "  - 端口 (DB_PORT): " << getDBPort() << std::endl;
     std::cout << "  - 用户 (DB_USER): " << getDBUser() << std::endl;
     std::cout << "  - 数据库 (DB_NAME): " << getDBName() << std::endl;
+    std::cout << "  - 本地缓冲目录 (DB_SPOOL_DIR): " << getDBSpoolDir() << std::endl;
+    std::cout << "  - 分区粒度 (DB_PARTITION_UNIT): " << getDBPartitionUnit() << std::endl;
+    std::cout << "  - 分区保留数 (DB_PARTITION_RETENTION): " << getDBPartitionRetention() << std::endl;
+    std::cout << "  - 连接池 (DB_POOL_MIN / DB_POOL_MAX / DB_POOL_TIMEOUT_MS): " << getDBPoolMin() << " / "
+              << getDBPoolMax() << " / " << getDBPoolTimeoutMs() << " 毫秒" << std::endl;
     std::cout << "  - 应用端口 (APP_PORT): " << getAppPort() << std::endl;
+    std::cout << "  - 事件循环线程 (WEB_REACTOR_THREADS): " << getWebReactorThreads() << std::endl;
+    std::cout << "  - 摄入输出级别 (INGEST_LOG_VERBOSITY): " << getIngestLogVerbosity() << std::endl;
+    std::cout << "  - 摄入采样上限 (INGEST_LOG_SAMPLE_RATE): " << getIngestLogSampleRate() << " 条/秒" << std::endl;
+    std::cout << "  - 摄入汇总间隔 (INGEST_STATS_INTERVAL): " << getIngestStatsInterval() << " 秒" << std::endl;
     std::cout << "  - 日志级别 (LOG_LEVEL): " << getLogLevel() << std::endl;
 }
\ No newline at end of file
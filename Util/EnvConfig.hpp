@@ -17,9 +17,19 @@ public:
     static std::string getDBUser();
     static std::string getDBPassword();
     static std::string getDBName();
+    static std::string getDBSpoolDir();     // 数据库不可用时的本地缓冲目录, 为空表示不启用
+    static std::string getDBPartitionUnit();    // log_table 分区粒度: day / hour / none
+    static int getDBPartitionRetention();       // 保留的分区单位数, <= 0 表示不删除
+    static int getDBPoolMin();              // 连接池常驻连接数
+    static int getDBPoolMax();              // 连接池连接数上限, <= 0 表示使用启动参数中的连接数
+    static int getDBPoolTimeoutMs();        // 获取连接的最长等待时间(毫秒)
     
     // 应用配置相关
     static int getAppPort();
+    static int getWebReactorThreads();      // webserver 事件循环线程数, 0 表示按 CPU 核数
+    static std::string getIngestLogVerbosity(); // 日志服务器逐条输出级别: quiet / summary / sampled / verbose
+    static int getIngestLogSampleRate();        // sampled 级别下每秒最多打印的逐条事件数
+    static int getIngestStatsInterval();        // 摄入汇总的打印间隔(秒)
     static std::string getLogLevel();
     
     // 验证必需的环境变量
@@ -0,0 +1,162 @@
+#ifndef __INGEST_PROTOCOL_HPP__
+#define __INGEST_PROTOCOL_HPP__
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// 客户端与日志服务器之间的分帧协议
+// 每帧: 1 字节类型 + 4 字节负载长度(大端) + 负载
+//   LOG   一条日志
+//   BATCH 4 字节条数, 之后每条为 4 字节长度 + 内容
+//   ACK   (服务器 -> 客户端) 8 字节, 本连接累计已处理的日志条数
+// 客户端不必等待确认即可连续发送; 服务器每处理完一轮读到的数据回一次累计确认
+// 类型字节不是可打印字符, 服务器据此区分旧客户端直接发送的文本日志
+namespace IngestProtocol {
+
+    enum FrameType : uint8_t {
+        LOG   = 0x01,
+        BATCH = 0x02,
+        ACK   = 0x81
+    };
+
+    static const size_t   HEADER_SIZE   = 5;
+    static const uint32_t MAX_PAYLOAD   = 4 * 1024 * 1024;   // 超过视为协议错误, 断开连接
+
+    struct Frame {
+        uint8_t     type = 0;
+        std::string payload;
+    };
+
+    inline bool isFrameType(uint8_t type) {
+        return type == LOG || type == BATCH || type == ACK;
+    }
+
+    inline void putUint32(std::string& out, uint32_t value) {
+        out.push_back(static_cast<char>((value >> 24) & 0xFF));
+        out.push_back(static_cast<char>((value >> 16) & 0xFF));
+        out.push_back(static_cast<char>((value >> 8) & 0xFF));
+        out.push_back(static_cast<char>(value & 0xFF));
+    }
+
+    inline uint32_t getUint32(const char* data) {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+        return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+    }
+
+    inline std::string encodeFrame(uint8_t type, const std::string& payload) {
+        std::string frame;
+        frame.reserve(HEADER_SIZE + payload.size());
+        frame.push_back(static_cast<char>(type));
+        putUint32(frame, static_cast<uint32_t>(payload.size()));
+        frame += payload;
+        return frame;
+    }
+
+    inline std::string encodeLog(const std::string& line) {
+        return encodeFrame(LOG, line);
+    }
+
+    inline std::string encodeBatch(const std::vector<std::string>& lines) {
+        std::string payload;
+        size_t size = 4;
+        for (const auto& line : lines) {
+            size += 4 + line.size();
+        }
+        payload.reserve(size);
+        putUint32(payload, static_cast<uint32_t>(lines.size()));
+        for (const auto& line : lines) {
+            putUint32(payload, static_cast<uint32_t>(line.size()));
+            payload += line;
+        }
+        return encodeFrame(BATCH, payload);
+    }
+
+    inline std::string encodeAck(uint64_t count) {
+        std::string payload;
+        putUint32(payload, static_cast<uint32_t>(count >> 32));
+        putUint32(payload, static_cast<uint32_t>(count & 0xFFFFFFFF));
+        return encodeFrame(ACK, payload);
+    }
+
+    inline bool decodeAck(const Frame& frame, uint64_t& count) {
+        if (frame.type != ACK || frame.payload.size() != 8) {
+            return false;
+        }
+        count = (uint64_t(getUint32(frame.payload.data())) << 32) | getUint32(frame.payload.data() + 4);
+        return true;
+    }
+
+    // 依次取出 BATCH 负载中的每条日志, 格式错误返回 false
+    template<typename Fn>
+    bool forEachRecord(const std::string& payload, Fn fn) {
+        if (payload.size() < 4) {
+            return false;
+        }
+        uint32_t count = getUint32(payload.data());
+        size_t offset = 4;
+        for (uint32_t i = 0; i < count; ++i) {
+            if (payload.size() - offset < 4) {
+                return false;
+            }
+            uint32_t length = getUint32(payload.data() + offset);
+            offset += 4;
+            if (payload.size() - offset < length) {
+                return false;
+            }
+            fn(payload.data() + offset, static_cast<size_t>(length));
+            offset += length;
+        }
+        return offset == payload.size();
+    }
+
+    // 把按任意边界到达的字节流还原成帧: feed 追加数据, next 取出下一个完整帧
+    class FrameDecoder {
+    public:
+        void feed(const char* data, size_t size) {
+            _buffer.append(data, size);
+        }
+
+        // 没有完整帧时返回 false; 遇到非法帧后 error() 为 true, 之后的数据不再解析
+        bool next(Frame& frame) {
+            if (_error || _buffer.size() - _offset < HEADER_SIZE) {
+                compact();
+                return false;
+            }
+            const char* header = _buffer.data() + _offset;
+            uint8_t type = static_cast<uint8_t>(header[0]);
+            uint32_t length = getUint32(header + 1);
+            if (!isFrameType(type) || length > MAX_PAYLOAD) {
+                _error = true;
+                return false;
+            }
+            if (_buffer.size() - _offset - HEADER_SIZE < length) {
+                compact();
+                return false;
+            }
+            frame.type = type;
+            frame.payload.assign(header + HEADER_SIZE, length);
+            _offset += HEADER_SIZE + length;
+            return true;
+        }
+
+        bool error() const { return _error; }
+        size_t buffered() const { return _buffer.size() - _offset; }
+
+    private:
+        // 已取出的帧占用的前缀一次性丢弃, 避免每帧都移动剩余数据
+        void compact() {
+            if (_offset > 0) {
+                _buffer.erase(0, _offset);
+                _offset = 0;
+            }
+        }
+
+        std::string _buffer;
+        size_t      _offset = 0;
+        bool        _error = false;
+    };
+}
+
+#endif // __INGEST_PROTOCOL_HPP__
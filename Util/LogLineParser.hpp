@@ -0,0 +1,203 @@
+#ifndef __LOG_LINE_PARSER_HPP__
+#define __LOG_LINE_PARSER_HPP__
+
+#include <string_view>
+#include <cstring>
+
+// 单遍解析客户端上报的日志行, 代替每条消息都要走一遍的 std::regex
+// 字段是指向原始行的 string_view, 不分配内存, 行的生命周期需覆盖字段的使用
+// 分隔符用 memchr 查找(glibc 的实现是向量化的), 匹配结果与原来的正则表达式一致
+namespace LogLineParser {
+
+    struct LogLine {
+        std::string_view logClass;
+        std::string_view level;
+        std::string_view message;
+        std::string_view timestamp;
+    };
+
+    namespace Detail {
+        // 与正则表达式中的 \s 相同
+        inline bool isSpace(char c) {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+        }
+
+        inline bool isDigit(char c) {
+            return c >= '0' && c <= '9';
+        }
+
+        inline bool isWord(char c) {
+            return isDigit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+        }
+
+        // 从 pos 起查找 c, 找不到返回 npos
+        inline size_t find(std::string_view s, char c, size_t pos) {
+            if (pos >= s.size()) {
+                return std::string_view::npos;
+            }
+            const void* hit = std::memchr(s.data() + pos, c, s.size() - pos);
+            return hit ? static_cast<const char*>(hit) - s.data() : std::string_view::npos;
+        }
+
+        // 正则中的 . 不匹配换行, 消息不能跨过 \n 或 \r
+        inline size_t lineEnd(std::string_view s, size_t pos) {
+            size_t newline = find(s, '\n', pos);
+            size_t carriage = find(s, '\r', pos);
+            size_t end = newline < carriage ? newline : carriage;
+            return end == std::string_view::npos ? s.size() : end;
+        }
+
+        inline size_t skipSpaces(std::string_view s, size_t pos) {
+            while (pos < s.size() && isSpace(s[pos])) {
+                ++pos;
+            }
+            return pos;
+        }
+
+        // \s+at\s+, 成功时返回其后的位置, 失败返回 npos
+        inline size_t matchAt(std::string_view s, size_t pos) {
+            size_t next = skipSpaces(s, pos);
+            if (next == pos || s.compare(next, 2, "at") != 0) {
+                return std::string_view::npos;
+            }
+            pos = next + 2;
+            next = skipSpaces(s, pos);
+            return next == pos ? std::string_view::npos : next;
+        }
+
+        // [\d-]+\s[\d:]+
+        inline bool matchLooseTimestamp(std::string_view s, size_t pos, std::string_view& out) {
+            size_t end = pos;
+            while (end < s.size() && (isDigit(s[end]) || s[end] == '-')) {
+                ++end;
+            }
+            if (end == pos || end >= s.size() || !isSpace(s[end])) {
+                return false;
+            }
+            size_t time = ++end;
+            while (end < s.size() && (isDigit(s[end]) || s[end] == ':')) {
+                ++end;
+            }
+            if (end == time) {
+                return false;
+            }
+            out = s.substr(pos, end - pos);
+            return true;
+        }
+
+        // \d{4}-\d{2}-\d{2} \d{2}:\d{2}:\d{2}
+        inline bool matchStrictTimestamp(std::string_view s, size_t pos, std::string_view& out) {
+            static const char layout[] = "dddd-dd-dd dd:dd:dd";
+            const size_t length = sizeof(layout) - 1;
+            if (s.size() - pos < length) {
+                return false;
+            }
+            for (size_t i = 0; i < length; ++i) {
+                char c = s[pos + i];
+                if (layout[i] == 'd' ? !isDigit(c) : c != layout[i]) {
+                    return false;
+                }
+            }
+            out = s.substr(pos, length);
+            return true;
+        }
+
+        // 在 start 处匹配 <class>[LEVEL]\s+{message}\s+at\s+timestamp
+        inline bool matchIngestAt(std::string_view s, size_t start, LogLine& out) {
+            size_t classEnd = find(s, '>', start + 1);
+            if (classEnd == std::string_view::npos || classEnd == start + 1) {
+                return false;
+            }
+            size_t levelStart = classEnd + 1;
+            if (levelStart >= s.size() || s[levelStart] != '[') {
+                return false;
+            }
+            ++levelStart;
+            size_t levelEnd = find(s, ']', levelStart);
+            if (levelEnd == std::string_view::npos || levelEnd == levelStart) {
+                return false;
+            }
+            size_t brace = skipSpaces(s, levelEnd + 1);
+            if (brace == levelEnd + 1 || brace >= s.size() || s[brace] != '{') {
+                return false;
+            }
+            // 消息是非贪婪匹配: 取第一个后面能接上 " at 时间戳" 的 '}'
+            size_t messageStart = brace + 1;
+            size_t limit = lineEnd(s, messageStart);
+            for (size_t close = find(s, '}', messageStart); close < limit; close = find(s, '}', close + 1)) {
+                size_t stamp = matchAt(s, close + 1);
+                if (stamp != std::string_view::npos && matchLooseTimestamp(s, stamp, out.timestamp)) {
+                    out.logClass = s.substr(start + 1, classEnd - start - 1);
+                    out.level = s.substr(levelStart, levelEnd - levelStart);
+                    out.message = s.substr(messageStart, close - messageStart);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // 在 start(class=' 之后)处匹配 class'>[LEVEL]\s+message\s+at\s+timestamp
+        inline bool matchHtmlAt(std::string_view s, size_t start, LogLine& out) {
+            size_t classEnd = find(s, '\'', start);
+            if (classEnd == std::string_view::npos || classEnd == start) {
+                return false;
+            }
+            if (s.compare(classEnd, 3, "'>[") != 0) {
+                return false;
+            }
+            size_t levelStart = classEnd + 3;
+            size_t levelEnd = levelStart;
+            while (levelEnd < s.size() && isWord(s[levelEnd])) {
+                ++levelEnd;
+            }
+            if (levelEnd == levelStart || levelEnd >= s.size() || s[levelEnd] != ']') {
+                return false;
+            }
+            size_t messageStart = skipSpaces(s, levelEnd + 1);
+            if (messageStart == levelEnd + 1) {
+                return false;
+            }
+            // 非贪婪: 取第一个后面是 " at 时间戳" 的空白
+            for (size_t end = messageStart; end < s.size(); ++end) {
+                if (!isSpace(s[end])) {
+                    continue;
+                }
+                size_t stamp = matchAt(s, end);
+                if (stamp != std::string_view::npos && matchStrictTimestamp(s, stamp, out.timestamp)) {
+                    out.logClass = s.substr(start, classEnd - start);
+                    out.level = s.substr(levelStart, levelEnd - levelStart);
+                    out.message = s.substr(messageStart, end - messageStart);
+                    return true;
+                }
+                if (s[end] == '\n' || s[end] == '\r') {
+                    break;
+                }
+            }
+            return false;
+        }
+    }
+
+    // 服务器收到的日志: <class>[LEVEL] {message} at 2025-04-09 15:45:45, 行内任意位置均可
+    inline bool parseIngestLine(std::string_view line, LogLine& out) {
+        for (size_t start = Detail::find(line, '<', 0); start != std::string_view::npos;
+             start = Detail::find(line, '<', start + 1)) {
+            if (Detail::matchIngestAt(line, start, out)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Logger 输出的 HTML 行: <div class='log info'>[INFO] message at 2025-04-09 15:45:45</div>
+    inline bool parseHtmlLine(std::string_view line, LogLine& out) {
+        static const std::string_view marker = "class='";
+        for (size_t pos = line.find(marker); pos != std::string_view::npos; pos = line.find(marker, pos + 1)) {
+            if (Detail::matchHtmlAt(line, pos + marker.size(), out)) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+#endif // __LOG_LINE_PARSER_HPP__
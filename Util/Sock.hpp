@@ -9,10 +9,12 @@
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <cstdlib>
+#include <cerrno>
+#include <fcntl.h>
 
 class Sock
 {
-    const static int backlog = 5;
+    const static int backlog = SOMAXCONN;
 public:
     Sock() = default;
     ~Sock() = default;
@@ -33,6 +35,24 @@ public:
         return fd;
     }
 
+    // 多个套接字绑定同一端口, 由内核把新连接分散到各个监听套接字; 需在 Bind 之前设置
+    static bool SetReusePort(int fd)
+    {
+        int opt = 1;
+        if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0)
+        {
+            std::cerr << "setsockopt SO_REUSEPORT error: " << strerror(errno) << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    static bool SetNonBlock(int fd)
+    {
+        int flags = fcntl(fd, F_GETFL, 0);
+        return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+
     static void Bind(int fd, int port)
     {
         struct sockaddr_in addr;
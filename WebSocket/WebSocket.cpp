@@ -31,14 +31,6 @@ std::vector<std::map<std::string, std::string>> fetchLogsFromDatabase(int limit,
     mysql_query(conn, "SET SESSION TRANSACTION ISOLATION LEVEL READ COMMITTED");
     mysql_query(conn, "START TRANSACTION");
     
-    // 使用预处理语句防止SQL注入并支持事务
-    MYSQL_STMT *stmt = mysql_stmt_init(conn);
-    if (!stmt) {
-        mysql_rollback(conn);
-        std::cerr << "mysql_stmt_init failed: " << mysql_error(conn) << std::endl;
-        return logs;
-    }
-    
     // 构建安全的SQL查询
     std::string sql;
     int paramCount = 2; // offset 和 limit
@@ -52,10 +44,11 @@ std::vector<std::map<std::string, std::string>> fetchLogsFromDatabase(int limit,
               "FROM log_table ORDER BY timestamp DESC LIMIT ?, ?";
     }
     
-    if (mysql_stmt_prepare(stmt, sql.c_str(), sql.length())) {
+    // 使用连接上缓存的预处理语句防止SQL注入并支持事务
+    MYSQL_STMT *stmt = connRAII.prepare(sql);
+    if (!stmt) {
         mysql_rollback(conn);
-        mysql_stmt_close(stmt);
-        std::cerr << "mysql_stmt_prepare failed: " << mysql_stmt_error(stmt) << std::endl;
+        std::cerr << "mysql_stmt_prepare failed: " << mysql_error(conn) << std::endl;
         return logs;
     }
     
@@ -84,16 +77,16 @@ std::vector<std::map<std::string, std::string>> fetchLogsFromDatabase(int limit,
     
     if (mysql_stmt_bind_param(stmt, bind)) {
         mysql_rollback(conn);
-        mysql_stmt_close(stmt);
         std::cerr << "mysql_stmt_bind_param failed: " << mysql_stmt_error(stmt) << std::endl;
+        connRAII.invalidate(sql);
         return logs;
     }
     
     // 执行查询
     if (mysql_stmt_execute(stmt)) {
         mysql_rollback(conn);
-        mysql_stmt_close(stmt);
         std::cerr << "mysql_stmt_execute failed: " << mysql_stmt_error(stmt) << std::endl;
+        connRAII.invalidate(sql);
         return logs;
     }
     
@@ -101,8 +94,8 @@ std::vector<std::map<std::string, std::string>> fetchLogsFromDatabase(int limit,
     MYSQL_RES* result = mysql_stmt_result_metadata(stmt);
     if (!result) {
         mysql_rollback(conn);
-        mysql_stmt_close(stmt);
         std::cerr << "mysql_stmt_result_metadata failed: " << mysql_stmt_error(stmt) << std::endl;
+        connRAII.invalidate(sql);
         return logs;
     }
     
@@ -135,8 +128,8 @@ std::vector<std::map<std::string, std::string>> fetchLogsFromDatabase(int limit,
     if (mysql_stmt_bind_result(stmt, resultBind)) {
         mysql_rollback(conn);
         mysql_free_result(result);
-        mysql_stmt_close(stmt);
         std::cerr << "mysql_stmt_bind_result failed: " << mysql_stmt_error(stmt) << std::endl;
+        connRAII.invalidate(sql);
         return logs;
     }
     
@@ -150,6 +143,7 @@ std::vector<std::map<std::string, std::string>> fetchLogsFromDatabase(int limit,
         
         logs.push_back(log_entry);
     }
+    mysql_stmt_free_result(stmt);
 
     // 提交读事务
     if (mysql_commit(conn) != 0) {
@@ -158,7 +152,6 @@ std::vector<std::map<std::string, std::string>> fetchLogsFromDatabase(int limit,
     }
     
     mysql_free_result(result);
-    mysql_stmt_close(stmt);
     
     return logs;
 }
@@ -181,25 +174,18 @@ int getTotalLogsCount() {
     mysql_query(conn, "START TRANSACTION");
     
     // 使用预处理语句
-    MYSQL_STMT *stmt = mysql_stmt_init(conn);
+    static const std::string sql = "SELECT COUNT(*) FROM log_table";
+    MYSQL_STMT *stmt = connRAII.prepare(sql);
     if (!stmt) {
         mysql_rollback(conn);
-        std::cerr << "mysql_stmt_init failed: " << mysql_error(conn) << std::endl;
-        return 0;
-    }
-    
-    const char* sql = "SELECT COUNT(*) FROM log_table";
-    if (mysql_stmt_prepare(stmt, sql, strlen(sql))) {
-        mysql_rollback(conn);
-        mysql_stmt_close(stmt);
-        std::cerr << "mysql_stmt_prepare failed: " << mysql_stmt_error(stmt) << std::endl;
+        std::cerr << "mysql_stmt_prepare failed: " << mysql_error(conn) << std::endl;
         return 0;
     }
     
     if (mysql_stmt_execute(stmt)) {
         mysql_rollback(conn);
-        mysql_stmt_close(stmt);
         std::cerr << "mysql_stmt_execute failed: " << mysql_stmt_error(stmt) << std::endl;
+        connRAII.invalidate(sql);
         return 0;
     }
     
@@ -212,8 +198,8 @@ int getTotalLogsCount() {
     
     if (mysql_stmt_bind_result(stmt, resultBind)) {
         mysql_rollback(conn);
-        mysql_stmt_close(stmt);
         std::cerr << "mysql_stmt_bind_result failed: " << mysql_stmt_error(stmt) << std::endl;
+        connRAII.invalidate(sql);
         return 0;
     }
     
@@ -221,9 +207,9 @@ int getTotalLogsCount() {
         // count 已经被填充
     }
     
-    // 提交读事务
+    // 释放结果集(语句句柄留在连接上复用), 然后提交读事务
+    mysql_stmt_free_result(stmt);
     mysql_commit(conn);
-    mysql_stmt_close(stmt);
     
     return count;
 }
@@ -246,18 +232,11 @@ int getLogCountByLevel(const std::string& level) {
     mysql_query(conn, "START TRANSACTION");
     
     //  使用预处理语句防止SQL注入
-    MYSQL_STMT *stmt = mysql_stmt_init(conn);
+    static const std::string sql = "SELECT COUNT(*) FROM log_table WHERE level = ?";
+    MYSQL_STMT *stmt = connRAII.prepare(sql);
     if (!stmt) {
         mysql_rollback(conn);
-        std::cerr << "mysql_stmt_init failed: " << mysql_error(conn) << std::endl;
-        return 0;
-    }
-    
-    const char* sql = "SELECT COUNT(*) FROM log_table WHERE level = ?";
-    if (mysql_stmt_prepare(stmt, sql, strlen(sql))) {
-        mysql_rollback(conn);
-        mysql_stmt_close(stmt);
-        std::cerr << "mysql_stmt_prepare failed: " << mysql_stmt_error(stmt) << std::endl;
+        std::cerr << "mysql_stmt_prepare failed: " << mysql_error(conn) << std::endl;
         return 0;
     }
     
@@ -271,15 +250,15 @@ int getLogCountByLevel(const std::string& level) {
     
     if (mysql_stmt_bind_param(stmt, bind)) {
         mysql_rollback(conn);
-        mysql_stmt_close(stmt);
         std::cerr << "mysql_stmt_bind_param failed: " << mysql_stmt_error(stmt) << std::endl;
+        connRAII.invalidate(sql);
         return 0;
     }
     
     if (mysql_stmt_execute(stmt)) {
         mysql_rollback(conn);
-        mysql_stmt_close(stmt);
         std::cerr << "mysql_stmt_execute failed: " << mysql_stmt_error(stmt) << std::endl;
+        connRAII.invalidate(sql);
         return 0;
     }
     
@@ -292,8 +271,8 @@ int getLogCountByLevel(const std::string& level) {
     
     if (mysql_stmt_bind_result(stmt, resultBind)) {
         mysql_rollback(conn);
-        mysql_stmt_close(stmt);
         std::cerr << "mysql_stmt_bind_result failed: " << mysql_stmt_error(stmt) << std::endl;
+        connRAII.invalidate(sql);
         return 0;
     }
     
@@ -301,9 +280,9 @@ int getLogCountByLevel(const std::string& level) {
         // count 已经被填充
     }
     
-    // 提交读事务
+    // 释放结果集(语句句柄留在连接上复用), 然后提交读事务
+    mysql_stmt_free_result(stmt);
     mysql_commit(conn);
-    mysql_stmt_close(stmt);
     
     return count;
 }
@@ -1,8 +1,11 @@
 #include "WebSocketApiHandlers.hpp"
 #include "WebSocket.hpp"
 #include "../MySQL/SqlConnPool.hpp"
+#include "../MySQL/LogStats.hpp"
 #include "../Util/SessionManager.hpp"
+#include "../LogCompression.hpp"
 #include <chrono>
+#include <mutex>
 #include <mysql/mysql.h>
 #include <iostream>
 #include <filesystem>
@@ -11,6 +14,7 @@
 #include <filesystem>
 std::string __log_file_path = std::filesystem::current_path().string() + "/Log/WebSocketServer.txt";
 std::ofstream __log_file(__log_file_path, std::ios::app);
+static std::mutex __log_mutex;    // WebSocket ڶ¼ѭִ߳
 
 // ־API
 HttpResponse handleLogsApi(const HttpRequest& request, ClientSession& session) {
@@ -60,6 +64,36 @@ HttpResponse handleLogsApi(const HttpRequest& request, ClientSession& session) {
     return response;
 }
 
+// ͳƽӿõĸ; ȡ LogStats ڴ, δʱ˻ COUNT(*)
+struct LogLevelCounts {
+    uint64_t total = 0;
+    uint64_t info = 0;
+    uint64_t warning = 0;
+    uint64_t error = 0;
+    uint64_t fatal = 0;
+};
+
+static LogLevelCounts getLogLevelCounts() {
+    LogLevelCounts result;
+    LogStats::Counts counts;
+    if (LogStats::getInstance().totals(counts)) {
+        for (uint64_t count : counts) {
+            result.total += count;
+        }
+        result.info = counts[LogStats::levelIndex("INFO")];
+        result.warning = counts[LogStats::levelIndex("WARNING")];
+        result.error = counts[LogStats::levelIndex("ERROR")];
+        result.fatal = counts[LogStats::levelIndex("FATAL")];
+        return result;
+    }
+    result.total = getTotalLogsCount();
+    result.info = getLogCountByLevel("INFO");
+    result.warning = getLogCountByLevel("WARNING");
+    result.error = getLogCountByLevel("ERROR");
+    result.fatal = getLogCountByLevel("FATAL");
+    return result;
+}
+
 // ͳAPI
 HttpResponse handleStatsApi(const HttpRequest& request, ClientSession& session) {
     HttpResponse response;
@@ -67,9 +101,10 @@ HttpResponse handleStatsApi(const HttpRequest& request, ClientSession& session)
     response.statusText = "OK";
     
     // ȡͳϢ
-    int totalLogs = getTotalLogsCount();
-    int warningCount = getLogCountByLevel("WARNING");
-    int errorCount = getLogCountByLevel("ERROR") + getLogCountByLevel("FATAL");
+    LogLevelCounts counts = getLogLevelCounts();
+    uint64_t totalLogs = counts.total;
+    uint64_t warningCount = counts.warning;
+    uint64_t errorCount = counts.error + counts.fatal;
     int clientCount = SessionManager::getInstance()->getSessionCount();
     
     // JSONӦ
@@ -87,6 +122,42 @@ HttpResponse handleStatsApi(const HttpRequest& request, ClientSession& session)
     return response;
 }
 
+// ӳ״̬API: ȴͳʱ, Լȡӵȴʱֱͼ
+HttpResponse handlePoolStatsApi(const HttpRequest& request, ClientSession& session) {
+    HttpResponse response;
+    response.statusCode = 200;
+    response.statusText = "OK";
+
+    SqlPoolStats stats = SqlConnPool::getInstance()->getStats();
+
+    // ֱͼÿһΪ [Ͻ(΢), ], һͰûϽ, Ϊ -1
+    std::string histogram;
+    for (int i = 0; i < SqlPoolStats::WAIT_BUCKETS; ++i) {
+        long long bound = i < SqlPoolStats::WAIT_BUCKETS - 1 ? SqlPoolStats::WAIT_BOUNDS_US[i] : -1;
+        histogram += (i == 0 ? "[" : ", [") + std::to_string(bound) + ", " + std::to_string(stats.waitHistogram[i]) + "]";
+    }
+
+    std::string json = "{\n";
+    json += "\"totalConn\": " + std::to_string(stats.totalConn) + ",\n";
+    json += "\"idleConn\": " + std::to_string(stats.idleConn) + ",\n";
+    json += "\"inUseConn\": " + std::to_string(stats.inUseConn) + ",\n";
+    json += "\"peakInUse\": " + std::to_string(stats.peakInUse) + ",\n";
+    json += "\"waiters\": " + std::to_string(stats.waiters) + ",\n";
+    json += "\"checkouts\": " + std::to_string(stats.checkouts) + ",\n";
+    json += "\"timeouts\": " + std::to_string(stats.timeouts) + ",\n";
+    json += "\"created\": " + std::to_string(stats.created) + ",\n";
+    json += "\"closed\": " + std::to_string(stats.closed) + ",\n";
+    json += "\"validationFailures\": " + std::to_string(stats.validationFailures) + ",\n";
+    json += "\"waitHistogramUs\": [" + histogram + "]\n";
+    json += "}";
+
+    response.body = json;
+    response.headers["Content-Type"] = "application/json";
+    response.headers["Content-Length"] = std::to_string(json.size());
+
+    return response;
+}
+
 void sendWebSocketError(int sockfd, const std::string& error) {
     Json::Value errorResponse;
     errorResponse["type"] = "error";
@@ -122,7 +193,8 @@ void handleWebSocketMessage(int sockfd, const std::string& message, ClientSessio
     }
 }
 
-void handleWebSocketRequest(int sockfd, const Json::Value& request, ClientSession& session) {
+// ִвѯ WebSocket Ӧ, ̳߳е
+static std::string buildWebSocketResponse(const Json::Value& request) {
     std::string requestType = request.get("requestType", "").asString();
     int requestId = request.get("requestId", 0).asInt();
     Json::Value data = request.get("data", Json::Value());
@@ -152,10 +224,11 @@ void handleWebSocketRequest(int sockfd, const Json::Value& request, ClientSessio
             
         } else if (requestType == "get_stats") {
             Json::Value stats;
-            stats["totalLogs"] = getTotalLogsCount();
-            stats["errorCount"] = getLogCountByLevel("ERROR");
-            stats["warningCount"] = getLogCountByLevel("WARNING");
-            stats["infoCount"] = getLogCountByLevel("INFO");
+            LogLevelCounts counts = getLogLevelCounts();
+            stats["totalLogs"] = Json::UInt64(counts.total);
+            stats["errorCount"] = Json::UInt64(counts.error);
+            stats["warningCount"] = Json::UInt64(counts.warning);
+            stats["infoCount"] = Json::UInt64(counts.info);
             stats["clientCount"] = SessionManager::getInstance()->getSessionCount();
             
             response["data"] = stats;
@@ -211,10 +284,13 @@ void handleWebSocketRequest(int sockfd, const Json::Value& request, ClientSessio
         response["error"] = std::string("ʧ: ") + e.what();
     }
     
-    // Ӧ
     Json::StreamWriterBuilder builder;
-    std::string responseStr = Json::writeString(builder, response);
-    g_server->sendWebSocketMessage(sockfd, responseStr);
+    return Json::writeString(builder, response);
+}
+
+void handleWebSocketRequest(int sockfd, const Json::Value& request, ClientSession& session) {
+    // ѯݿ, ̳߳йӦ, ɺ¼ѭ
+    g_server->deferWebSocketReply(sockfd, [request]() { return buildWebSocketResponse(request); });
 }
 
 // ־µ WebSocket ͻ
@@ -241,6 +317,7 @@ void insertWebSocketMessage(int sockfd, const std::string& message, ClientSessio
     try {
         // 򵥵JSON(ʵĿпҪʹJSON)
         std::string level, logMessage, timestamp;
+        std::lock_guard<std::mutex> logLock(__log_mutex);
         
         // ȡlevelֶ
         size_t levelPos = message.find("\"level\":");
@@ -269,62 +346,53 @@ void insertWebSocketMessage(int sockfd, const std::string& message, ClientSessio
         }
         __log_file << "[INFO] ʱ: " << timestamp << std::endl;
         
-        // ȡݿӲ־
-        MYSQL* conn = nullptr;
-        SqlConnRAII connRAII(&conn, SqlConnPool::getInstance());
-        
-        if (conn) {
-            // ׼SQL
-            std::string sql = "INSERT INTO log_table (level, message, timestamp) VALUES (?, ?, ?)";
-            
-            // ʹԤֹSQLע
-            MYSQL_STMT* stmt = mysql_stmt_init(conn);
-            if (stmt) {
-                if (mysql_stmt_prepare(stmt, sql.c_str(), sql.length()) == 0) {
-                    MYSQL_BIND bind[3];
-                    memset(bind, 0, sizeof(bind));
-                    
-                    // level
-                    bind[0].buffer_type = MYSQL_TYPE_STRING;
-                    bind[0].buffer = (void*)level.c_str();
-                    bind[0].buffer_length = level.length();
-                    
-                    // message
-                    bind[1].buffer_type = MYSQL_TYPE_STRING;
-                    bind[1].buffer = (void*)logMessage.c_str();
-                    bind[1].buffer_length = logMessage.length();
-                    
-                    // timestamp
-                    bind[2].buffer_type = MYSQL_TYPE_STRING;
-                    bind[2].buffer = (void*)timestamp.c_str();
-                    bind[2].buffer_length = timestamp.length();
-                    
-                    if (mysql_stmt_bind_param(stmt, bind) == 0) {
-                        if (mysql_stmt_execute(stmt) == 0) {
-                            // ɹݿ
-                            std::string response = "{\"status\": \"ok\", \"message\": \"Log saved to database\"}";
-                            auto frame = createWebSocketFrameWrapper(response);
-                            send(sockfd, frame.data(), frame.size(), 0);
-                        } else {
-                            // ִʧ
-                            std::string error = mysql_stmt_error(stmt);
-                            std::string response = "{\"status\": \"error\", \"message\": \"Database error: " + error + "\"}";
-                            auto frame = createWebSocketFrameWrapper(response);
-                            send(sockfd, frame.data(), frame.size(), 0);
-                        }
-                    }   
+        // ݿ, ִ̳߳, ¼ѭؿͻ
+        g_server->deferWebSocketReply(sockfd, [level, logMessage, timestamp]() -> std::string {
+            MYSQL* conn = nullptr;
+            SqlConnRAII connRAII(&conn, SqlConnPool::getInstance());
+            if (!conn) {
+                // ޷ȡݿ
+                return "{\"status\": \"error\", \"message\": \"Database connection failed\"}";
+            }
 
-                    __log_file << "[INFO] 󶨲ɹ" << std::endl;
-                    
-                    mysql_stmt_close(stmt);
-                }
+            // ʹϻԤֹSQLע
+            static const std::string sql = "INSERT INTO log_table (level, message, timestamp) VALUES (?, ?, ?)";
+            MYSQL_STMT* stmt = connRAII.prepare(sql);
+            if (!stmt) {
+                return "";
             }
-        } else {
-            // ޷ȡݿ
-            std::string response = "{\"status\": \"error\", \"message\": \"Database connection failed\"}";
-            auto frame = createWebSocketFrameWrapper(response);
-            send(sockfd, frame.data(), frame.size(), 0);
-        }
+
+            MYSQL_BIND bind[3];
+            memset(bind, 0, sizeof(bind));
+
+            // level
+            bind[0].buffer_type = MYSQL_TYPE_STRING;
+            bind[0].buffer = (void*)level.c_str();
+            bind[0].buffer_length = level.length();
+
+            // message
+            bind[1].buffer_type = MYSQL_TYPE_STRING;
+            bind[1].buffer = (void*)logMessage.c_str();
+            bind[1].buffer_length = logMessage.length();
+
+            // timestamp
+            bind[2].buffer_type = MYSQL_TYPE_STRING;
+            bind[2].buffer = (void*)timestamp.c_str();
+            bind[2].buffer_length = timestamp.length();
+
+            if (mysql_stmt_bind_param(stmt, bind) != 0) {
+                return "";
+            }
+            if (mysql_stmt_execute(stmt) != 0) {
+                // ִʧ
+                std::string error = mysql_stmt_error(stmt);
+                connRAII.invalidate(sql);
+                return "{\"status\": \"error\", \"message\": \"Database error: " + error + "\"}";
+            }
+            // ɹݿ
+            LogStats::getInstance().record(LogStats::levelIndex(level));
+            return "{\"status\": \"ok\", \"message\": \"Log saved to database\"}";
+        });
     } catch (const std::exception& e) {
         // 쳣
         std::string response = "{\"status\": \"error\", \"message\": \"Error processing log: " + std::string(e.what()) + "\"}";
@@ -342,7 +410,19 @@ HttpResponse handleLogFileDownload(const HttpRequest& request, ClientSession& se
         fileType = request.queryParams.at("type");
     }
     
-    std::string filePath = std::filesystem::current_path().string() + "/log." + fileType;
+    std::string fileName = "log." + fileType;
+    // ָ file ʱתʷļ, ֻǰĿ¼ log_ ͷļ
+    if (request.queryParams.find("file") != request.queryParams.end()) {
+        fileName = request.queryParams.at("file");
+        if (fileName.rfind("log_", 0) != 0 || fileName.find('/') != std::string::npos ||
+            fileName.find("..") != std::string::npos) {
+            response.statusCode = 400;
+            response.statusText = "Bad Request";
+            response.body = "Invalid log file name";
+            return response;
+        }
+    }
+    std::filesystem::path filePath = std::filesystem::current_path() / fileName;
     
     // ļǷ
     if (!std::filesystem::exists(filePath)) {
@@ -352,17 +432,37 @@ HttpResponse handleLogFileDownload(const HttpRequest& request, ClientSession& se
         return response;
     }
     
-    // ȡļ
-    std::ifstream file(filePath, std::ios::binary);
-    std::ostringstream contentStream;
-    contentStream << file.rdbuf();
-    response.body = contentStream.str();
+    // ȡļ, ѹʷļʽѹ;
+    //  offset/length ʱֻ֡ѹǸ֡
+    bool ok = false;
+    if (LogCompression::isCompressed(filePath) &&
+        request.queryParams.find("offset") != request.queryParams.end() &&
+        request.queryParams.find("length") != request.queryParams.end()) {
+        try {
+            uint64_t offset = std::stoull(request.queryParams.at("offset"));
+            size_t length = std::stoul(request.queryParams.at("length"));
+            ok = LogCompression::readRange(filePath, offset, length, response.body);
+        } catch (const std::exception&) {
+            ok = false;
+        }
+    } else {
+        ok = LogCompression::readAll(filePath, response.body);
+    }
+    if (!ok) {
+        response.statusCode = 500;
+        response.statusText = "Internal Server Error";
+        response.body = "Failed to read log file";
+        return response;
+    }
+    
+    // ļȥѹչ
+    std::string downloadName = LogCompression::isCompressed(filePath) ? filePath.stem().string() : fileName;
     
     // Ӧͷ
     response.statusCode = 200;
     response.statusText = "OK";
-    response.headers["Content-Type"] = (fileType == "html") ? "text/html" : "text/plain";
-    response.headers["Content-Disposition"] = "attachment; filename=\"log." + fileType + "\"";
+    response.headers["Content-Type"] = (std::filesystem::path(downloadName).extension() == ".html") ? "text/html" : "text/plain";
+    response.headers["Content-Disposition"] = "attachment; filename=\"" + downloadName + "\"";
     response.headers["Content-Length"] = std::to_string(response.body.size());
     
     return response;
@@ -9,6 +9,7 @@ using namespace EpollServerSpace;
 // API 处理函数
 HttpResponse handleLogsApi(const HttpRequest& request, ClientSession& session);
 HttpResponse handleStatsApi(const HttpRequest& request, ClientSession& session);
+HttpResponse handlePoolStatsApi(const HttpRequest& request, ClientSession& session);
 
 // WebSocket 消息处理函数
 void handleWebSocketRequest(int sockfd, const Json::Value& request, ClientSession& session);
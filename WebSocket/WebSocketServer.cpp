@@ -129,14 +129,17 @@ int main(int argc, char* argv[]) {
     try {
         g_server = new EpollServer(port, username, password, dbname, logPath);
         setGlobalServerReference(g_server);
+        g_server->setReactorThreads(std::max(0, EnvConfig::getWebReactorThreads()));
         
         // 设置静态文件目录
         g_server->setStaticFilesDir(staticDir);
         
-        // 添加 API 端点处理器
-        g_server->addGetHandler("/api/logs", handleLogsApi);
-        g_server->addGetHandler("/api/stats", handleStatsApi);
-        g_server->addGetHandler("/api/download-log", handleLogFileDownload);
+        // 添加 API 端点处理器; 查询数据库、读取日志文件会阻塞, 放到线程池中执行
+        g_server->addAsyncGetHandler("/api/logs", handleLogsApi);
+        g_server->addAsyncGetHandler("/api/stats", handleStatsApi);
+        // 只读取连接池的内存计数, 不阻塞, 在事件循环中直接执行
+        g_server->addGetHandler("/api/pool-stats", handlePoolStatsApi);
+        g_server->addAsyncGetHandler("/api/download-log", handleLogFileDownload);
 
         // 设置 WebSocket 处理器
         g_server->setWebSocketHandler("/ws", handleWebSocketMessage);
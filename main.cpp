@@ -83,7 +83,7 @@ int main(){
     if(configManager.isInitialized()){
         configManager.printStatus();
         if(configManager.isTextFormat()){
-            Logger logger("log.txt", false);
+            Logger logger("log.txt", false, LoggerMode::DEDICATED_WRITER);
             while(true){
                 auto now = std::chrono::system_clock::now();
                 std::time_t now_time = std::chrono::system_clock::to_time_t(now);
@@ -193,7 +193,7 @@ int main(){
         }
         else
         {
-            Logger logger("log.html", true);
+            Logger logger("log.html", true, LoggerMode::DEDICATED_WRITER);
             while(true){
                 auto now = std::chrono::system_clock::now();
                 std::time_t now_time = std::chrono::system_clock::to_time_t(now);
@@ -7,6 +7,10 @@
 #include <openssl/sha.h>
 #include <openssl/evp.h>
 #include <vector>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <set>
 
 using namespace EpollServerSpace;
 
@@ -118,6 +122,14 @@ public:
         return payload;
     }
     
+    // 接收超时, 避免收不到消息时测试一直阻塞
+    void setReceiveTimeout(int ms) {
+        struct timeval tv;
+        tv.tv_sec = ms / 1000;
+        tv.tv_usec = (ms % 1000) * 1000;
+        setsockopt(sockfd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    }
+
     void disconnect() {
         if (sockfd_ >= 0) {
             close(sockfd_);
@@ -204,6 +216,88 @@ TEST_F(WebSocketCommTest, WebSocketMessageExchange) {
     client.disconnect();
 }
 
+// 多个事件循环: 记录处理客户端消息的线程, 确认每个循环上都有 WebSocket 客户端
+class WebSocketBroadcastTest : public ::testing::Test {
+protected:
+    EpollServer* server;
+    std::thread serverThread;
+    std::mutex threadsMutex;
+    std::set<std::thread::id> handlerThreads;
+    std::vector<std::unique_ptr<WebSocketClientSimulator>> clients;
+
+    void SetUp() override {
+        server = new EpollServer(8096, "test_user", "test_password", "test_db", "./test_log.txt", "./static");
+        server->setReactorThreads(2);
+        server->setWebSocketHandler("/ws", [this](int sockfd, const std::string& message, ClientSession& session) {
+            {
+                std::lock_guard<std::mutex> lock(threadsMutex);
+                handlerThreads.insert(std::this_thread::get_id());
+            }
+            server->sendWebSocketMessage(sockfd, "registered");
+        });
+        server->ServerInit();
+        serverThread = std::thread([this]() {
+            server->ServerStart();
+        });
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+
+    void TearDown() override {
+        clients.clear();
+        server->ServerStop();
+        if (serverThread.joinable()) {
+            serverThread.join();
+        }
+        delete server;
+    }
+
+    // 连接由内核按四元组分散到各个事件循环, 连接足够多的客户端使每个循环都分到
+    void connectClients(int count) {
+        for (int i = 0; i < count; ++i) {
+            std::unique_ptr<WebSocketClientSimulator> client(new WebSocketClientSimulator("127.0.0.1", 8096));
+            ASSERT_TRUE(client->connect());
+            client->setReceiveTimeout(2000);
+            ASSERT_TRUE(client->performWebSocketHandshake());
+            ASSERT_TRUE(client->sendWebSocketFrame("hello"));
+            ASSERT_EQ(client->receiveWebSocketFrame(), "registered");
+            clients.push_back(std::move(client));
+        }
+    }
+};
+
+// 从非事件循环线程广播, 每个事件循环上的客户端都收到
+TEST_F(WebSocketBroadcastTest, BroadcastReachesEveryReactor) {
+    ASSERT_GE(server->reactorCount(), 2u);
+    connectClients(16);
+    {
+        std::lock_guard<std::mutex> lock(threadsMutex);
+        ASSERT_EQ(handlerThreads.size(), server->reactorCount());
+    }
+
+    server->broadcastWebSocketMessage("broadcast");
+    for (auto& client : clients) {
+        EXPECT_EQ(client->receiveWebSocketFrame(), "broadcast");
+    }
+}
+
+// 其他线程持续广播时停止服务器, 关闭事件循环与广播不能同时访问事件循环列表
+TEST_F(WebSocketBroadcastTest, BroadcastDuringStop) {
+    connectClients(4);
+    std::atomic<bool> broadcasting{true};
+    std::thread broadcaster([this, &broadcasting]() {
+        while (broadcasting) {
+            server->broadcastWebSocketMessage("tick");
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    server->ServerStop();
+    serverThread.join();    // 所有事件循环结束并关闭
+    broadcasting = false;
+    broadcaster.join();
+    EXPECT_EQ(server->reactorCount(), 0u);
+}
+
 // 更多WebSocket通信测试...
 
 int main(int argc, char **argv) {
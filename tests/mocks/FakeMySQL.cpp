@@ -0,0 +1,417 @@
+#include "FakeMySQL.hpp"
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 各函数的返回类型随客户端库版本不同 (my_bool / bool, my_ulonglong / uint64_t),
+// 取头文件中声明的类型, 保证定义与声明一致
+using BoolResult = decltype(mysql_commit(nullptr));
+using RowCount = decltype(mysql_num_rows(nullptr));
+using AffectedRows = decltype(mysql_affected_rows(nullptr));
+
+namespace {
+
+    // 连接、语句和结果集句柄都指向下面的结构, 调用方只把句柄传回本文件中的函数
+    struct Connection {
+        unsigned int err = 0;
+        std::string error;
+        bool connected = false;
+        bool localInfile = false;
+        int (*infileInit)(void**, const char*, void*) = nullptr;
+        int (*infileRead)(void*, char*, unsigned int) = nullptr;
+        void (*infileEnd)(void*) = nullptr;
+        int (*infileError)(void*, char*, unsigned int) = nullptr;
+        void* infileUserdata = nullptr;
+        std::string lastQuery;
+    };
+
+    struct Stmt {
+        Connection* conn = nullptr;
+        std::string sql;
+        std::vector<MYSQL_BIND> binds;
+        unsigned int err = 0;
+        std::string error;
+    };
+
+    struct Result {
+        FakeMySQL::Rows rows;
+        std::vector<std::vector<char*>> pointers;
+        size_t next = 0;
+    };
+
+    struct State {
+        std::mutex mutex;
+        bool up = true;
+        std::map<std::string, unsigned int> failures;
+        std::map<std::string, FakeMySQL::Rows> results;
+        std::function<void(const std::string&)> hook;
+        std::vector<std::string> queries;
+        std::vector<FakeMySQL::Statement> executed;
+        std::vector<std::string> bulkData;
+        int open = 0;
+        int connects = 0;
+    };
+
+    State& state() {
+        static State* instance = new State();
+        return *instance;
+    }
+
+    Connection* connOf(MYSQL* mysql) { return reinterpret_cast<Connection*>(mysql); }
+    Stmt* stmtOf(MYSQL_STMT* stmt) { return reinterpret_cast<Stmt*>(stmt); }
+    Result* resultOf(MYSQL_RES* res) { return reinterpret_cast<Result*>(res); }
+
+    // 调用方已持有锁
+    unsigned int failureFor(const std::string& sql) {
+        for (const auto& entry : state().failures) {
+            if (sql.compare(0, entry.first.size(), entry.first) == 0) {
+                return entry.second;
+            }
+        }
+        return 0;
+    }
+
+    void setError(Connection* conn, unsigned int err) {
+        conn->err = err;
+        conn->error = err ? "fake mysql error " + std::to_string(err) : "";
+    }
+
+    std::string paramText(const MYSQL_BIND& bind) {
+        if (bind.is_null && *bind.is_null) {
+            return "NULL";
+        }
+        switch (bind.buffer_type) {
+            case MYSQL_TYPE_LONG:
+                return bind.is_unsigned ? std::to_string(*static_cast<unsigned int*>(bind.buffer))
+                                        : std::to_string(*static_cast<int*>(bind.buffer));
+            case MYSQL_TYPE_LONGLONG:
+                return std::to_string(*static_cast<long long*>(bind.buffer));
+            default: {
+                unsigned long length = bind.length ? *bind.length : bind.buffer_length;
+                return std::string(static_cast<const char*>(bind.buffer), length);
+            }
+        }
+    }
+}
+
+namespace FakeMySQL {
+
+    void reset() {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.up = true;
+        s.failures.clear();
+        s.results.clear();
+        s.hook = nullptr;
+        s.queries.clear();
+        s.executed.clear();
+        s.bulkData.clear();
+        s.connects = 0;
+    }
+
+    void setServerUp(bool up) {
+        std::lock_guard<std::mutex> lock(state().mutex);
+        state().up = up;
+    }
+
+    void failQueries(const std::string& prefix, unsigned int err) {
+        std::lock_guard<std::mutex> lock(state().mutex);
+        if (err) {
+            state().failures[prefix] = err;
+        } else {
+            state().failures.erase(prefix);
+        }
+    }
+
+    void setQueryResult(const std::string& prefix, const Rows& rows) {
+        std::lock_guard<std::mutex> lock(state().mutex);
+        state().results[prefix] = rows;
+    }
+
+    void setQueryHook(std::function<void(const std::string& sql)> hook) {
+        std::lock_guard<std::mutex> lock(state().mutex);
+        state().hook = std::move(hook);
+    }
+
+    std::vector<std::string> queries() {
+        std::lock_guard<std::mutex> lock(state().mutex);
+        return state().queries;
+    }
+
+    std::vector<Statement> executed() {
+        std::lock_guard<std::mutex> lock(state().mutex);
+        return state().executed;
+    }
+
+    std::vector<std::string> bulkData() {
+        std::lock_guard<std::mutex> lock(state().mutex);
+        return state().bulkData;
+    }
+
+    int openConnections() {
+        std::lock_guard<std::mutex> lock(state().mutex);
+        return state().open;
+    }
+
+    int connectCount() {
+        std::lock_guard<std::mutex> lock(state().mutex);
+        return state().connects;
+    }
+
+    bool localInfileEnabled(MYSQL* conn) {
+        return connOf(conn)->localInfile;
+    }
+}
+
+MYSQL* mysql_init(MYSQL*) {
+    return reinterpret_cast<MYSQL*>(new Connection());
+}
+
+int mysql_options(MYSQL* mysql, enum mysql_option option, const void* arg) {
+    if (option == MYSQL_OPT_LOCAL_INFILE) {
+        connOf(mysql)->localInfile = arg && *static_cast<const unsigned int*>(arg) != 0;
+    }
+    return 0;
+}
+
+MYSQL* mysql_real_connect(MYSQL* mysql, const char*, const char*, const char*, const char*,
+                          unsigned int, const char*, unsigned long) {
+    std::lock_guard<std::mutex> lock(state().mutex);
+    if (!state().up) {
+        setError(connOf(mysql), 2003);  // CR_CONN_HOST_ERROR
+        return nullptr;
+    }
+    connOf(mysql)->connected = true;
+    ++state().open;
+    ++state().connects;
+    return mysql;
+}
+
+void mysql_close(MYSQL* mysql) {
+    if (!mysql) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(state().mutex);
+        if (connOf(mysql)->connected) {
+            --state().open;
+        }
+    }
+    delete connOf(mysql);
+}
+
+int mysql_ping(MYSQL* mysql) {
+    std::lock_guard<std::mutex> lock(state().mutex);
+    setError(connOf(mysql), state().up ? 0 : 2006);
+    return state().up ? 0 : 1;
+}
+
+int mysql_select_db(MYSQL*, const char*) {
+    return 0;
+}
+
+unsigned long mysql_thread_id(MYSQL*) {
+    return 1;
+}
+
+const char* mysql_error(MYSQL* mysql) {
+    return connOf(mysql)->error.c_str();
+}
+
+unsigned int mysql_errno(MYSQL* mysql) {
+    return connOf(mysql)->err;
+}
+
+int mysql_query(MYSQL* mysql, const char* query) {
+    Connection* conn = connOf(mysql);
+    std::string sql(query);
+    std::function<void(const std::string&)> hook;
+    {
+        std::lock_guard<std::mutex> lock(state().mutex);
+        hook = state().hook;
+    }
+    if (hook) {
+        hook(sql);
+    }
+
+    std::lock_guard<std::mutex> lock(state().mutex);
+    state().queries.push_back(sql);
+    conn->lastQuery = sql;
+    setError(conn, state().up ? failureFor(sql) : 2006);
+    if (conn->err) {
+        return 1;
+    }
+
+    // LOAD DATA LOCAL INFILE: 通过注册的回调读取全部数据
+    if (sql.compare(0, 15, "LOAD DATA LOCAL") == 0) {
+        if (!conn->localInfile) {
+            setError(conn, 3948);   // ER_CLIENT_LOCAL_FILES_DISABLED
+            return 1;
+        }
+        std::string data;
+        if (conn->infileInit && conn->infileRead) {
+            void* ptr = nullptr;
+            conn->infileInit(&ptr, "", conn->infileUserdata);
+            char buffer[4096];
+            int n;
+            while ((n = conn->infileRead(ptr, buffer, sizeof(buffer))) > 0) {
+                data.append(buffer, n);
+            }
+            if (conn->infileEnd) {
+                conn->infileEnd(ptr);
+            }
+        }
+        state().bulkData.push_back(data);
+    }
+    return 0;
+}
+
+BoolResult mysql_commit(MYSQL* mysql) {
+    return mysql_query(mysql, "COMMIT") != 0;
+}
+
+BoolResult mysql_rollback(MYSQL* mysql) {
+    std::lock_guard<std::mutex> lock(state().mutex);
+    state().queries.push_back("ROLLBACK");
+    setError(connOf(mysql), 0);
+    return 0;
+}
+
+BoolResult mysql_autocommit(MYSQL*, BoolResult) {
+    return 0;
+}
+
+MYSQL_RES* mysql_store_result(MYSQL* mysql) {
+    std::lock_guard<std::mutex> lock(state().mutex);
+    const std::string& sql = connOf(mysql)->lastQuery;
+    for (const auto& entry : state().results) {
+        if (sql.compare(0, entry.first.size(), entry.first) == 0) {
+            Result* result = new Result();
+            result->rows = entry.second;
+            for (auto& row : result->rows) {
+                std::vector<char*> pointers;
+                for (auto& field : row) {
+                    pointers.push_back(&field[0]);
+                }
+                result->pointers.push_back(std::move(pointers));
+            }
+            return reinterpret_cast<MYSQL_RES*>(result);
+        }
+    }
+    return nullptr;
+}
+
+MYSQL_ROW mysql_fetch_row(MYSQL_RES* res) {
+    Result* result = resultOf(res);
+    if (result->next >= result->pointers.size()) {
+        return nullptr;
+    }
+    return result->pointers[result->next++].data();
+}
+
+RowCount mysql_num_rows(MYSQL_RES* res) {
+    return resultOf(res)->rows.size();
+}
+
+unsigned int mysql_num_fields(MYSQL_RES* res) {
+    Result* result = resultOf(res);
+    return result->rows.empty() ? 0 : static_cast<unsigned int>(result->rows[0].size());
+}
+
+void mysql_free_result(MYSQL_RES* res) {
+    delete resultOf(res);
+}
+
+AffectedRows mysql_affected_rows(MYSQL*) {
+    return 0;
+}
+
+unsigned long mysql_real_escape_string(MYSQL*, char* to, const char* from, unsigned long length) {
+    unsigned long n = 0;
+    for (unsigned long i = 0; i < length; ++i) {
+        if (from[i] == '\'' || from[i] == '\\') {
+            to[n++] = '\\';
+        }
+        to[n++] = from[i];
+    }
+    to[n] = '\0';
+    return n;
+}
+
+void mysql_set_local_infile_handler(MYSQL* mysql, int (*init)(void**, const char*, void*),
+                                    int (*read)(void*, char*, unsigned int), void (*end)(void*),
+                                    int (*error)(void*, char*, unsigned int), void* userdata) {
+    Connection* conn = connOf(mysql);
+    conn->infileInit = init;
+    conn->infileRead = read;
+    conn->infileEnd = end;
+    conn->infileError = error;
+    conn->infileUserdata = userdata;
+}
+
+void mysql_set_local_infile_default(MYSQL* mysql) {
+    mysql_set_local_infile_handler(mysql, nullptr, nullptr, nullptr, nullptr, nullptr);
+}
+
+void mysql_library_end() {
+}
+
+MYSQL_STMT* mysql_stmt_init(MYSQL* mysql) {
+    Stmt* stmt = new Stmt();
+    stmt->conn = connOf(mysql);
+    return reinterpret_cast<MYSQL_STMT*>(stmt);
+}
+
+int mysql_stmt_prepare(MYSQL_STMT* handle, const char* query, unsigned long length) {
+    Stmt* stmt = stmtOf(handle);
+    stmt->sql.assign(query, length);
+    return 0;
+}
+
+BoolResult mysql_stmt_bind_param(MYSQL_STMT* handle, MYSQL_BIND* binds) {
+    Stmt* stmt = stmtOf(handle);
+    size_t count = 0;
+    for (char c : stmt->sql) {
+        count += (c == '?');
+    }
+    stmt->binds.assign(binds, binds + count);
+    return 0;
+}
+
+int mysql_stmt_execute(MYSQL_STMT* handle) {
+    Stmt* stmt = stmtOf(handle);
+    FakeMySQL::Statement record;
+    record.sql = stmt->sql;
+    for (const auto& bind : stmt->binds) {
+        record.params.push_back(paramText(bind));
+    }
+
+    std::lock_guard<std::mutex> lock(state().mutex);
+    stmt->err = state().up ? failureFor(stmt->sql) : 2013;
+    stmt->error = stmt->err ? "fake mysql error " + std::to_string(stmt->err) : "";
+    if (stmt->err) {
+        return 1;
+    }
+    state().executed.push_back(std::move(record));
+    return 0;
+}
+
+BoolResult mysql_stmt_close(MYSQL_STMT* handle) {
+    delete stmtOf(handle);
+    return 0;
+}
+
+BoolResult mysql_stmt_free_result(MYSQL_STMT*) {
+    return 0;
+}
+
+const char* mysql_stmt_error(MYSQL_STMT* handle) {
+    return stmtOf(handle)->error.c_str();
+}
+
+unsigned int mysql_stmt_errno(MYSQL_STMT* handle) {
+    return stmtOf(handle)->err;
+}
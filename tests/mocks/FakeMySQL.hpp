@@ -0,0 +1,51 @@
+#ifndef __FAKE_MYSQL_HPP__
+#define __FAKE_MYSQL_HPP__
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <mysql/mysql.h>
+
+// 用内存实现的 MySQL 客户端库, 代替 libmysqlclient 链接到测试中,
+// 使真实的 SqlConnPool / AsyncDBWriter / LogStats 可以在没有数据库的环境下运行
+// 记录执行过的语句和参数, 并可按语句前缀注入错误和查询结果
+namespace FakeMySQL {
+
+    // 一次 mysql_stmt_execute, 参数按绑定顺序转成文本, NULL 记为 "NULL"
+    struct Statement {
+        std::string sql;
+        std::vector<std::string> params;
+    };
+
+    using Rows = std::vector<std::vector<std::string>>;
+
+    // 清空记录、注入的错误和结果, 恢复为服务端可用
+    void reset();
+
+    // 服务端不可用时建立连接和 ping 失败
+    void setServerUp(bool up);
+
+    // 以 prefix 开头的 mysql_query / 预处理语句执行失败, 错误码为 err; err 为 0 时取消
+    void failQueries(const std::string& prefix, unsigned int err);
+
+    // 以 prefix 开头的查询由 mysql_store_result 返回 rows
+    void setQueryResult(const std::string& prefix, const Rows& rows);
+
+    // 每次 mysql_query 执行前调用, 用于观察执行过程中的中间状态
+    void setQueryHook(std::function<void(const std::string& sql)> hook);
+
+    // mysql_query 执行过的语句, 事务提交/回滚记为 COMMIT / ROLLBACK
+    std::vector<std::string> queries();
+    std::vector<Statement> executed();
+    // LOAD DATA LOCAL INFILE 读到的数据, 每次导入一项
+    std::vector<std::string> bulkData();
+
+    // 当前打开的连接数及累计建立的连接数
+    int openConnections();
+    int connectCount();
+
+    // 连接是否设置了 MYSQL_OPT_LOCAL_INFILE
+    bool localInfileEnabled(MYSQL* conn);
+}
+
+#endif // __FAKE_MYSQL_HPP__
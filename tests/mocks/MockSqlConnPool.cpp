@@ -54,6 +54,14 @@ SqlConnPool* SqlConnPool::getInstance() {
     return sqlConnPoolInstance;
 }
 
+SqlConnPool::SqlConnPool() {
+}
+
+SqlPoolStats SqlConnPool::getStats() {
+    // 模拟环境没有真实连接
+    return SqlPoolStats();
+}
+
 bool SqlConnPool::init(const char* host, const char* user, const char* pwd, const char* dbName, int port, int connSize) {
     // 模拟成功初始化
     return true;
@@ -78,6 +86,16 @@ void SqlConnPool::releaseConnection(MYSQL* conn) {
     // 空实现
 }
 
+MYSQL* SqlConnPool::createConnection(bool localInfile) {
+    // 模拟环境没有真实数据库
+    return nullptr;
+}
+
+StatementCache* SqlConnPool::getStatementCache(MYSQL* conn) {
+    // 假连接上不能准备语句
+    return nullptr;
+}
+
 // 添加模拟数据库查询函数
 extern "C" {
     std::vector<std::map<std::string, std::string>> fetchLogsFromDatabase(int limit, int offset, const std::string& levelFilter) {
@@ -0,0 +1,67 @@
+#include <benchmark/benchmark.h>
+#include "../../Util/LogLineParser.hpp"
+#include "../../Util/LogTemplates.hpp"
+#include <map>
+#include <regex>
+#include <string>
+#include <vector>
+
+// 对比服务器解析一条上报日志的开销
+// REGEX:  原来的 std::regex_search, 每条日志构造 smatch 并拷贝分组
+// PARSER: LogLineParser 单遍扫描, 字段为指向原始行的 string_view
+
+// 用 LogTemplates 生成与客户端上报一致的日志行
+static const std::vector<std::string>& ingestLines() {
+    static const std::vector<std::string> lines = []() {
+        std::vector<std::string> result;
+        const char* levels[] = {"INFO", "WARNING", "ERROR"};
+        for (const char* type : {"auth", "database", "network", "system"}) {
+            for (int i = 0; i < 64; ++i) {
+                std::map<std::string, std::string> values = {
+                    {"user", "alice"}, {"ip", "192.168.1." + std::to_string(i)}, {"table", "orders"},
+                    {"endpoint", "/api/logs"}, {"method", "GET"}, {"size", std::to_string(i * 37)},
+                    {"task", "process_bitmap"}, {"status", "failed"}};
+                std::string message = LogTemplates::replacePlaceholders(LogTemplates::getRandomTemplate(type), values);
+                const char* level = levels[i % 3];
+                result.push_back("<log " + std::string(level) + ">[" + level + "] {" + message + "} at 2025-04-09 15:45:45");
+            }
+        }
+        return result;
+    }();
+    return lines;
+}
+
+static void BM_ParseIngestRegex(benchmark::State& state) {
+    static const std::regex pattern(R"(<([^>]+)>\[([^\]]+)\]\s+\{(.*?)\}\s+at\s+([\d-]+\s[\d:]+))");
+    const auto& lines = ingestLines();
+    size_t i = 0;
+    std::smatch match;
+    for (auto _ : state) {
+        bool ok = std::regex_search(lines[i++ % lines.size()], match, pattern);
+        benchmark::DoNotOptimize(ok);
+        benchmark::DoNotOptimize(match);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_ParseIngestParser(benchmark::State& state) {
+    const auto& lines = ingestLines();
+    size_t i = 0;
+    LogLineParser::LogLine parsed;
+    for (auto _ : state) {
+        bool ok = LogLineParser::parseIngestLine(lines[i++ % lines.size()], parsed);
+        benchmark::DoNotOptimize(ok);
+        benchmark::DoNotOptimize(parsed);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_ParseIngestRegex);
+BENCHMARK(BM_ParseIngestParser);
+
+int main(int argc, char** argv) {
+    ::benchmark::Initialize(&argc, argv);
+    ::benchmark::RunSpecifiedBenchmarks();
+
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include <benchmark/benchmark.h>
+#include "../../Logger.hpp"
+#include <filesystem>
+#include <string>
+
+// 对比两种消费方式下 log_in_text 在调用线程上的单次开销
+// THREAD_POOL:      每次调用都向线程池提交一个 std::function 任务
+// DEDICATED_WRITER: 只入队, 由唯一的常驻写线程批量写入
+// DEFERRED_WRITER:  只拷贝参数的二进制编码, 格式化也移到写线程
+
+static Logger& getLogger(LoggerMode mode) {
+    static Logger poolLogger("./bench_logs/logger_pool.txt", false, LoggerMode::THREAD_POOL);
+    static Logger writerLogger("./bench_logs/logger_writer.txt", false, LoggerMode::DEDICATED_WRITER);
+    static Logger deferredLogger("./bench_logs/logger_deferred.txt", false, LoggerMode::DEFERRED_WRITER);
+    if (mode == LoggerMode::THREAD_POOL) {
+        return poolLogger;
+    }
+    return mode == LoggerMode::DEDICATED_WRITER ? writerLogger : deferredLogger;
+}
+
+static void BM_LogInText(benchmark::State& state, LoggerMode mode) {
+    Logger& logger = getLogger(mode);
+    int i = 0;
+    for (auto _ : state) {
+        logger.log_in_text(INFO, "Request received - Endpoint: {}, Method: {}, Size: {} bytes",
+                           "/api/logs", "GET", i++);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// 编译期格式串: 占位符拆分在编译期完成, 参数直接写入线程局部缓冲区
+static void BM_LogInTextCompiledFormat(benchmark::State& state, LoggerMode mode) {
+    Logger& logger = getLogger(mode);
+    int i = 0;
+    for (auto _ : state) {
+        logger.log_in_text(INFO, LOG_FMT("Request received - Endpoint: {}, Method: {}, Size: {} bytes"),
+                           "/api/logs", "GET", i++);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_CAPTURE(BM_LogInText, thread_pool, LoggerMode::THREAD_POOL)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+BENCHMARK_CAPTURE(BM_LogInText, dedicated_writer, LoggerMode::DEDICATED_WRITER)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+BENCHMARK_CAPTURE(BM_LogInTextCompiledFormat, dedicated_writer, LoggerMode::DEDICATED_WRITER)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+BENCHMARK_CAPTURE(BM_LogInTextCompiledFormat, deferred_writer, LoggerMode::DEFERRED_WRITER)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+int main(int argc, char** argv) {
+    std::filesystem::create_directories("./bench_logs");
+    ::benchmark::Initialize(&argc, argv);
+    ::benchmark::RunSpecifiedBenchmarks();
+
+    return 0;
+}
@@ -16,7 +16,26 @@ echo "Running unit tests..."
 ./EpollServer_test
 ./WebSocket_test
 ./SqlConnPool_test
+./SqlConnPoolSizing_test
 ./Client_test
+./LogQueue_test
+./FormatSpec_test
+./DeferredLog_test
+./AsyncLogBuffer_test
+./LoggerRotation_test
+./LogCompression_test
+./OverloadPolicy_test
+./DBWriteTask_test
+./AsyncDBWriter_test
+./WriteSpool_test
+./DBExecutor_test
+./LogPartition_test
+./LogStats_test
+./LogStatsFlush_test
+./IngestReactor_test
+./IngestProtocol_test
+./LogLineParser_test
+./IngestDiagnostics_test
 
 # 运行集成测试
 echo "Running integration tests..."
@@ -27,6 +46,8 @@ echo "Running integration tests..."
 echo "Running performance tests..."
 ./HighLoad_test
 ./MultiClient_test
+./LoggerOverhead_test
+./LogParserOverhead_test
 
 # 返回测试目录
 cd ..
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include "../../Server/AsyncDBWriter.hpp"
+#include "../../MySQL/SqlConnPool.hpp"
+#include "../mocks/FakeMySQL.hpp"
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace AsyncDBWriterSpace;
+
+// 真实的 AsyncDBWriter 通过 FakeMySQL 写入, 检查批次划分和生成的语句
+class AsyncDBWriterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        FakeMySQL::reset();
+    }
+
+    void TearDown() override {
+        AsyncDBWriter::getInstance().shutdown();
+    }
+
+    static void startWriter(size_t maxBatchSize, std::chrono::milliseconds maxWait, size_t bulkThreshold = 0) {
+        BatchOptions options;
+        options.maxBatchSize = maxBatchSize;
+        options.maxWait = maxWait;
+        options.bulkThreshold = bulkThreshold;
+        AsyncDBWriter::getInstance().setBatchOptions(options);
+        AsyncDBWriter::getInstance().start(1);
+    }
+
+    static void addTasks(int count) {
+        for (int i = 0; i < count; ++i) {
+            AsyncDBWriter::getInstance().addTask(
+                DBWriteTask("ERROR", "10.0.0.1", 9000 + i, "message " + std::to_string(i)));
+        }
+    }
+
+    // 等待已提交的批次数达到 batches
+    static bool waitForBatches(uint64_t batches) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (AsyncDBWriter::getInstance().getBatchCount() < batches) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return true;
+    }
+
+    static size_t rowsOf(const FakeMySQL::Statement& statement) {
+        return statement.params.size() / AsyncDBWriter::INSERT_COLUMNS;
+    }
+
+    static std::vector<size_t> statementRows() {
+        std::vector<size_t> rows;
+        for (const auto& statement : FakeMySQL::executed()) {
+            rows.push_back(rowsOf(statement));
+        }
+        return rows;
+    }
+
+    static size_t commits() {
+        size_t count = 0;
+        for (const auto& query : FakeMySQL::queries()) {
+            count += (query == "COMMIT");
+        }
+        return count;
+    }
+};
+
+// 不足 maxBatchSize 的剩余行按 2 的幂拆分, 如 37 = 32 + 4 + 1
+TEST_F(AsyncDBWriterTest, ChunkRowsSplitsIntoPowersOfTwo) {
+    std::vector<size_t> chunks;
+    for (size_t remaining = 37; remaining > 0;) {
+        size_t rows = AsyncDBWriter::chunkRows(remaining, 256);
+        chunks.push_back(rows);
+        remaining -= rows;
+    }
+    EXPECT_EQ(chunks, (std::vector<size_t>{32, 4, 1}));
+
+    EXPECT_EQ(AsyncDBWriter::chunkRows(600, 256), 256u);
+    EXPECT_EQ(AsyncDBWriter::chunkRows(256, 256), 256u);
+    EXPECT_EQ(AsyncDBWriter::chunkRows(255, 256), 128u);
+    EXPECT_EQ(AsyncDBWriter::chunkRows(7, 5), 5u);
+    EXPECT_EQ(AsyncDBWriter::chunkRows(1, 1), 1u);
+}
+
+// 多行 INSERT 写入时间戳列, 为空时与 LOAD DATA 一样取当前时间
+TEST_F(AsyncDBWriterTest, InsertSqlIncludesTimestamp) {
+    const std::string row = "(?, ?, ?, ?, COALESCE(NULLIF(?, ''), CURRENT_TIMESTAMP))";
+    EXPECT_EQ(AsyncDBWriter::buildInsertSql(1),
+              "INSERT INTO log_table (level, ip, port, message, timestamp) VALUES " + row);
+    EXPECT_EQ(AsyncDBWriter::buildInsertSql(2),
+              "INSERT INTO log_table (level, ip, port, message, timestamp) VALUES " + row + "," + row);
+}
+
+// 回放的历史日志保留原时间戳, 没有时间戳的绑定为空串
+TEST_F(AsyncDBWriterTest, InsertRowsBindTaskTimestamp) {
+    startWriter(64, std::chrono::milliseconds(50));
+    uint64_t batchesBefore = AsyncDBWriter::getInstance().getBatchCount();
+    AsyncDBWriter::getInstance().addTask(DBWriteTask("WARNING", "192.168.1.10", 8080, "old", "2025-04-09 15:45:45"));
+    AsyncDBWriter::getInstance().addTask(DBWriteTask("ERROR", "192.168.1.10", 8080, "new"));
+    ASSERT_TRUE(waitForBatches(batchesBefore + 1));
+
+    auto statements = FakeMySQL::executed();
+    ASSERT_EQ(statements.size(), 1u);
+    EXPECT_EQ(statements[0].sql, AsyncDBWriter::buildInsertSql(2));
+    ASSERT_EQ(statements[0].params.size(), 10u);
+    EXPECT_EQ(statements[0].params[3], "old");
+    EXPECT_EQ(statements[0].params[4], "2025-04-09 15:45:45");
+    EXPECT_EQ(statements[0].params[8], "new");
+    EXPECT_EQ(statements[0].params[9], "");
+}
+
+// 只有写入线程的连接开启 LOCAL INFILE, 积压达到阈值时整批用 LOAD DATA 导入
+TEST_F(AsyncDBWriterTest, BulkLoadUsesWriterConnectionOnly) {
+    MYSQL* pooled = SqlConnPool::getInstance()->createConnection();
+    ASSERT_NE(pooled, nullptr);
+    EXPECT_FALSE(FakeMySQL::localInfileEnabled(pooled));
+    mysql_close(pooled);
+
+    uint64_t batchesBefore = AsyncDBWriter::getInstance().getBatchCount();
+    addTasks(10);
+    startWriter(4, std::chrono::milliseconds(50), 1);
+    ASSERT_TRUE(waitForBatches(batchesBefore + 1));
+
+    auto bulk = FakeMySQL::bulkData();
+    ASSERT_EQ(bulk.size(), 1u);
+    EXPECT_EQ(std::count(bulk[0].begin(), bulk[0].end(), '\n'), 10);
+    EXPECT_TRUE(FakeMySQL::executed().empty());
+}
+
+// LOAD DATA 因其他错误失败时回滚, 本批改用多行 INSERT 写入, 不整批失败
+TEST_F(AsyncDBWriterTest, BulkLoadFailureFallsBackToInsert) {
+    FakeMySQL::failQueries("LOAD DATA", 1366);
+    uint64_t batchesBefore = AsyncDBWriter::getInstance().getBatchCount();
+    addTasks(10);
+    startWriter(4, std::chrono::milliseconds(50), 1);
+    ASSERT_TRUE(waitForBatches(batchesBefore + 1));
+
+    auto queries = FakeMySQL::queries();
+    EXPECT_NE(std::find(queries.begin(), queries.end(), "ROLLBACK"), queries.end());
+    EXPECT_EQ(statementRows(), (std::vector<size_t>{4, 4, 2}));
+    EXPECT_EQ(commits(), 1u);
+}
+
+// 积压超过 maxBatchSize 时每批最多取 maxBatchSize 条, 各自在一个事务中写入
+TEST_F(AsyncDBWriterTest, BatchesAreCappedAtMaxBatchSize) {
+    uint64_t batchesBefore = AsyncDBWriter::getInstance().getBatchCount();
+    addTasks(20);   // start 之前提交, 启动后工作线程面对的是 20 条积压
+    startWriter(8, std::chrono::milliseconds(50));
+    ASSERT_TRUE(waitForBatches(batchesBefore + 3));
+
+    EXPECT_EQ(statementRows(), (std::vector<size_t>{8, 8, 4}));
+    EXPECT_EQ(commits(), 3u);
+}
+
+// 取到第一条后最多等待 maxWait, 期间陆续到达的任务并入同一批
+TEST_F(AsyncDBWriterTest, BatchDrainsWithinMaxWait) {
+    startWriter(64, std::chrono::milliseconds(300));
+    uint64_t batchesBefore = AsyncDBWriter::getInstance().getBatchCount();
+
+    auto start = std::chrono::steady_clock::now();
+    addTasks(1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    addTasks(36);
+    ASSERT_TRUE(waitForBatches(batchesBefore + 1));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    // 37 条在一个事务中, 按 32 + 4 + 1 拆成三条语句; 未凑满一批, 等到 maxWait 才提交
+    EXPECT_EQ(statementRows(), (std::vector<size_t>{32, 4, 1}));
+    EXPECT_EQ(commits(), 1u);
+    EXPECT_GE(elapsed, std::chrono::milliseconds(250));
+    EXPECT_EQ(AsyncDBWriter::getInstance().getBatchCount(), batchesBefore + 1);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include "../../LogMessage/AsyncLogBuffer.hpp"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <map>
+
+namespace fs = std::filesystem;
+
+class AsyncLogBufferTest : public ::testing::Test {
+protected:
+    std::string logPath;
+
+    void SetUp() override {
+        logPath = (fs::temp_directory_path() / "async_log_buffer_test.log").string();
+        fs::remove(logPath);
+    }
+
+    void TearDown() override {
+        fs::remove(logPath);
+    }
+
+    std::vector<std::string> readLines() {
+        std::vector<std::string> lines;
+        std::ifstream in(logPath);
+        std::string line;
+        while (std::getline(in, line)) {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+};
+
+// 测试析构时写出所有线程暂存区中的日志, 且同一线程内保持顺序
+TEST_F(AsyncLogBufferTest, DrainsAllThreadsOnDestruction) {
+    constexpr int numThreads = 4;
+    constexpr int linesPerThread = 20000;
+    {
+        AsyncLogBuffer buffer(logPath);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < numThreads; t++) {
+            threads.emplace_back([&buffer, t]() {
+                for (int i = 0; i < linesPerThread; i++) {
+                    buffer.append(std::to_string(t) + " " + std::to_string(i) + "\n");
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    std::vector<std::string> lines = readLines();
+    ASSERT_EQ(static_cast<size_t>(numThreads * linesPerThread), lines.size());
+
+    std::map<int, int> lastSeen;
+    for (const auto& line : lines) {
+        std::istringstream in(line);
+        int t = 0, i = 0;
+        in >> t >> i;
+        auto it = lastSeen.find(t);
+        if (it != lastSeen.end()) {
+            EXPECT_EQ(it->second + 1, i);
+        }
+        lastSeen[t] = i;
+    }
+}
+
+// 测试 flush 会交出未写满的分块
+TEST_F(AsyncLogBufferTest, FlushWritesPartialChunk) {
+    AsyncLogBuffer buffer(logPath);
+    buffer.append("partial line\n");
+    buffer.flush();
+
+    for (int i = 0; i < 50 && readLines().empty(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::vector<std::string> lines = readLines();
+    ASSERT_EQ(1u, lines.size());
+    EXPECT_EQ("partial line", lines[0]);
+}
+
+// 测试超过单个字节块容量的日志行也能完整写入
+TEST_F(AsyncLogBufferTest, LineLargerThanArena) {
+    std::string longLine(3 * 1024 * 1024, 'x');
+    {
+        AsyncLogBuffer buffer(logPath);
+        buffer.append("before\n");
+        buffer.append(longLine + "\n");
+        buffer.append("after\n");
+    }
+
+    std::vector<std::string> lines = readLines();
+    ASSERT_EQ(3u, lines.size());
+    EXPECT_EQ("before", lines[0]);
+    EXPECT_EQ(longLine, lines[1]);
+    EXPECT_EQ("after", lines[2]);
+}
+
+// 测试 ON_ERROR 策略下错误日志不必等待刷新间隔即写入文件
+TEST_F(AsyncLogBufferTest, UrgentLineWrittenImmediately) {
+    LogSyncOptions options;
+    options.policy = LogSyncPolicy::ON_ERROR;
+    AsyncLogBuffer buffer(logPath, options);
+    buffer.append("normal line\n");
+    buffer.append("error line\n", ERROR);
+
+    for (int i = 0; i < 50 && readLines().size() < 2; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::vector<std::string> lines = readLines();
+    ASSERT_EQ(2u, lines.size());
+    EXPECT_EQ("error line", lines[1]);
+}
+
+// 测试文件被外部移走后 reopen 会在原路径重新创建文件
+TEST_F(AsyncLogBufferTest, ReopenAfterExternalRotation) {
+    std::string rotatedPath = logPath + ".1";
+    {
+        AsyncLogBuffer buffer(logPath);
+        buffer.append("old file\n");
+        buffer.flush();
+        for (int i = 0; i < 50 && readLines().empty(); i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        fs::rename(logPath, rotatedPath);
+
+        buffer.reopen();
+        buffer.append("new file\n");
+    }
+
+    std::vector<std::string> lines = readLines();
+    ASSERT_EQ(1u, lines.size());
+    EXPECT_EQ("new file", lines[0]);
+    fs::remove(rotatedPath);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include "../../EpollServer/DBExecutor.hpp"
+#include <sys/epoll.h>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 模拟事件循环: 等待 eventfd 可读后执行完成回调, 直到收到 expected 个回调或超时
+static size_t runLoop(DBExecutor& executor, size_t expected) {
+    int epfd = epoll_create1(0);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = executor.eventFd();
+    epoll_ctl(epfd, EPOLL_CTL_ADD, executor.eventFd(), &ev);
+
+    size_t done = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (done < expected && std::chrono::steady_clock::now() < deadline) {
+        epoll_event events[4];
+        int n = epoll_wait(epfd, events, 4, 100);
+        for (int i = 0; i < n; ++i) {
+            if (events[i].data.fd == executor.eventFd()) {
+                done += executor.runCompletions();
+            }
+        }
+    }
+    close(epfd);
+    return done;
+}
+
+TEST(DBExecutorTest, CompletionsRunOnLoopThread) {
+    DBExecutor executor(4);
+    ASSERT_GE(executor.eventFd(), 0);
+
+    const std::thread::id loopThread = std::this_thread::get_id();
+    const int count = 64;
+    std::vector<int> results(count, -1);
+    int onLoop = 0;
+
+    for (int i = 0; i < count; ++i) {
+        ASSERT_TRUE(executor.submit(
+            [i]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                return i * i;
+            },
+            [&, i](int value) {
+                results[i] = value;
+                if (std::this_thread::get_id() == loopThread) {
+                    ++onLoop;
+                }
+            }));
+    }
+
+    EXPECT_EQ(runLoop(executor, count), static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        EXPECT_EQ(results[i], i * i);
+    }
+    EXPECT_EQ(onLoop, count);
+    EXPECT_EQ(executor.inFlight(), 0u);
+}
+
+TEST(DBExecutorTest, FailedJobDeliversDefaultResult) {
+    DBExecutor executor(1);
+    std::string result = "unset";
+
+    executor.submit([]() -> std::string { throw std::runtime_error("db down"); },
+                    [&](const std::string& value) { result = value; });
+
+    EXPECT_EQ(runLoop(executor, 1), 1u);
+    EXPECT_TRUE(result.empty());
+    EXPECT_EQ(executor.inFlight(), 0u);
+}
+
+// 每个完成队列只执行提交到自己的回调, post 可从任意线程投递
+TEST(DBExecutorTest, CompletionsStayOnTheirQueue) {
+    DBExecutor executor(2, 2);
+    ASSERT_EQ(executor.queueCount(), 2u);
+    ASSERT_NE(executor.eventFd(0), executor.eventFd(1));
+
+    std::vector<int> first, second;
+    for (int i = 0; i < 8; ++i) {
+        executor.submit([i]() { return i; }, [&](int value) { first.push_back(value); }, 0);
+        executor.submit([i]() { return i; }, [&](int value) { second.push_back(value); }, 1);
+    }
+    std::thread poster([&]() { executor.post(1, [&]() { second.push_back(-1); }); });
+    poster.join();
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (executor.inFlight() > 0 && std::chrono::steady_clock::now() < deadline) {
+        executor.runCompletions(0);
+        executor.runCompletions(1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(first.size(), 8u);
+    EXPECT_EQ(second.size(), 9u);
+    EXPECT_EQ(executor.inFlight(), 0u);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
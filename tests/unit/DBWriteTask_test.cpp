@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include "../../Server/DBWriteTask.hpp"
+#include <string>
+#include <thread>
+#include <utility>
+
+using namespace AsyncDBWriterSpace;
+
+// 测试等级、地址、端口、时间戳和正文按值保存后能原样取回
+TEST(DBWriteTaskTest, FieldsRoundTrip) {
+    DBWriteTask task("WARNING", "192.168.1.10", 8080, "disk almost full", "2025-04-09 15:45:45");
+    EXPECT_STREQ("WARNING", task.levelName());
+    EXPECT_EQ(WARNING, task.logLevel());
+    EXPECT_EQ("192.168.1.10", task.clientIP());
+    EXPECT_EQ(8080, task.clientPort);
+    EXPECT_EQ("disk almost full", task.message.view());
+    EXPECT_EQ("2025-04-09 15:45:45", task.timestampView());
+
+    DBWriteTask v6("ERROR", "2001:db8::1", 443, "v6 client");
+    EXPECT_EQ("2001:db8::1", v6.clientIP());
+    EXPECT_TRUE(v6.timestampView().empty());
+}
+
+// 测试无法识别的等级按 INFO 写入, 无法解析的地址写为空串
+TEST(DBWriteTaskTest, UnknownLevelAndAddress) {
+    DBWriteTask task("NORMAL", "not-an-ip", 1, "");
+    EXPECT_STREQ("INFO", task.levelName());
+    EXPECT_EQ("", task.clientIP());
+    EXPECT_TRUE(task.message.empty());
+    EXPECT_STREQ("", task.message.data());
+}
+
+// 测试移动只转移正文指针, 源任务的正文变为空
+TEST(DBWriteTaskTest, MoveTransfersMessage) {
+    DBWriteTask source("INFO", "10.0.0.1", 9000, std::string(300, 'x'));
+    const char* data = source.message.data();
+
+    DBWriteTask moved(std::move(source));
+    EXPECT_EQ(data, moved.message.data());
+    EXPECT_TRUE(source.message.empty());
+
+    DBWriteTask copied(moved);
+    EXPECT_NE(data, copied.message.data());
+    EXPECT_EQ(moved.message.view(), copied.message.view());
+}
+
+// 测试释放的块在同一线程内被复用, 其他线程释放的块经全局链表回到分配线程
+TEST(DBWriteTaskTest, SlabReusesBlocks) {
+    MessageSlab& slab = MessageSlab::getInstance();
+    uint8_t sizeClass = 0;
+    char* first = slab.allocate(100, sizeClass);
+    EXPECT_EQ(1, sizeClass);
+    slab.deallocate(first, sizeClass);
+    char* second = slab.allocate(120, sizeClass);
+    EXPECT_EQ(first, second);
+    slab.deallocate(second, sizeClass);
+
+    char* large = slab.allocate(MessageSlab::MAX_BLOCK + 1, sizeClass);
+    EXPECT_EQ(MessageSlab::HEAP_CLASS, sizeClass);
+    slab.deallocate(large, sizeClass);
+
+    // 生产者线程分配, 当前线程释放; 生产者退出后其本地缓存归还全局链表
+    std::vector<DBWriteTask> tasks;
+    std::thread producer([&tasks] {
+        for (int i = 0; i < 200; i++) {
+            tasks.emplace_back("INFO", "127.0.0.1", 1, std::string(1000, 'a'));
+        }
+    });
+    producer.join();
+    tasks.clear();
+    EXPECT_GT(slab.globalFreeBlocks(4), 0u);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include "../../DeferredLog.hpp"
+#include <string>
+
+// 按延迟路径编码再渲染, 结果应与直接格式化完全一致
+template <typename ...Args>
+static std::string renderDeferred(const FormatSpec& spec, const Args& ...args) {
+    DeferredLog::Record record;
+    record.spec = &spec;
+    DeferredLog::encodeArgs(record, args...);
+    std::string out;
+    DeferredLog::renderMessage(out, record);
+    return out;
+}
+
+// 测试各类型参数的编码与渲染
+TEST(DeferredLogTest, MatchesEagerFormatting) {
+    const FormatSpec& spec = LOG_FMT("{} {} {} {} {} {} {}");
+    std::string user = "alice";
+    std::string_view ip = "10.0.0.1";
+    unsigned long long big = 18446744073709551615ull;
+
+    std::string expected;
+    FormatDetail::formatTo(expected, spec, user, ip, "GET", 'x', -42, big, 3.14159265);
+    EXPECT_EQ(expected, renderDeferred(spec, user, ip, "GET", 'x', -42, big, 3.14159265));
+}
+
+// 测试参数数量与占位符不一致时的规则与 formatTo 相同
+TEST(DeferredLogTest, ArgumentCountMismatch) {
+    const FormatSpec& spec = LOG_FMT("a={} b={}!");
+    EXPECT_EQ("a=1 b={}!", renderDeferred(spec, 1));
+    EXPECT_EQ("a=1 b=2!3", renderDeferred(spec, 1, 2, 3));
+}
+
+// 测试内联缓冲区放不下时改用溢出存储
+TEST(DeferredLogTest, OverflowForLongArguments) {
+    std::string longText(DeferredLog::Record::INLINE_ARGS_SIZE * 2, 'z');
+    DeferredLog::Record record;
+    record.spec = &LOG_FMT("[{}]");
+    DeferredLog::encodeArgs(record, longText);
+    EXPECT_FALSE(record.overflow.empty());
+
+    std::string out;
+    DeferredLog::renderMessage(out, record);
+    EXPECT_EQ("[" + longText + "]", out);
+
+    // 复用记录编码短参数时回到内联缓冲区
+    DeferredLog::encodeArgs(record, 7);
+    EXPECT_TRUE(record.overflow.empty());
+    out.clear();
+    DeferredLog::renderMessage(out, record);
+    EXPECT_EQ("[7]", out);
+}
+
+// 测试没有格式串描述符时直接输出预先格式化好的消息
+TEST(DeferredLogTest, PreformattedMessage) {
+    DeferredLog::Record record;
+    DeferredLog::encodeArgs(record, std::string_view("already formatted"));
+    std::string out;
+    DeferredLog::renderMessage(out, record);
+    EXPECT_EQ("already formatted", out);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+#include "../../FormatSpec.hpp"
+#include <string>
+
+// 测试编译期拆分出的片段和占位符数量
+TEST(FormatSpecTest, SplitAtCompileTime) {
+    static constexpr FormatSpec spec("User {} login [IP: {}]");
+    static_assert(spec.placeholderCount() == 2, "placeholder count must be computed at compile time");
+
+    EXPECT_EQ("User ", spec.segment(0));
+    EXPECT_EQ(" login [IP: ", spec.segment(1));
+    EXPECT_EQ("]", spec.segment(2));
+}
+
+// 测试 LOG_FMT 返回同一个静态描述符
+TEST(FormatSpecTest, LogFmtReturnsStaticDescriptor) {
+    const FormatSpec* first = nullptr;
+    for (int i = 0; i < 2; i++) {
+        const FormatSpec& spec = LOG_FMT("Task {} done");
+        if (first == nullptr) {
+            first = &spec;
+        }
+        EXPECT_EQ(first, &spec);
+    }
+}
+
+// 测试各类型参数的格式化结果与 std::ostream 一致
+TEST(FormatSpecTest, FormatArguments) {
+    std::string out;
+    FormatDetail::formatTo(out, LOG_FMT("{} {} {} {} {} {}"),
+                           42, -7L, 3.5, std::string("str"), "cstr", 'c');
+    EXPECT_EQ("42 -7 3.5 str cstr c", out);
+
+    out.clear();
+    FormatDetail::formatTo(out, LOG_FMT("ratio={}"), 1.0 / 3.0);
+    EXPECT_EQ("ratio=0.333333", out);
+}
+
+// 测试参数少于/多于占位符时的处理
+TEST(FormatSpecTest, MismatchedArgumentCount) {
+    std::string out;
+    FormatDetail::formatTo(out, LOG_FMT("a={} b={} end"), 1);
+    EXPECT_EQ("a=1 b={} end", out);
+
+    out.clear();
+    FormatDetail::formatTo(out, LOG_FMT("a={} end"), 1, 2);
+    EXPECT_EQ("a=1 end2", out);
+}
+
+// 测试运行期格式串与编译期格式串输出一致
+TEST(FormatSpecTest, RuntimeFormatMatchesCompileTime) {
+    std::string compiled, runtime;
+    FormatDetail::formatTo(compiled, LOG_FMT("Size: {} bytes, Type: {}"), 128, "binary");
+    FormatDetail::formatTo(runtime, std::string_view("Size: {} bytes, Type: {}"), 128, "binary");
+    EXPECT_EQ(compiled, runtime);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include "../../Server/IngestDiagnostics.hpp"
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Server::IngestDiagnostics;
+
+// 单例在测试之间共享, 每个测试从当前计数和报告基准出发
+static IngestDiagnostics& resetDiagnostics(IngestDiagnostics::Verbosity verbosity) {
+    IngestDiagnostics& diagnostics = IngestDiagnostics::getInstance();
+    diagnostics.setVerbosity(verbosity);
+    diagnostics.report(std::chrono::milliseconds(1000));
+    return diagnostics;
+}
+
+TEST(IngestDiagnosticsTest, VerbosityControlsPerMessageEvents) {
+    EXPECT_EQ(IngestDiagnostics::parseVerbosity("QUIET"), IngestDiagnostics::Verbosity::QUIET);
+    EXPECT_EQ(IngestDiagnostics::parseVerbosity("verbose"), IngestDiagnostics::Verbosity::VERBOSE);
+    EXPECT_EQ(IngestDiagnostics::parseVerbosity("unknown"), IngestDiagnostics::Verbosity::SUMMARY);
+
+    IngestDiagnostics& diagnostics = resetDiagnostics(IngestDiagnostics::Verbosity::QUIET);
+    EXPECT_FALSE(diagnostics.traceEvent());
+    EXPECT_FALSE(diagnostics.traceError());
+
+    diagnostics.setVerbosity(IngestDiagnostics::Verbosity::SUMMARY);
+    EXPECT_FALSE(diagnostics.traceEvent());
+
+    diagnostics.setVerbosity(IngestDiagnostics::Verbosity::VERBOSE);
+    uint64_t suppressed = diagnostics.snapshot()[IngestDiagnostics::SUPPRESSED];
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_TRUE(diagnostics.traceEvent());
+    }
+    EXPECT_EQ(diagnostics.snapshot()[IngestDiagnostics::SUPPRESSED], suppressed);
+}
+
+// 采样级别下每秒最多放过 sampleRate 条, 其余只计数
+TEST(IngestDiagnosticsTest, SampledEventsAreRateLimited) {
+    IngestDiagnostics& diagnostics = resetDiagnostics(IngestDiagnostics::Verbosity::SAMPLED);
+    diagnostics.setSampleRate(5);
+    // 避开秒边界, 保证下面的调用落在同一秒内
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    auto intoSecond = now - std::chrono::duration_cast<std::chrono::seconds>(now);
+    if (intoSecond > std::chrono::milliseconds(800)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    }
+
+    uint64_t suppressedBefore = diagnostics.snapshot()[IngestDiagnostics::SUPPRESSED];
+    int traced = 0;
+    for (int i = 0; i < 100; ++i) {
+        traced += diagnostics.traceEvent() ? 1 : 0;
+    }
+    EXPECT_LE(traced, 5);
+    EXPECT_GE(traced, 1);
+    EXPECT_EQ(diagnostics.snapshot()[IngestDiagnostics::SUPPRESSED] - suppressedBefore, static_cast<uint64_t>(100 - traced));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    EXPECT_TRUE(diagnostics.traceEvent());
+}
+
+// 报告只包含上次报告以来的增量, 没有变化时不输出
+TEST(IngestDiagnosticsTest, ReportsDeltasPeriodically) {
+    IngestDiagnostics& diagnostics = resetDiagnostics(IngestDiagnostics::Verbosity::SUMMARY);
+    EXPECT_TRUE(diagnostics.report(std::chrono::milliseconds(1000)).empty());
+
+    diagnostics.add(IngestDiagnostics::LOGS_PARSED, 250);
+    diagnostics.add(IngestDiagnostics::PARSE_ERRORS, 3);
+    std::string line = diagnostics.report(std::chrono::milliseconds(5000));
+    EXPECT_NE(line.find("日志 250 条 (50.0 条/秒)"), std::string::npos) << line;
+    EXPECT_NE(line.find("解析失败 3"), std::string::npos) << line;
+    EXPECT_TRUE(diagnostics.report(std::chrono::milliseconds(1000)).empty());
+
+    std::mutex mutex;
+    std::vector<std::string> lines;
+    diagnostics.setReportSink([&](const std::string& reported) {
+        std::lock_guard<std::mutex> lock(mutex);
+        lines.push_back(reported);
+    });
+    diagnostics.setReportInterval(std::chrono::milliseconds(100));
+    diagnostics.start();
+    diagnostics.add(IngestDiagnostics::LOGS_PARSED, 7);
+    std::this_thread::sleep_for(std::chrono::milliseconds(350));
+    diagnostics.add(IngestDiagnostics::DB_QUEUED, 2);
+    diagnostics.stop();
+    diagnostics.setReportSink(nullptr);
+
+    // 中间空闲的间隔不输出, stop 时报告剩余的增量
+    ASSERT_EQ(lines.size(), 2u);
+    EXPECT_NE(lines[0].find("日志 7 条"), std::string::npos) << lines[0];
+    EXPECT_NE(lines[1].find("入库 2"), std::string::npos) << lines[1];
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
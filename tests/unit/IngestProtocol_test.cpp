@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include "../../Util/IngestProtocol.hpp"
+#include "../../Server/IngestReactor.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace IngestProtocol;
+
+TEST(IngestProtocolTest, DecodesFramesSplitAtAnyByte) {
+    std::vector<std::string> lines = {"<info>[INFO] {first} at 2025-04-09 15:45:45", "", std::string(3000, 'x')};
+    std::string stream = encodeLog("single") + encodeBatch(lines) + encodeAck(42);
+
+    for (size_t step = 1; step <= 7; ++step) {
+        FrameDecoder decoder;
+        std::vector<Frame> frames;
+        for (size_t offset = 0; offset < stream.size(); offset += step) {
+            decoder.feed(stream.data() + offset, std::min(step, stream.size() - offset));
+            Frame frame;
+            while (decoder.next(frame)) {
+                frames.push_back(frame);
+            }
+        }
+        ASSERT_FALSE(decoder.error());
+        ASSERT_EQ(frames.size(), 3u);
+        EXPECT_EQ(decoder.buffered(), 0u);
+
+        EXPECT_EQ(frames[0].type, LOG);
+        EXPECT_EQ(frames[0].payload, "single");
+
+        EXPECT_EQ(frames[1].type, BATCH);
+        std::vector<std::string> records;
+        EXPECT_TRUE(forEachRecord(frames[1].payload, [&](const char* data, size_t size) {
+            records.emplace_back(data, size);
+        }));
+        EXPECT_EQ(records, lines);
+
+        uint64_t count = 0;
+        EXPECT_TRUE(decodeAck(frames[2], count));
+        EXPECT_EQ(count, 42u);
+    }
+}
+
+TEST(IngestProtocolTest, RejectsMalformedInput) {
+    FrameDecoder decoder;
+    std::string text = "[INFO]{legacy text}";
+    decoder.feed(text.data(), text.size());
+    Frame frame;
+    EXPECT_FALSE(decoder.next(frame));
+    EXPECT_TRUE(decoder.error());
+
+    std::string batch = encodeBatch({"a", "b"});
+    std::string payload = batch.substr(HEADER_SIZE, batch.size() - HEADER_SIZE - 1);  // 截掉最后一个字节
+    EXPECT_FALSE(forEachRecord(payload, [](const char*, size_t) {}));
+
+    FrameDecoder oversized;
+    std::string header(1, static_cast<char>(LOG));
+    putUint32(header, MAX_PAYLOAD + 1);
+    oversized.feed(header.data(), header.size());
+    EXPECT_FALSE(oversized.next(frame));
+    EXPECT_TRUE(oversized.error());
+}
+
+// 客户端连续发送不等待响应, 服务器每轮读取只回一次累计确认
+TEST(IngestProtocolTest, PipelinedBatchesAreAckedCumulatively) {
+    int listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(bind(listenFd, (struct sockaddr*)&addr, sizeof(addr)), 0);
+    ASSERT_EQ(listen(listenFd, SOMAXCONN), 0);
+    socklen_t len = sizeof(addr);
+    getsockname(listenFd, (struct sockaddr*)&addr, &len);
+
+    size_t received = 0;
+    Server::IngestReactor reactor(listenFd, [&](const char* data, size_t size, Server::IngestSession& session) {
+        session.decoder.feed(data, size);
+        Frame frame;
+        while (session.decoder.next(frame)) {
+            if (frame.type == LOG) {
+                session.processed++;
+            } else if (frame.type == BATCH) {
+                forEachRecord(frame.payload, [&](const char*, size_t) { session.processed++; });
+            }
+        }
+        received = session.processed;
+        return std::string();
+    });
+    size_t acks = 0;
+    reactor.setReadDoneHandler([&](Server::IngestSession& session) {
+        if (session.processed == session.acked) {
+            return std::string();
+        }
+        session.acked = session.processed;
+        ++acks;
+        return encodeAck(session.acked);
+    });
+    std::thread loop([&]() { reactor.run(); });
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_EQ(connect(fd, (struct sockaddr*)&addr, sizeof(addr)), 0);
+    const size_t batches = 200;
+    const size_t perBatch = 50;
+    std::string stream;
+    for (size_t i = 0; i < batches; ++i) {
+        std::vector<std::string> lines(perBatch, "<info>[INFO] {pipelined " + std::to_string(i) + "} at 2025-04-09 15:45:45");
+        stream += encodeBatch(lines);
+    }
+    // 以奇数大小分段写入, 帧边界与 TCP 分段无关
+    for (size_t offset = 0; offset < stream.size(); offset += 777) {
+        size_t size = std::min<size_t>(777, stream.size() - offset);
+        ASSERT_EQ(send(fd, stream.data() + offset, size, 0), (ssize_t)size);
+    }
+
+    FrameDecoder decoder;
+    uint64_t acked = 0;
+    char buffer[4096];
+    while (acked < batches * perBatch) {
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        ASSERT_GT(n, 0);
+        decoder.feed(buffer, n);
+        Frame frame;
+        while (decoder.next(frame)) {
+            uint64_t count = 0;
+            ASSERT_TRUE(decodeAck(frame, count));
+            EXPECT_GE(count, acked);
+            acked = count;
+        }
+    }
+    EXPECT_EQ(acked, batches * perBatch);
+
+    close(fd);
+    reactor.stop();
+    loop.join();
+    close(listenFd);
+    EXPECT_EQ(received, batches * perBatch);
+    EXPECT_LT(acks, batches * perBatch);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
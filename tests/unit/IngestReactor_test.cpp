@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include "../../Server/IngestReactor.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Server;
+
+class IngestReactorTest : public ::testing::Test {
+protected:
+    int listenFd = -1;
+    int port = 0;
+
+    void SetUp() override {
+        listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        ASSERT_EQ(bind(listenFd, (struct sockaddr*)&addr, sizeof(addr)), 0);
+        ASSERT_EQ(listen(listenFd, SOMAXCONN), 0);
+        socklen_t len = sizeof(addr);
+        getsockname(listenFd, (struct sockaddr*)&addr, &len);
+        port = ntohs(addr.sin_port);
+    }
+
+    void TearDown() override {
+        close(listenFd);
+    }
+
+    int connectClient() {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+};
+
+// 单个事件循环线程同时服务数百个连接, 每条消息得到一次响应
+TEST_F(IngestReactorTest, ServesManyConnectionsOnOneThread) {
+    std::atomic<int> opened{0};
+    std::atomic<int> closed{0};
+    IngestReactor reactor(listenFd, [](const char* data, size_t size, IngestSession& session) {
+        return "ack:" + std::string(data, size) + "#" + std::to_string(session.messageCount) + "\n";
+    });
+    reactor.setSessionHandlers([&](const IngestSession&) { ++opened; },
+                               [&](const IngestSession& session) {
+                                   EXPECT_EQ(session.messageCount, 1u);
+                                   ++closed;
+                               });
+    std::thread loop([&]() { reactor.run(); });
+
+    const int clients = 300;
+    std::vector<int> fds;
+    for (int i = 0; i < clients; ++i) {
+        int fd = connectClient();
+        ASSERT_GE(fd, 0);
+        fds.push_back(fd);
+    }
+    for (int i = 0; i < clients; ++i) {
+        std::string message = "log-" + std::to_string(i);
+        ASSERT_EQ(send(fds[i], message.data(), message.size(), 0), (ssize_t)message.size());
+    }
+    for (int i = 0; i < clients; ++i) {
+        char buffer[64] = {0};
+        ssize_t n = recv(fds[i], buffer, sizeof(buffer) - 1, 0);
+        ASSERT_GT(n, 0);
+        EXPECT_EQ(std::string(buffer, n), "ack:log-" + std::to_string(i) + "#1\n");
+    }
+    EXPECT_EQ(reactor.connectionCount(), (size_t)clients);
+    EXPECT_EQ(opened.load(), clients);
+
+    for (int fd : fds) {
+        close(fd);
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (closed.load() < clients && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(closed.load(), clients);
+    EXPECT_EQ(reactor.connectionCount(), 0u);
+
+    reactor.stop();
+    loop.join();
+}
+
+// 响应超过套接字发送缓冲区时暂存在连接上, 客户端开始读取后全部送达
+TEST_F(IngestReactorTest, BuffersResponsesForSlowReader) {
+    const std::string reply(2 * 1024 * 1024, 'r');
+    IngestReactor reactor(listenFd, [&](const char*, size_t, IngestSession&) { return reply; });
+    std::thread loop([&]() { reactor.run(); });
+
+    int fd = connectClient();
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(send(fd, "x", 1, 0), 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    size_t received = 0;
+    char buffer[65536];
+    while (received < reply.size()) {
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) {
+            break;
+        }
+        received += n;
+    }
+    EXPECT_EQ(received, reply.size());
+
+    close(fd);
+    reactor.stop();
+    loop.join();
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
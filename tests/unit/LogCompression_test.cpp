@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include "../../LogCompression.hpp"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+class LogCompressionTest : public ::testing::Test {
+protected:
+    fs::path dir;
+    fs::path raw;
+    fs::path compressed;
+    std::string content;
+
+    void SetUp() override {
+        dir = fs::temp_directory_path() / "log_compression_test";
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+        raw = dir / "log_20250101_000000.txt";
+        compressed = dir / "log_20250101_000000.txt.gz";
+
+        // 超过两帧的日志内容, 覆盖跨帧读取
+        for (int i = 0; content.size() < LogCompression::FRAME_SIZE * 2 + 12345; i++) {
+            content += "{\"level\": \"INFO\", \"message\": \"line " + std::to_string(i) + "\"}\n";
+        }
+        std::ofstream out(raw, std::ios::binary);
+        out << content;
+    }
+
+    void TearDown() override {
+        fs::remove_all(dir);
+    }
+};
+
+// 测试压缩后完整解压与原文一致, 且体积明显变小
+TEST_F(LogCompressionTest, RoundTrip) {
+    ASSERT_TRUE(LogCompression::compressFile(raw, compressed));
+    EXPECT_TRUE(fs::exists(LogCompression::indexPathFor(compressed)));
+    EXPECT_LT(fs::file_size(compressed) * 5, content.size());
+
+    std::string restored;
+    ASSERT_TRUE(LogCompression::readAll(compressed, restored));
+    EXPECT_EQ(content, restored);
+}
+
+// 测试帧索引: 每帧一条记录, 区间读取可以跨越帧边界
+TEST_F(LogCompressionTest, SeekableRange) {
+    ASSERT_TRUE(LogCompression::compressFile(raw, compressed));
+
+    std::vector<LogCompression::FrameIndexEntry> index;
+    uint64_t rawSize = 0;
+    ASSERT_TRUE(LogCompression::readIndex(compressed, index, rawSize));
+    EXPECT_EQ(content.size(), rawSize);
+    EXPECT_EQ(3u, index.size());
+
+    uint64_t offset = LogCompression::FRAME_SIZE * 2 - 100;
+    std::string range;
+    ASSERT_TRUE(LogCompression::readRange(compressed, offset, 300, range));
+    EXPECT_EQ(content.substr(offset, 300), range);
+
+    // 超出原文末尾时只返回剩余部分
+    ASSERT_TRUE(LogCompression::readRange(compressed, content.size() - 10, 100, range));
+    EXPECT_EQ(content.substr(content.size() - 10), range);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include "../../Util/LogLineParser.hpp"
+#include "../../Util/LogTemplates.hpp"
+#include <map>
+#include <random>
+#include <regex>
+#include <string>
+#include <vector>
+
+using namespace LogLineParser;
+
+// 原来 Server 和 Client 中使用的正则表达式, 作为对照
+static const std::regex ingestPattern(R"(<([^>]+)>\[([^\]]+)\]\s+\{(.*?)\}\s+at\s+([\d-]+\s[\d:]+))");
+static const std::regex htmlPattern(R"(class='([^']+)'>\[(\w+)\]\s+(.*?)\s+at\s+(\d{4}-\d{2}-\d{2} \d{2}:\d{2}:\d{2}))");
+
+static void expectSameAsRegex(const std::string& line, const std::regex& pattern, bool html) {
+    std::smatch match;
+    bool expected = std::regex_search(line, match, pattern);
+    LogLine parsed;
+    bool actual = html ? parseHtmlLine(line, parsed) : parseIngestLine(line, parsed);
+    ASSERT_EQ(actual, expected) << line;
+    if (expected) {
+        EXPECT_EQ(parsed.logClass, match.str(1)) << line;
+        EXPECT_EQ(parsed.level, match.str(2)) << line;
+        EXPECT_EQ(parsed.message, match.str(3)) << line;
+        EXPECT_EQ(parsed.timestamp, match.str(4)) << line;
+    }
+}
+
+// 按 main.cpp 的方式生成消息, 部分占位符不替换, 与实际上报的日志一致
+static std::vector<std::string> templateMessages() {
+    std::vector<std::string> messages;
+    std::mt19937 gen(7);
+    for (const char* type : {"auth", "database", "network", "system"}) {
+        for (int i = 0; i < 50; ++i) {
+            std::string tmpl = LogTemplates::getRandomTemplate(type);
+            std::map<std::string, std::string> values = {
+                {"user", "alice"}, {"ip", "10.0.0." + std::to_string(i)}, {"table", "orders"},
+                {"endpoint", "/api/logs"}, {"method", "GET"}, {"size", std::to_string(gen() % 4096)},
+                {"task", "process_bitmap"}, {"status", i % 2 ? "failed" : "ok"}};
+            messages.push_back(LogTemplates::replacePlaceholders(tmpl, values));
+        }
+    }
+    return messages;
+}
+
+TEST(LogLineParserTest, IngestLinesMatchRegex) {
+    for (const auto& message : templateMessages()) {
+        std::string line = "<log info>[INFO] {" + message + "} at 2025-04-09 15:45:45";
+        expectSameAsRegex(line, ingestPattern, false);
+        expectSameAsRegex("noise " + line + " trailing", ingestPattern, false);
+    }
+
+    LogLine parsed;
+    ASSERT_TRUE(parseIngestLine("<log warning>[WARNING] {Duration: {time}ms - Exception: a } b} at 2025-04-09 15:45:45", parsed));
+    EXPECT_EQ(parsed.level, "WARNING");
+    EXPECT_EQ(parsed.message, "Duration: {time}ms - Exception: a } b");
+    EXPECT_EQ(parsed.timestamp, "2025-04-09 15:45:45");
+}
+
+TEST(LogLineParserTest, HtmlLinesMatchRegex) {
+    for (const auto& message : templateMessages()) {
+        std::string line = "<div class='log error'>[ERROR] " + message + " at 2025-04-09 15:45:45</div>";
+        expectSameAsRegex(line, htmlPattern, true);
+    }
+}
+
+TEST(LogLineParserTest, EdgeCasesMatchRegex) {
+    const std::vector<std::string> ingest = {
+        "",
+        "[INFO]{legacy text client}",
+        "<>[INFO] {empty class} at 2025-04-09 15:45:45",
+        "<a>[] {empty level} at 2025-04-09 15:45:45",
+        "<a>[INFO]{no space} at 2025-04-09 15:45:45",
+        "<a>[INFO] {no timestamp}",
+        "<a>[INFO] {bad stamp} at 2025-04-09T15:45:45",
+        "<a>[INFO] {short stamp} at 1 2",
+        "<a <b>[INFO] {nested class} at 2025-04-09 15:45:45",
+        "<x>oops <a>[INFO] {second start} at 2025-04-09 15:45:45",
+        "<a>[INFO] {line\nbreak} at 2025-04-09 15:45:45",
+        "<a>[INFO] {first} at 2025-04-09 15:45:45 <b>[ERROR] {second} at 2025-04-09 15:45:46",
+        "<a>[INFO] \t{tabs}\t\tat\t2025-04-09\t15:45:45",
+    };
+    for (const auto& line : ingest) {
+        expectSameAsRegex(line, ingestPattern, false);
+    }
+
+    const std::vector<std::string> html = {
+        "<div class=''>[INFO] empty class at 2025-04-09 15:45:45</div>",
+        "<div class='log info'>[INFO]no space at 2025-04-09 15:45:45</div>",
+        "<div class='log info'>[IN-FO] bad level at 2025-04-09 15:45:45</div>",
+        "<div class='log info'>[INFO] message at 2025-4-09 15:45:45</div>",
+        "<div class='log info'>[INFO] at home at 2025-04-09 15:45:45</div>",
+        "<div class='log info'>[INFO] x  at  2025-04-09 15:45:45</div>",
+        "<p class='x'>y</p><div class='log info'>[INFO] second class at 2025-04-09 15:45:45</div>",
+        "<div class='log info'>[INFO] message at 2025-04-09 15:45</div>",
+    };
+    for (const auto& line : html) {
+        expectSameAsRegex(line, htmlPattern, true);
+    }
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
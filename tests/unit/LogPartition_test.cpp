@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include "../../MySQL/LogPartition.hpp"
+#include <string>
+#include <vector>
+
+// 2025-04-09 15:45:45 UTC
+static const int64_t NOW = 1744213545;
+static const int64_t DAY = 86400;
+static const int64_t TODAY = 1744156800;    // 2025-04-09 00:00:00 UTC
+
+TEST(LogPartitionTest, NamesAlignToUtcBoundaries) {
+    EXPECT_EQ(LogPartition::alignDown(NOW, PartitionUnit::DAY), TODAY);
+    EXPECT_EQ(LogPartition::alignDown(NOW, PartitionUnit::HOUR), TODAY + 15 * 3600);
+    EXPECT_EQ(LogPartition::partitionName(TODAY, PartitionUnit::DAY), "p20250409");
+    EXPECT_EQ(LogPartition::partitionName(TODAY + 15 * 3600, PartitionUnit::HOUR), "p2025040915");
+}
+
+TEST(LogPartitionTest, InitialPlanCoversPrecreateWindow) {
+    PartitionOptions options;
+    options.precreate = 2;
+    PartitionPlan plan = LogPartition::planPartitions({}, NOW, options);
+
+    ASSERT_EQ(plan.add.size(), 3u);
+    EXPECT_EQ(plan.add[0].name, "p20250409");
+    EXPECT_EQ(plan.add[0].lessThan, TODAY + DAY);
+    EXPECT_EQ(plan.add[2].name, "p20250411");
+    EXPECT_TRUE(plan.drop.empty());
+
+    std::string sql = LogPartition::createTableSql(options, NOW);
+    EXPECT_NE(sql.find("PARTITION BY RANGE (UNIX_TIMESTAMP(timestamp))"), std::string::npos);
+    EXPECT_NE(sql.find("PRIMARY KEY (id, timestamp)"), std::string::npos);
+    EXPECT_NE(sql.find("PARTITION pmax VALUES LESS THAN MAXVALUE"), std::string::npos);
+}
+
+TEST(LogPartitionTest, SteadyStateAddsAheadAndDropsExpired) {
+    PartitionOptions options;
+    options.precreate = 1;
+    options.retention = 2;
+
+    // 已有 04-06 ~ 04-09 四个分区和 pmax
+    std::vector<PartitionInfo> existing;
+    for (int i = -3; i <= 0; ++i) {
+        existing.push_back({LogPartition::partitionName(TODAY + i * DAY, PartitionUnit::DAY), TODAY + (i + 1) * DAY});
+    }
+    existing.push_back({"pmax", 0});
+
+    PartitionPlan plan = LogPartition::planPartitions(existing, NOW, options);
+    ASSERT_EQ(plan.add.size(), 1u);
+    EXPECT_EQ(plan.add[0].name, "p20250410");
+    EXPECT_TRUE(plan.hasMax);
+    // 保留 2 天: 边界不晚于 04-07 15:45:45 的 04-06 分区过期
+    ASSERT_EQ(plan.drop.size(), 1u);
+    EXPECT_EQ(plan.drop[0], "p20250406");
+
+    std::vector<std::string> statements = LogPartition::alterStatements(plan);
+    ASSERT_EQ(statements.size(), 2u);
+    EXPECT_EQ(statements[0].find("ALTER TABLE log_table REORGANIZE PARTITION pmax INTO"), 0u);
+    EXPECT_EQ(statements[1], "ALTER TABLE log_table DROP PARTITION p20250406");
+
+    // 已补齐时无需变更
+    existing.insert(existing.end() - 1, plan.add[0]);
+    existing.erase(existing.begin());
+    EXPECT_TRUE(LogPartition::planPartitions(existing, NOW, options).empty());
+}
+
+TEST(LogPartitionTest, LongOutageCollapsesGapIntoOnePartition) {
+    PartitionOptions options;
+    options.unit = PartitionUnit::HOUR;
+    options.precreate = 0;
+    options.retention = 0;
+
+    // 最后一个分区止于 30 天前, 中间的空档合并为一个分区
+    std::vector<PartitionInfo> existing = {{"p2025031000", TODAY - 30 * DAY}};
+    PartitionPlan plan = LogPartition::planPartitions(existing, NOW, options);
+
+    ASSERT_EQ(plan.add.size(), 2u);
+    EXPECT_EQ(plan.add[0].lessThan, TODAY + 15 * 3600);
+    EXPECT_EQ(plan.add[1].name, "p2025040915");
+    EXPECT_FALSE(plan.hasMax);
+    EXPECT_TRUE(plan.drop.empty());
+    EXPECT_EQ(LogPartition::alterStatements(plan)[0].find("ALTER TABLE log_table ADD PARTITION ("), 0u);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include "../../LogQueue.hpp"
+#include <thread>
+#include <vector>
+#include <set>
+
+// 测试容量按2的幂向上取整
+TEST(LogQueueTest, CapacityRoundedToPowerOfTwo) {
+    LogQueue queue(100);
+    EXPECT_EQ(128u, queue.capacity());
+}
+
+// 测试单线程下的先进先出顺序
+TEST(LogQueueTest, PushPopOrder) {
+    LogQueue queue(8);
+    for (int i = 0; i < 5; i++) {
+        EXPECT_TRUE(queue.push("msg" + std::to_string(i)));
+    }
+
+    std::string msg;
+    for (int i = 0; i < 5; i++) {
+        ASSERT_TRUE(queue.try_pop(msg));
+        EXPECT_EQ("msg" + std::to_string(i), msg);
+    }
+    EXPECT_FALSE(queue.try_pop(msg));
+}
+
+// 测试 DROP_NEWEST 策略: 队列满后丢弃新日志
+TEST(LogQueueTest, DropNewestWhenFull) {
+    LogQueue queue(4, QueueFullPolicy::DROP_NEWEST);
+    for (int i = 0; i < 4; i++) {
+        EXPECT_TRUE(queue.push(std::to_string(i)));
+    }
+    EXPECT_FALSE(queue.push("overflow"));
+    EXPECT_EQ(1u, queue.dropped());
+
+    std::string msg;
+    ASSERT_TRUE(queue.try_pop(msg));
+    EXPECT_EQ("0", msg);
+}
+
+// 测试 DROP_OLDEST 策略: 队列满后丢弃队头
+TEST(LogQueueTest, DropOldestWhenFull) {
+    LogQueue queue(4, QueueFullPolicy::DROP_OLDEST);
+    for (int i = 0; i < 6; i++) {
+        EXPECT_TRUE(queue.push(std::to_string(i)));
+    }
+    EXPECT_EQ(2u, queue.dropped());
+
+    std::string msg;
+    ASSERT_TRUE(queue.try_pop(msg));
+    EXPECT_EQ("2", msg);
+}
+
+// 测试停止后 pop 先取完剩余日志再返回 false
+TEST(LogQueueTest, StopDrainsRemaining) {
+    LogQueue queue(8);
+    queue.push("last");
+    queue.stop();
+
+    std::string msg;
+    EXPECT_TRUE(queue.pop(msg));
+    EXPECT_EQ("last", msg);
+    EXPECT_FALSE(queue.pop(msg));
+}
+
+// 测试多生产者单消费者场景下不丢失、不重复
+TEST(LogQueueTest, MultiProducerSingleConsumer) {
+    constexpr int numProducers = 8;
+    constexpr int messagesPerProducer = 10000;
+    LogQueue queue(1024, QueueFullPolicy::BLOCK);
+
+    std::set<std::string> received;
+    std::thread consumer([&queue, &received]() {
+        std::string msg;
+        while (queue.pop(msg)) {
+            received.insert(msg);
+        }
+    });
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < numProducers; p++) {
+        producers.emplace_back([&queue, p]() {
+            for (int i = 0; i < messagesPerProducer; i++) {
+                queue.push(std::to_string(p) + ":" + std::to_string(i));
+            }
+        });
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+    queue.stop();
+    consumer.join();
+
+    EXPECT_EQ(static_cast<size_t>(numProducers * messagesPerProducer), received.size());
+    EXPECT_EQ(0u, queue.dropped());
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include "../../MySQL/LogStats.hpp"
+#include "../mocks/FakeMySQL.hpp"
+#include <algorithm>
+#include <string>
+
+// 真实的 LogStats 通过 FakeMySQL 刷新汇总表
+class LogStatsFlushTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        FakeMySQL::reset();
+        conn = mysql_real_connect(mysql_init(nullptr), "", "", "", "", 0, nullptr, 0);
+        ASSERT_NE(conn, nullptr);
+        // 从汇总表读取的累计值: INFO 100 条
+        FakeMySQL::setQueryResult("SELECT level, count FROM log_stats_total", {{"INFO", "100"}});
+        ASSERT_TRUE(LogStats::getInstance().refresh(conn));
+    }
+
+    void TearDown() override {
+        mysql_close(conn);
+    }
+
+    static uint64_t infoTotal() {
+        LogStats::Counts counts{};
+        EXPECT_TRUE(LogStats::getInstance().totals(counts));
+        return counts[LogStats::levelIndex("INFO")];
+    }
+
+    // 汇总表写入过程中(提交之前)读到的 INFO 累计值
+    static void watchTotalInsert(uint64_t& seen) {
+        FakeMySQL::setQueryHook([&seen](const std::string& sql) {
+            if (sql.rfind("INSERT INTO log_stats_total", 0) == 0) {
+                seen = infoTotal();
+            }
+        });
+    }
+
+    MYSQL* conn = nullptr;
+};
+
+// flush 取走的增量在事务提交前仍计入 totals, 提交后转入累计值
+TEST_F(LogStatsFlushTest, TotalsIncludeInFlightCounts) {
+    LogStats::getInstance().record(LogStats::levelIndex("INFO"), 5);
+    EXPECT_EQ(infoTotal(), 105u);
+
+    uint64_t seen = 0;
+    watchTotalInsert(seen);
+    EXPECT_TRUE(LogStats::getInstance().flush(conn));
+    EXPECT_EQ(seen, 105u);
+    EXPECT_EQ(infoTotal(), 105u);
+}
+
+// 写入失败时增量放回, 期间和之后 totals 都不减少
+TEST_F(LogStatsFlushTest, FailedFlushKeepsCounts) {
+    LogStats::getInstance().record(LogStats::levelIndex("INFO"), 3);
+    FakeMySQL::failQueries("INSERT INTO log_stats_total", 1205);
+
+    uint64_t seen = 0;
+    watchTotalInsert(seen);
+    EXPECT_FALSE(LogStats::getInstance().flush(conn));
+    EXPECT_EQ(seen, 103u);
+    EXPECT_EQ(infoTotal(), 103u);
+
+    FakeMySQL::failQueries("INSERT INTO log_stats_total", 0);
+    EXPECT_TRUE(LogStats::getInstance().flush(conn));
+    EXPECT_EQ(infoTotal(), 103u);
+}
+
+// 删除分区时按分区内的实际行数扣减, 包括按历史时间戳回放写入的行
+TEST_F(LogStatsFlushTest, ExpireSubtractsPartitionRowCounts) {
+    FakeMySQL::setQueryResult("SELECT level, COUNT(*) FROM log_table PARTITION", {{"INFO", "40"}});
+    LogStats::Counts expired{};
+    ASSERT_TRUE(LogStats::getInstance().countPartitions(conn, {"p20250409"}, expired));
+    EXPECT_EQ(expired[LogStats::levelIndex("INFO")], 40u);
+
+    FakeMySQL::setQueryResult("SELECT level, count FROM log_stats_total", {{"INFO", "60"}});
+    ASSERT_TRUE(LogStats::getInstance().expireBefore(conn, 1744243200, expired));
+    auto queries = FakeMySQL::queries();
+    EXPECT_NE(std::find(queries.begin(), queries.end(), LogStats::buildTotalSubtract(expired)), queries.end());
+    EXPECT_NE(std::find(queries.begin(), queries.end(),
+                        "DELETE FROM log_stats WHERE minute < FROM_UNIXTIME(1744243200)"), queries.end());
+    EXPECT_EQ(infoTotal(), 60u);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
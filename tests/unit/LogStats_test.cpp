@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include "../../MySQL/LogStats.hpp"
+#include <string>
+
+TEST(LogStatsTest, LevelIndexMatchesEnumOrder) {
+    EXPECT_EQ(LogStats::levelIndex("TRACE"), 0);
+    EXPECT_EQ(LogStats::levelIndex("WARNING"), 3);
+    EXPECT_EQ(LogStats::levelIndex("FATAL"), 5);
+    EXPECT_EQ(LogStats::levelIndex("NORMAL"), -1);
+    EXPECT_STREQ(LogStats::levelName(4), "ERROR");
+}
+
+TEST(LogStatsTest, MinuteInsertSkipsEmptyLevels) {
+    LogStats::MinuteCounts minutes;
+    minutes[1744213500][2] = 10;    // INFO
+    minutes[1744213560][4] = 3;     // ERROR
+
+    std::string sql = LogStats::buildMinuteInsert(minutes);
+    EXPECT_EQ(sql, "INSERT INTO log_stats (minute, level, count) VALUES "
+                   "(FROM_UNIXTIME(1744213500), 'INFO', 10), (FROM_UNIXTIME(1744213560), 'ERROR', 3) "
+                   "ON DUPLICATE KEY UPDATE count = count + VALUES(count)");
+    EXPECT_TRUE(LogStats::buildMinuteInsert(LogStats::MinuteCounts()).empty());
+}
+
+TEST(LogStatsTest, TotalInsertAccumulates) {
+    LogStats::Counts counts{};
+    counts[3] = 7;
+    EXPECT_EQ(LogStats::buildTotalInsert(counts),
+              "INSERT INTO log_stats_total (level, count) VALUES ('WARNING', 7) "
+              "ON DUPLICATE KEY UPDATE count = count + VALUES(count)");
+    EXPECT_TRUE(LogStats::buildTotalInsert(LogStats::Counts{}).empty());
+}
+
+TEST(LogStatsTest, PartitionCountAndSubtract) {
+    EXPECT_EQ(LogStats::buildPartitionCount({"p20250409", "p20250410"}),
+              "SELECT level, COUNT(*) FROM log_table PARTITION (p20250409, p20250410) GROUP BY level");
+
+    LogStats::Counts counts{};
+    counts[2] = 40;     // INFO
+    counts[4] = 2;      // ERROR
+    EXPECT_EQ(LogStats::buildTotalSubtract(counts),
+              "UPDATE log_stats_total SET count = CASE level "
+              "WHEN 'INFO' THEN IF(count > 40, count - 40, 0) "
+              "WHEN 'ERROR' THEN IF(count > 2, count - 2, 0) "
+              "ELSE count END WHERE level IN ('INFO', 'ERROR')");
+    EXPECT_TRUE(LogStats::buildTotalSubtract(LogStats::Counts{}).empty());
+}
+
+TEST(LogStatsTest, TotalsUnavailableBeforeLoad) {
+    // 未连接数据库读取累计值前, 统计接口应退回直接查询
+    LogStats::getInstance().record(LogStats::levelIndex("INFO"), 5);
+    LogStats::Counts counts;
+    EXPECT_FALSE(LogStats::getInstance().totals(counts));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include "../../Logger.hpp"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+class LoggerRotationTest : public ::testing::Test {
+protected:
+    fs::path logDir;
+
+    void SetUp() override {
+        logDir = fs::temp_directory_path() / "logger_rotation_test";
+        fs::remove_all(logDir);
+    }
+
+    void TearDown() override {
+        fs::remove_all(logDir);
+    }
+
+    size_t countArchives() {
+        size_t count = 0;
+        for (const auto& entry : fs::directory_iterator(logDir)) {
+            if (entry.path().filename().string().rfind("log_", 0) == 0) {
+                count++;
+            }
+        }
+        return count;
+    }
+};
+
+// 测试写满 maxBytes 后自动轮转, 且只保留 maxFiles 个历史文件
+TEST_F(LoggerRotationTest, RotateBySizeAndPrune) {
+    fs::path logPath = logDir / "log.txt";
+    {
+        Logger logger(logPath.string(), false, LoggerMode::DEDICATED_WRITER);
+        RotationPolicy policy;
+        policy.maxBytes = 4096;
+        policy.maxFiles = 2;
+        logger.setRotationPolicy(policy);
+
+        for (int i = 0; i < 2000; i++) {
+            logger.log_in_text(INFO, LOG_FMT("rotation test line {}"), i);
+            if (i % 100 == 0) {
+                // 让写线程分多批写入, 每批之后都会检查是否需要轮转
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+        }
+    }
+
+    EXPECT_TRUE(fs::exists(logPath));
+    EXPECT_FALSE(fs::exists(logDir / "log.txt.next"));
+    EXPECT_LE(countArchives(), 2u);
+    EXPECT_GE(countArchives(), 1u);
+}
+
+// 测试线程池模式下轮转: 析构时仍有工作线程在写入并触发轮转, 停止记录写在最后
+TEST_F(LoggerRotationTest, RotateInThreadPoolMode) {
+    fs::path logPath = logDir / "log.txt";
+    {
+        Logger logger(logPath.string(), false, LoggerMode::THREAD_POOL);
+        RotationPolicy policy;
+        policy.maxBytes = 4096;
+        policy.maxFiles = 3;
+        logger.setRotationPolicy(policy);
+
+        for (int i = 0; i < 2000; i++) {
+            logger.log_in_text(INFO, LOG_FMT("thread pool rotation line {}"), i);
+        }
+    }
+
+    EXPECT_TRUE(fs::exists(logPath));
+    EXPECT_FALSE(fs::exists(logDir / "log.txt.next"));
+    EXPECT_GE(countArchives(), 1u);
+
+    std::ifstream in(logPath);
+    std::string line, last;
+    while (std::getline(in, line)) {
+        if (!line.empty()) {
+            last = line;
+        }
+    }
+    EXPECT_EQ(0u, last.rfind("[SYSTEM] Logger stopped at ", 0));
+}
+
+// 测试开启压缩后历史文件由后台线程压缩为 .gz 并生成帧索引
+TEST_F(LoggerRotationTest, CompressRotatedFiles) {
+    fs::path logPath = logDir / "log.txt";
+    {
+        Logger logger(logPath.string(), false, LoggerMode::DEDICATED_WRITER);
+        RotationPolicy policy;
+        policy.maxBytes = 4096;
+        policy.compress = true;
+        logger.setRotationPolicy(policy);
+
+        for (int i = 0; i < 500; i++) {
+            logger.log_in_text(INFO, LOG_FMT("compression test line {}"), i);
+            if (i % 100 == 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+        }
+    }
+
+    size_t compressed = 0;
+    for (const auto& entry : fs::directory_iterator(logDir)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind("log_", 0) == 0) {
+            EXPECT_TRUE(LogCompression::isCompressed(entry.path()) || entry.path().extension() == ".idx");
+            if (LogCompression::isCompressed(entry.path())) {
+                compressed++;
+                std::string content;
+                EXPECT_TRUE(LogCompression::readAll(entry.path(), content));
+                EXPECT_NE(std::string::npos, content.find("compression test line"));
+            }
+        }
+    }
+    EXPECT_GE(compressed, 1u);
+}
+
+// 测试 getLogFileSize 使用运行计数且与实际文件大小一致
+TEST_F(LoggerRotationTest, RunningByteCounter) {
+    fs::path logPath = logDir / "log.txt";
+    Logger logger(logPath.string(), false, LoggerMode::DEDICATED_WRITER);
+    for (int i = 0; i < 100; i++) {
+        logger.log_in_text(INFO, LOG_FMT("counter line {}"), i);
+    }
+
+    for (int i = 0; i < 100 && logger.getLogFileSize() != fs::file_size(logPath); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(fs::file_size(logPath), logger.getLogFileSize());
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
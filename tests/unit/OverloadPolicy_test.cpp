@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+#include "../../LogMessage/OverloadPolicy.hpp"
+#include <string>
+
+// 测试低于高水位时所有等级都被接收
+TEST(OverloadPolicyTest, AdmitAllBelowWatermark) {
+    OverloadController controller(OverloadPolicy(), 100);
+    for (LOG_LEVEL level = 0; level < LOG_LEVEL_COUNT; level++) {
+        EXPECT_TRUE(controller.admit(level, 79));
+    }
+    EXPECT_EQ(0u, controller.totalDropped());
+}
+
+// 测试超过高水位后 DEBUG 被丢弃, INFO 被采样, WARNING 以上继续接收
+TEST(OverloadPolicyTest, ShedLowLevelsFirst) {
+    OverloadPolicy policy;
+    policy.sampleRate = 4;
+    OverloadController controller(policy, 100);
+
+    EXPECT_FALSE(controller.admit(DEBUG, 80));
+    EXPECT_TRUE(controller.admit(ERROR, 100));
+    EXPECT_TRUE(controller.admit(WARNING, 100));
+
+    int kept = 0;
+    for (int i = 0; i < 40; i++) {
+        if (controller.admit(INFO, 90)) {
+            kept++;
+        }
+    }
+    EXPECT_EQ(10, kept);
+    EXPECT_EQ(1u, controller.dropped(DEBUG));
+    EXPECT_EQ(30u, controller.dropped(INFO));
+
+    // 容量用尽时采样等级也全部丢弃
+    EXPECT_FALSE(controller.admit(INFO, 100));
+}
+
+// 测试汇总行包含各等级丢弃数, 输出后区间计数清零
+TEST(OverloadPolicyTest, PeriodicSummary) {
+    OverloadPolicy policy;
+    policy.summaryInterval = std::chrono::seconds(0);
+    OverloadController controller(policy, 10);
+
+    std::string line;
+    EXPECT_FALSE(controller.takeSummary("Test", line));
+
+    controller.recordDrop(DEBUG);
+    controller.recordDrop(DEBUG);
+    controller.recordDrop(INFO);
+    ASSERT_TRUE(controller.takeSummary("Test", line));
+    EXPECT_NE(std::string::npos, line.find("[OVERLOAD] Test: dropped 3 lines"));
+    EXPECT_NE(std::string::npos, line.find("INFO=1 DEBUG=2"));
+    EXPECT_NE(std::string::npos, line.find("total 3"));
+
+    EXPECT_FALSE(controller.takeSummary("Test", line));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include "../../MySQL/SqlConnPool.hpp"
+#include "../../MySQL/LogPartition.hpp"
+#include "../mocks/FakeMySQL.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <thread>
+#include <vector>
+
+// 真实的 SqlConnPool 通过 FakeMySQL 建立连接, 检查按需增长、等待超时和空闲收缩
+class SqlConnPoolSizingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        FakeMySQL::reset();
+        // 汇总表不可用、不分区: init 不启动汇总刷新和分区维护线程, 池中只有测试自己取用的连接
+        FakeMySQL::failQueries("SELECT COUNT(*) FROM log_stats_total", 1146);
+        PartitionOptions partitions;
+        partitions.unit = PartitionUnit::NONE;
+        LogPartitionManager::getInstance().setOptions(partitions);
+    }
+
+    void TearDown() override {
+        releaseAll();
+        pool()->destroyPool();
+    }
+
+    static SqlConnPool* pool() { return SqlConnPool::getInstance(); }
+
+    void startPool(int minConn, int maxConn, std::chrono::milliseconds checkoutTimeout,
+                   std::chrono::milliseconds idleTimeout = std::chrono::milliseconds(60000)) {
+        SqlPoolOptions options;
+        options.minConn = minConn;
+        options.checkoutTimeout = checkoutTimeout;
+        options.idleTimeout = idleTimeout;
+        pool()->setPoolOptions(options);
+        ASSERT_TRUE(pool()->init("localhost", "test_user", "test_password", "test_db", 3306, maxConn));
+        before = pool()->getStats();
+    }
+
+    MYSQL* take() {
+        MYSQL* conn = pool()->getConnection();
+        if (conn) {
+            held.push_back(conn);
+        }
+        return conn;
+    }
+
+    void releaseAll() {
+        for (MYSQL* conn : held) {
+            pool()->releaseConnection(conn);
+        }
+        held.clear();
+    }
+
+    std::vector<MYSQL*> held;
+    SqlPoolStats before;        // init 完成时的计数, 各测试比较增量
+};
+
+// 初始只建立 minConn 条连接, 没有空闲连接时按需新建, 直到 maxConn
+TEST_F(SqlConnPoolSizingTest, GrowsOnDemandUpToMax) {
+    startPool(1, 3, std::chrono::milliseconds(200));
+    EXPECT_EQ(before.totalConn, 1);
+    EXPECT_EQ(before.idleConn, 1);
+    EXPECT_EQ(FakeMySQL::openConnections(), 1);
+
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_NE(take(), nullptr);
+    }
+    SqlPoolStats stats = pool()->getStats();
+    EXPECT_EQ(stats.totalConn, 3);
+    EXPECT_EQ(stats.inUseConn, 3);
+    EXPECT_EQ(stats.idleConn, 0);
+    EXPECT_EQ(stats.peakInUse, 3);
+    EXPECT_EQ(stats.created - before.created, 2u);
+    EXPECT_EQ(stats.checkouts - before.checkouts, 3u);
+    EXPECT_EQ(FakeMySQL::openConnections(), 3);
+}
+
+// 达到上限后等待 checkoutTimeout, 超时返回 nullptr 并计数
+TEST_F(SqlConnPoolSizingTest, CheckoutTimesOutAtMax) {
+    startPool(1, 2, std::chrono::milliseconds(150));
+    ASSERT_NE(take(), nullptr);
+    ASSERT_NE(take(), nullptr);
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(pool()->getConnection(), nullptr);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(140));
+
+    SqlPoolStats stats = pool()->getStats();
+    EXPECT_EQ(stats.timeouts - before.timeouts, 1u);
+    EXPECT_EQ(stats.totalConn, 2);
+    EXPECT_EQ(FakeMySQL::openConnections(), 2);
+}
+
+// 等待中的线程在有连接归还时取得该连接, 不新建
+TEST_F(SqlConnPoolSizingTest, WaiterReceivesReleasedConnection) {
+    startPool(1, 1, std::chrono::milliseconds(2000));
+    MYSQL* first = take();
+    ASSERT_NE(first, nullptr);
+
+    auto waiter = std::async(std::launch::async, [] { return pool()->getConnection(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(pool()->getStats().waiters, 1);
+    releaseAll();
+
+    MYSQL* second = waiter.get();
+    EXPECT_EQ(second, first);
+    held.push_back(second);
+    EXPECT_EQ(pool()->getStats().timeouts, before.timeouts);
+}
+
+// 多于 minConn 的连接空闲超过 idleTimeout 后由维护线程(每秒一次)关闭
+TEST_F(SqlConnPoolSizingTest, ShrinksIdleConnectionsToMin) {
+    startPool(1, 4, std::chrono::milliseconds(200), std::chrono::milliseconds(100));
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_NE(take(), nullptr);
+    }
+    releaseAll();
+    EXPECT_EQ(pool()->getStats().totalConn, 3);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+    while (pool()->getStats().totalConn > 1 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    SqlPoolStats stats = pool()->getStats();
+    EXPECT_EQ(stats.totalConn, 1);
+    EXPECT_EQ(stats.idleConn, 1);
+    EXPECT_EQ(stats.closed - before.closed, 2u);
+    EXPECT_EQ(FakeMySQL::openConnections(), 1);
+}
+
+// DB_POOL_MAX 优先于 init 传入的连接数
+TEST_F(SqlConnPoolSizingTest, EnvMaxOverridesConnSize) {
+    setenv("DB_POOL_MAX", "2", 1);
+    startPool(1, 5, std::chrono::milliseconds(100));
+    unsetenv("DB_POOL_MAX");
+
+    ASSERT_NE(take(), nullptr);
+    ASSERT_NE(take(), nullptr);
+    EXPECT_EQ(pool()->getConnection(), nullptr);
+    EXPECT_EQ(pool()->getStats().totalConn, 2);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
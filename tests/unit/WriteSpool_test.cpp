@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include "../../Server/WriteSpool.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace AsyncDBWriterSpace;
+namespace fs = std::filesystem;
+
+class WriteSpoolTest : public ::testing::Test {
+protected:
+    fs::path spoolDir;
+    SpoolOptions options;
+
+    void SetUp() override {
+        spoolDir = fs::temp_directory_path() / "write_spool_test";
+        fs::remove_all(spoolDir);
+        options.directory = spoolDir.string();
+    }
+
+    void TearDown() override {
+        fs::remove_all(spoolDir);
+    }
+
+    std::vector<fs::path> segments() {
+        std::vector<fs::path> files;
+        for (const auto& entry : fs::directory_iterator(spoolDir)) {
+            if (entry.path().extension() == ".dat") {
+                files.push_back(entry.path());
+            }
+        }
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+    static std::vector<DBWriteTask> makeTasks(int count, int start = 0) {
+        std::vector<DBWriteTask> tasks;
+        for (int i = start; i < start + count; i++) {
+            tasks.emplace_back("ERROR", "10.0.0.1", 9000 + i, "message " + std::to_string(i), "2025-04-09 15:45:45");
+        }
+        return tasks;
+    }
+};
+
+// 测试追加后按原样读回, 未确认前重复读取同一批, 全部确认后删除分段
+TEST_F(WriteSpoolTest, AppendReadCommit) {
+    WriteSpool spool(options);
+    ASSERT_TRUE(spool.open());
+    std::vector<DBWriteTask> tasks = makeTasks(3);
+    ASSERT_TRUE(spool.append(tasks.data(), tasks.size()));
+
+    std::vector<DBWriteTask> batch;
+    EXPECT_EQ(2u, spool.read(batch, 2));
+    EXPECT_STREQ("ERROR", batch[0].levelName());
+    EXPECT_EQ("10.0.0.1", batch[0].clientIP());
+    EXPECT_EQ(9001, batch[1].clientPort);
+    EXPECT_EQ("message 1", batch[1].message.view());
+    EXPECT_EQ("2025-04-09 15:45:45", batch[1].timestampView());
+
+    batch.clear();
+    EXPECT_EQ(2u, spool.read(batch, 2));
+    EXPECT_EQ("message 0", batch[0].message.view());
+    spool.commit();
+
+    batch.clear();
+    EXPECT_EQ(1u, spool.read(batch, 10));
+    EXPECT_EQ("message 2", batch[0].message.view());
+    spool.commit();
+
+    EXPECT_EQ(0u, spool.pendingBytes());
+    EXPECT_TRUE(segments().empty());
+}
+
+// 测试重启后从检查点继续, 末尾不完整的记录被截断
+TEST_F(WriteSpoolTest, RecoverFromCheckpoint) {
+    {
+        WriteSpool spool(options);
+        ASSERT_TRUE(spool.open());
+        std::vector<DBWriteTask> tasks = makeTasks(5);
+        ASSERT_TRUE(spool.append(tasks.data(), tasks.size()));
+        std::vector<DBWriteTask> batch;
+        EXPECT_EQ(2u, spool.read(batch, 2));
+        spool.commit();
+    }
+
+    // 模拟崩溃时写了一半的记录
+    ASSERT_EQ(1u, segments().size());
+    std::ofstream(segments()[0], std::ios::app | std::ios::binary) << std::string("\x40\x00\x00\x00partial", 11);
+
+    WriteSpool spool(options);
+    ASSERT_TRUE(spool.open());
+    std::vector<DBWriteTask> more = makeTasks(1, 5);
+    ASSERT_TRUE(spool.append(more.data(), more.size()));
+    EXPECT_EQ(2u, segments().size());
+
+    std::vector<DBWriteTask> batch;
+    EXPECT_EQ(4u, spool.read(batch, 10));
+    EXPECT_EQ("message 2", batch[0].message.view());
+    EXPECT_EQ("message 4", batch[2].message.view());
+    EXPECT_EQ("message 5", batch[3].message.view());
+    spool.commit();
+    EXPECT_EQ(0u, spool.pendingBytes());
+}
+
+// 测试超过分段大小后换新分段, 读取跨越分段, 读完的分段被删除
+TEST_F(WriteSpoolTest, RotateSegments) {
+    options.segmentBytes = 200;
+    WriteSpool spool(options);
+    ASSERT_TRUE(spool.open());
+    for (int i = 0; i < 10; i++) {
+        std::vector<DBWriteTask> tasks = makeTasks(1, i);
+        ASSERT_TRUE(spool.append(tasks.data(), tasks.size()));
+    }
+    EXPECT_EQ(3u, segments().size());  // 每条记录 57 字节, 每个分段写满 4 条
+
+    std::vector<DBWriteTask> batch;
+    EXPECT_EQ(6u, spool.read(batch, 6));
+    spool.commit();
+    batch.clear();
+    EXPECT_EQ(4u, spool.read(batch, 100));
+    EXPECT_EQ("message 6", batch[0].message.view());
+    spool.commit();
+    EXPECT_TRUE(segments().empty());
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}